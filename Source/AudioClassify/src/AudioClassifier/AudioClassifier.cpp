@@ -10,12 +10,15 @@
 
 #include "AudioClassifier.h"
 #include <cmath>
+#include <cassert>
+#include <algorithm>
 #include "../FeatureExtractor/FeatureExtractor.h"
+#include "../Threading/ThreadPool.h"
 
 //==============================================================================
 template<typename T>
 AudioClassifier<T>::AudioClassifier(int initBufferSize, T initSampleRate, int initNumSounds, int initNumTrainingInstances)
-	: gistOSD(initBufferSize, static_cast<int>(initSampleRate)), //JWM - Eventually initialise with slice size?
+	: spectrumOSD(initBufferSize),
 	  osDetector(initBufferSize / 2, initSampleRate),
 	  featureExtractor(initBufferSize, static_cast<int>(initSampleRate)),
 	  nbc(initNumSounds, AudioClassifyOptions::totalNumAudioFeatures),
@@ -24,6 +27,7 @@ AudioClassifier<T>::AudioClassifier(int initBufferSize, T initSampleRate, int in
 	bufferSize = initBufferSize;
 	sampleRate = initSampleRate;
 
+	prepareSTFTFrameSizes();
 	setupStft();
 
 	numSounds = initNumSounds;
@@ -33,7 +37,12 @@ AudioClassifier<T>::AudioClassifier(int initBufferSize, T initSampleRate, int in
 	testInstancesPerSound = 10;
 
 	currentClassfierType.store(AudioClassifyOptions::ClassifierType::naiveBayes);
+	scalerType = AudioClassifyOptions::ScalerType::minMax;
+	classBalancing = AudioClassifyOptions::ClassBalancing::none;
+	dataSetCompression = AudioClassifyOptions::DataSetCompression::none;
+	snippetCaptureEnabled.store(false);
 
+	prepareSnippetRecorder();
 	configureDataSets();
 }
 
@@ -64,16 +73,15 @@ void AudioClassifier<T>::setCurrentBufferSize (int newBufferSize)
 {
 	bufferSize = newBufferSize;
 
+	prepareSnippetRecorder();
 	configureDataSets();
 	
 	//Update STFT frame size relative to new bufferSize.
+	prepareSTFTFrameSizes();
 	setupStft();
 
-	magSpectrumOSD.reset(new T[bufferSize / 2]);    
-	std::fill(magSpectrumOSD.get(), (magSpectrumOSD.get() + (bufferSize / 2)), static_cast<T>(0.0));
-
 	osDetector.setCurrentFrameSize(bufferSize / 2);
-	gistOSD.setAudioFrameSize(bufferSize);
+	spectrumOSD.setFrameSize(bufferSize);
 
 }
 
@@ -82,9 +90,23 @@ template<typename T>
 void AudioClassifier<T>::setCurrentSampleRate (T newSampleRate)
 {
     sampleRate = newSampleRate;
-    gistOSD.setSamplingFrequency(static_cast<int>(sampleRate));
 	featureExtractor.setSampleRate(static_cast<int>(sampleRate));
 	osDetector.setSampleRate(sampleRate);
+
+	prepareSnippetLayouts(snippetCaptureEnabled.load());
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::prepareSTFTFrameSizes()
+{
+	//Hold the mel tables for every STFT frame size so changing STFT frames per buffer does not rebuild them.
+	std::vector<int> frameSizes;
+
+	for (unsigned int numFrames = 1; numFrames <= maxSTFTFramesPerBuffer; ++numFrames)
+		frameSizes.push_back(bufferSize / static_cast<int>(numFrames));
+
+	featureExtractor.prepareFrameSizes(frameSizes);
 }
 
 //==============================================================================
@@ -92,10 +114,10 @@ template<typename T>
 bool AudioClassifier<T>::saveDataSet(const std::string & fileName, AudioClassifyOptions::DataSetType dataSetType, std::string & errorString)
 {
 	if (dataSetType == AudioClassifyOptions::DataSetType::trainingSet)
-		return trainingSet->save(fileName, errorString);
+		return trainingSet->save(fileName, errorString, dataSetCompression);
 	
 	if (dataSetType == AudioClassifyOptions::DataSetType::testSet)
-		return testSet->save(fileName, errorString);
+		return testSet->save(fileName, errorString, dataSetCompression);
 
 	//Invalid dataSetType
 	errorString = "Error saving: Invalid DataSetType";
@@ -107,6 +129,7 @@ template<typename T>
 bool AudioClassifier<T>::loadDataSet(const std::string & fileName, AudioClassifyOptions::DataSetType dataSetType, std::string & errorString)
 {
 	resetClassifierState();
+	stopJournal(dataSetType);
 
 	if (dataSetType == AudioClassifyOptions::DataSetType::trainingSet)
 	{
@@ -115,22 +138,7 @@ bool AudioClassifier<T>::loadDataSet(const std::string & fileName, AudioClassify
 		if (success)
 		{
 			//NOTE: - Check buffer sizes match?
-			stftFramesPerBuffer = trainingSet->getSTFTFramesPerBuffer();
-			numDelayedBuffers = trainingSet->getNumDelayedBuffers();
-			numSounds = trainingSet->getNumSounds();
-			trainingInstancesPerSound = trainingSet->getInstancesPerSound();
-
-			setupStft();
-
-			//Some duplication here that might be good to remove in future.
-			trainingSetReduced.reset(nullptr);
-			testSetReduced.reset(nullptr);
-
-			currentInstanceVector.set_size(trainingSet->getNumFeatures());
-
-			knn.setNumFeatures(trainingSet->getNumFeatures());
-			knn.setTrainingInstancesPerClass(trainingInstancesPerSound);
-			nbc.setNumFeatures(trainingSet->getNumFeatures());
+			adoptTrainingSetLayout();
 		}
 
 		return success;
@@ -146,7 +154,7 @@ bool AudioClassifier<T>::loadDataSet(const std::string & fileName, AudioClassify
 		if (success)
 		{
 			testInstancesPerSound = testSet->getInstancesPerSound();
-			testSetReduced.reset(nullptr);
+			updateTestSetReduced();
 		}
 
 		return success;
@@ -157,6 +165,187 @@ bool AudioClassifier<T>::loadDataSet(const std::string & fileName, AudioClassify
 	return false;
 }
 
+//==============================================================================
+template<typename T>
+bool AudioClassifier<T>::appendDataSet(const std::string& fileName, AudioClassifyOptions::DataSetType dataSetType, std::string& errorString)
+{
+	AudioDataSet<T>* dataSet = nullptr;
+
+	if (dataSetType == AudioClassifyOptions::DataSetType::trainingSet)
+		dataSet = trainingSet.get();
+	else if (dataSetType == AudioClassifyOptions::DataSetType::testSet)
+		dataSet = testSet.get();
+
+	if (dataSet == nullptr)
+	{
+		errorString = "Error appending: Invalid DataSetType";
+		return false;
+	}
+
+	AudioDataSet<T> loaded;
+
+	if (!loaded.load(fileName, errorString))
+		return false;
+
+	if (loaded.getNumSounds() > numSounds)
+	{
+		errorString = "Data set has more sounds than the classifier";
+		return false;
+	}
+
+	resetClassifierState();
+	stopJournal(dataSetType);
+
+	if (!dataSet->append(loaded, errorString))
+		return false;
+
+	if (dataSetType == AudioClassifyOptions::DataSetType::trainingSet)
+		adoptTrainingSetLayout();
+	else
+		updateTestSetReduced();
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::adoptTrainingSetLayout()
+{
+	stftFramesPerBuffer = trainingSet->getSTFTFramesPerBuffer();
+	numDelayedBuffers = trainingSet->getNumDelayedBuffers();
+	deltaOrder = trainingSet->getDeltaOrder();
+	numSounds = trainingSet->getNumSounds();
+	trainingInstancesPerSound = trainingSet->getInstancesPerSound();
+
+	setupStft();
+
+	//Some duplication here that might be good to remove in future.
+	trainingSetReduced.reset(nullptr);
+	testSetReduced.reset(nullptr);
+
+	currentInstanceVector.set_size(trainingSet->getNumFeatures());
+
+	knn.setNumFeatures(trainingSet->getNumFeatures());
+	knn.setTrainingInstancesPerClass(trainingInstancesPerSound);
+
+	resetFeatureScaler(trainingSet->getNumFeatures());
+
+	//Keep the scaling the saved model was trained with. Merged sets have no saved scaler.
+	const auto& savedScaler = trainingSet->getFeatureScaler();
+
+	savedFeatureScalerLoaded = savedScaler.getType() != AudioClassifyOptions::ScalerType::none
+							   && savedScaler.getNumFeatures() == static_cast<std::size_t>(trainingSet->getNumFeatures());
+
+	if (savedFeatureScalerLoaded)
+	{
+		featureScaler = savedScaler;
+		scalerType = savedScaler.getType();
+	}
+
+	//The running statistics must describe the adopted (loaded or merged) instances, not the old set.
+	rebuildNaiveBayesStatistics();
+
+	updateNumMFCCsRequired();
+	updateFrameRows();
+
+	prepareSnippetLayouts(snippetCaptureEnabled.load());
+}
+
+//==============================================================================
+template<typename T>
+bool AudioClassifier<T>::startJournal(const std::string& fileName, AudioClassifyOptions::DataSetType dataSetType, std::string& errorString)
+{
+	if (dataSetType == AudioClassifyOptions::DataSetType::trainingSet)
+		return trainingJournal.open(fileName, *trainingSet, errorString);
+
+	if (dataSetType == AudioClassifyOptions::DataSetType::testSet)
+		return testJournal.open(fileName, *testSet, errorString);
+
+	errorString = "Error starting journal: Invalid DataSetType";
+	return false;
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::stopJournal(AudioClassifyOptions::DataSetType dataSetType)
+{
+	if (dataSetType == AudioClassifyOptions::DataSetType::trainingSet)
+		trainingJournal.close();
+	else if (dataSetType == AudioClassifyOptions::DataSetType::testSet)
+		testJournal.close();
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::setSnippetCaptureEnabled(bool enabled)
+{
+	//The audio thread only captures into storage laid out before capture is enabled, and drops
+	//its queued captures before the storage is released.
+	if (enabled)
+	{
+		prepareSnippetLayouts(enabled);
+		snippetCaptureEnabled.store(true);
+	}
+	else
+	{
+		snippetCaptureEnabled.store(false);
+		snippetRecorder.clearCaptures();
+		prepareSnippetLayouts(enabled);
+	}
+}
+
+//==============================================================================
+template<typename T>
+bool AudioClassifier<T>::getSnippetCaptureEnabled() const
+{
+	return snippetCaptureEnabled.load();
+}
+
+//==============================================================================
+template<typename T>
+bool AudioClassifier<T>::reextractDataSets(unsigned int newSTFTFramesPerBuffer, unsigned int newNumDelayedBuffers, int newDeltaOrder, std::string& errorString)
+{
+	if (!trainingSet->isReady())
+	{
+		errorString = "Training set not ready. Finish recording instances";
+		return false;
+	}
+
+	if (newSTFTFramesPerBuffer == 0 || newSTFTFramesPerBuffer > maxSTFTFramesPerBuffer)
+	{
+		errorString = "Invalid number of STFT frames per buffer";
+		return false;
+	}
+
+	auto& pool = ThreadPool::getShared();
+
+	std::unique_ptr<AudioDataSet<T>> newTrainingSet(new AudioDataSet<T>());
+
+	if (!trainingSet->getReextractedCopy(*newTrainingSet, newSTFTFramesPerBuffer, newNumDelayedBuffers, newDeltaOrder, errorString, &pool))
+		return false;
+
+	//The test set is cleared for re-recording unless it can be re-extracted too.
+	std::unique_ptr<AudioDataSet<T>> newTestSet(new AudioDataSet<T>(numSounds, testInstancesPerSound, bufferSize,
+																	  newSTFTFramesPerBuffer, newNumDelayedBuffers, newDeltaOrder));
+	std::string testErrorString;
+
+	if (testSet->isReady())
+		testSet->getReextractedCopy(*newTestSet, newSTFTFramesPerBuffer, newNumDelayedBuffers, newDeltaOrder, testErrorString, &pool);
+
+	resetClassifierState();
+
+	//The journals were opened for the old feature layout.
+	trainingJournal.close();
+	testJournal.close();
+
+	trainingSet = std::move(newTrainingSet);
+	testSet = std::move(newTestSet);
+
+	adoptTrainingSetLayout();
+
+	return true;
+}
+
 //==============================================================================
 template<typename T>
 size_t AudioClassifier<T>::getNumSounds() const
@@ -278,6 +467,24 @@ int AudioClassifier<T>::getSTFTFramesPerBuffer() const
 	return stftFramesPerBuffer;
 }
 
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::setDeltaOrder(int newDeltaOrder)
+{
+	assert(newDeltaOrder >= 0 && newDeltaOrder <= 2);
+
+	deltaOrder = newDeltaOrder;
+
+	configureDataSets();
+}
+
+//==============================================================================
+template<typename T>
+int AudioClassifier<T>::getDeltaOrder() const
+{
+	return deltaOrder;
+}
+
 //==============================================================================
 template<typename T>
 int AudioClassifier<T>::getSTFTFrameSize() const
@@ -285,6 +492,51 @@ int AudioClassifier<T>::getSTFTFrameSize() const
 	return bufferSize / stftFramesPerBuffer;
 }
 
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::setFFTBackendType(AudioClassifyOptions::FFTBackendType newBackendType)
+{
+	spectrumOSD.setBackendType(newBackendType);
+	featureExtractor.setFFTBackendType(newBackendType);
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::FFTBackendType AudioClassifier<T>::getFFTBackendType() const
+{
+	return spectrumOSD.getBackendType();
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::FFTBackendType AudioClassifier<T>::getFeatureExtractorFFTBackendType() const
+{
+	return featureExtractor.getFFTBackendType();
+}
+
+//==============================================================================
+template<typename T>
+std::vector<FFTBenchmark::Result> AudioClassifier<T>::benchmarkFFTBackends(int numIterations) const
+{
+	return FFTBenchmark::run<T>(bufferSize, maxSTFTFramesPerBuffer, numIterations);
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::FFTBackendType AudioClassifier<T>::selectFastestFFTBackend()
+{
+	auto results = benchmarkFFTBackends();
+
+	//The onset detector transforms whole buffers, the feature extractor STFT frames.
+	auto fastest = FFTBenchmark::getFastestBackend(results, bufferSize);
+	auto fastestForFeatures = FFTBenchmark::getFastestBackend(results, getSTFTFrameSize());
+
+	spectrumOSD.setBackendType(fastest);
+	featureExtractor.setFFTBackendType(fastestForFeatures);
+
+	return fastest;
+}
+
 //==============================================================================
 template<typename T>
 void AudioClassifier<T>::setClassifierType(AudioClassifyOptions::ClassifierType classifierType)
@@ -315,6 +567,116 @@ int AudioClassifier<T>::getKNNNumNeighbours()
 	return knn.getNumNeighbours();
 }
 
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::setScalerType(AudioClassifyOptions::ScalerType newScalerType)
+{
+	scalerType = newScalerType;
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::ScalerType AudioClassifier<T>::getScalerType() const
+{
+	return scalerType;
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::setClassBalancing(AudioClassifyOptions::ClassBalancing newClassBalancing)
+{
+	classBalancing = newClassBalancing;
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::ClassBalancing AudioClassifier<T>::getClassBalancing() const
+{
+	return classBalancing;
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::setDataSetCompression(AudioClassifyOptions::DataSetCompression newDataSetCompression)
+{
+	dataSetCompression = newDataSetCompression;
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::DataSetCompression AudioClassifier<T>::getDataSetCompression() const
+{
+	return dataSetCompression;
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::setKNNSearchType(AudioClassifyOptions::KNNSearchType newSearchType)
+{
+	//classify() must not search the index while it is rebuilt.
+	const auto wasReady = classifierReady.exchange(false);
+
+	knn.setSearchType(newSearchType);
+
+	classifierReady.store(wasReady);
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::KNNSearchType AudioClassifier<T>::getKNNSearchType() const
+{
+	return knn.getSearchType();
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::setKNNQuantisation(AudioClassifyOptions::KNNQuantisation newQuantisation)
+{
+	const auto wasReady = classifierReady.exchange(false);
+
+	knn.setQuantisation(newQuantisation);
+
+	classifierReady.store(wasReady);
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::KNNQuantisation AudioClassifier<T>::getKNNQuantisation() const
+{
+	return knn.getQuantisation();
+}
+
+//==============================================================================
+template<typename T>
+KNNCondensationReport AudioClassifier<T>::setKNNPrototypeBudget(int newPrototypeBudget)
+{
+	KNNCondensationReport report { getDataSetSize(AudioClassifyOptions::DataSetType::trainingSet), 0, -1.0f, -1.0f };
+
+	const auto wasReady = classifierReady.load();
+
+	if (wasReady)
+		report.accuracyBefore = testClassifier(AudioClassifyOptions::ClassifierType::nearestNeighbour, nullptr);
+
+	knn.setPrototypeBudget(static_cast<std::size_t>(std::max(newPrototypeBudget, 0)));
+
+	if (wasReady)
+	{
+		train();
+		report.accuracyAfter = testClassifier(AudioClassifyOptions::ClassifierType::nearestNeighbour, nullptr);
+	}
+
+	report.numStoredInstances = static_cast<int>(knn.getNumStoredInstances());
+
+	return report;
+}
+
+//==============================================================================
+template<typename T>
+int AudioClassifier<T>::getKNNPrototypeBudget() const
+{
+	return static_cast<int>(knn.getPrototypeBudget());
+}
+
 //==============================================================================
 //NOTE: revist later - will need assertion if user uses sound value out of range 0 - numSounds
 template<typename T>
@@ -329,6 +691,10 @@ void AudioClassifier<T>::setSoundRecording(int sound, AudioClassifyOptions::Data
 		//Cannot record test set and training set data at same time. Should be seperate instances.
 		recordingTestData.store(false);
 		recordingTrainingData.store(true);
+		newTrainingRecording.store(true);
+
+		//The new instances need a refitted scaler.
+		savedFeatureScalerLoaded = false;
 	}
 	else
 	{
@@ -347,17 +713,50 @@ void AudioClassifier<T>::train()
     //If all sound samples collected for training set train model.
     if (trainingSet->isReady())
     {
-		if (reducedVarianceSize > 0)
+		const auto reduced = (reducedVarianceSize > 0 && trainingSetReduced != nullptr);
+
+		arma::Mat<T> scaledData;
+		arma::Row<int> labels;
+
+		//Gathered straight into the copy the scaling is applied to.
+		if (classBalancing == AudioClassifyOptions::ClassBalancing::none)
 		{
-			nbc.Train(trainingSetReduced->getData(), trainingSetReduced->getSoundLabels());
-			knn.train(trainingSetReduced->getData(), trainingSetReduced->getSoundLabels());
+			if (reduced)
+				trainingSetReduced->gather(scaledData);
+			else
+				scaledData = trainingSet->getData();
+
+			labels = trainingSet->getSoundLabels();
 		}
 		else
 		{
-			nbc.Train(trainingSet->getData(), trainingSet->getSoundLabels()); 
-			knn.train(trainingSet->getData(), trainingSet->getSoundLabels());
+			const auto indices = trainingSet->getBalancedInstanceIndices(classBalancing);
+
+			if (reduced)
+				trainingSetReduced->gather(indices, scaledData);
+			else
+				scaledData = trainingSet->getData().cols(indices);
+
+			labels = trainingSet->getSoundLabels().cols(indices);
+		}
+
+		//Fit the scaler once here, unless the training set was loaded with a scaler of the same type.
+		//The same scaling is applied to every instance classified.
+		if (reduced || !savedFeatureScalerLoaded || featureScaler.getType() != scalerType)
+		{
+			featureScaler.fit(scaledData, scalerType);
+			savedFeatureScalerLoaded = false;
+
+			//A saved training set keeps the scaling of its full features only.
+			if (!reduced)
+				trainingSet->setFeatureScaler(featureScaler);
 		}
 
+		featureScaler.apply(scaledData);
+
+		nbc.Train(scaledData, labels);
+		knn.train(scaledData, labels);
+
         classifierReady.store(true);    
     }
 
@@ -373,16 +772,22 @@ void AudioClassifier<T>::setInstancesPerSound(int newNumInstances, AudioClassify
 	{
 		resetClassifierState();
 		trainingInstancesPerSound = newNumInstances;
-		trainingSet.reset(new AudioDataSet<T>(numSounds, trainingInstancesPerSound, bufferSize, stftFramesPerBuffer, numDelayedBuffers));
 		trainingSetReduced.reset(nullptr);
+		testSetReduced.reset(nullptr);
+		trainingSet.reset(new AudioDataSet<T>(numSounds, trainingInstancesPerSound, bufferSize, stftFramesPerBuffer, numDelayedBuffers, deltaOrder));
 		knn.setTrainingInstancesPerClass(newNumInstances);
+		nbc.setNumFeatures(trainingSet->getNumFeatures());
+		prepareSnippetLayout(*trainingSet, snippetCaptureEnabled.load());
 	}
 
 	if (dataSetType == AudioClassifyOptions::DataSetType::testSet)
 	{
 		testInstancesPerSound = newNumInstances;
-		testSet.reset(new AudioDataSet<T>(numSounds, testInstancesPerSound, bufferSize, stftFramesPerBuffer, numDelayedBuffers));
 		testSetReduced.reset(nullptr);
+		testSet.reset(new AudioDataSet<T>(numSounds, testInstancesPerSound, bufferSize, stftFramesPerBuffer, numDelayedBuffers, deltaOrder));
+		updateTestSetReduced();
+		snippetRecorder.clearCaptures();
+		prepareSnippetLayout(*testSet, snippetCaptureEnabled.load());
 	}
 
 }
@@ -443,6 +848,9 @@ void AudioClassifier<T>::processAudioBuffer (const T* buffer, const int numSampl
 	if (numDelayedBuffers == 0 || delayedProcessedCount == 0)
 		 hasOnset = false;
 
+	if (snippetCaptureEnabled.load())
+		snippetRecorder.pushBuffer(buffer, numSamples);
+
     /** if (bufferSize != numSamples) */
 
     /** { */
@@ -452,13 +860,26 @@ void AudioClassifier<T>::processAudioBuffer (const T* buffer, const int numSampl
 	
 	if (delayedProcessedCount == 0)
 	{
-		gistOSD.processAudioFrame(buffer, bufferSize);
-		gistOSD.getMagnitudeSpectrum(magSpectrumOSD.get());
-		hasOnset = osDetector.checkForOnset(magSpectrumOSD.get(), bufferSize / 2);
+		spectrumOSD.process(buffer);
+		hasOnset = osDetector.checkForOnset(spectrumOSD.getMagnitudeSpectrum(), spectrumOSD.getMagnitudeSpectrumSize());
 	}
 
 	if (hasOnset)
 	{
+		//New instance - deltas must not be taken against the previous onset's frames.
+		if (stftProcessedCount == 0 && delayedProcessedCount == 0)
+		{
+			featureExtractor.resetDeltas();
+			currentOnsetSample = snippetRecorder.getNumSamplesPushed() - numSamples;
+		}
+
+		//Only compute the features used by the feature set that is about to be filled.
+		const auto reduced = (reducedVarianceSize > 0 && !isRecording());
+
+		featureExtractor.setNumMFCCs(reduced ? numMFCCsRequiredReduced : numMFCCsRequired);
+		featureExtractor.setTimeDomainFeaturesEnabled(!reduced || timeDomainRequiredReduced);
+		featureExtractor.setSpectralFeaturesEnabled(!reduced || spectralRequiredReduced);
+
 		while (stftProcessedCount < stftFramesPerBuffer)
 		{
 			//Later allow use of hopSize/overlap ?
@@ -502,16 +923,11 @@ void AudioClassifier<T>::processCurrentInstance()
 	auto instanceReady = false;
 	auto frameNumber = (stftProcessedCount + 1) + (stftFramesPerBuffer * delayedProcessedCount);
 
-	for (auto i = 0; i < AudioClassifyOptions::totalNumAudioFeatures; ++i)
+	if (frameNumber <= frameRows.size())
 	{
-		auto feature = static_cast<AudioClassifyOptions::AudioFeature>(i);
-		if (trainingSet->usingFeature(frameNumber, feature))
+		for (const auto& row : frameRows[frameNumber - 1])
 		{
-			auto featureVal = featureExtractor.getFeature(feature);
-			auto featureIndex = trainingSet->getFeatureRowIndex(frameNumber, feature);
-
-			currentInstanceVector[featureIndex] = featureVal;
-
+			currentInstanceVector[row.first] = featureExtractor.getFeature(row.second);
 			++featuresProcessedCount;
 		}
 	}
@@ -534,7 +950,34 @@ void AudioClassifier<T>::processCurrentInstance()
 				currentSoundRecording.store(-1);
 			}
 			else
-				trainingSet->addInstance(currentInstanceVector, currentSoundRecording.load());
+			{
+				const auto sound = currentSoundRecording.load();
+
+				const auto column = trainingSet->addInstance(currentInstanceVector, sound);
+				const auto instanceStored = column >= 0;
+
+				if (instanceStored)
+				{
+					trainingJournal.push(currentInstanceVector, sound);
+
+					if (snippetCaptureEnabled.load())
+						snippetRecorder.capture(currentOnsetSample, *trainingSet, column);
+				}
+
+				//Keep the Naive Bayes running statistics in step with the instances stored in the full training set.
+				if (reducedVarianceSize == 0 && instanceStored)
+				{
+					if (newTrainingRecording.exchange(false))
+						nbc.resetClass(sound);
+
+					featureScaler.apply(currentInstanceVector.memptr(), scaledInstanceVector.memptr());
+					nbc.addInstance(scaledInstanceVector, sound);
+
+					//Rebuild the model once the last instance of the sound is stored rather than for every instance.
+					if (column + 1 == (sound + 1) * trainingSet->getInstancesPerSound())
+						nbc.updateModel();
+				}
+			}
 		}
 
 		if (recordingTestData.load())
@@ -545,7 +988,19 @@ void AudioClassifier<T>::processCurrentInstance()
 				currentSoundRecording.store(-1);
 			}
 			else
-				testSet->addInstance(currentInstanceVector, currentSoundRecording.load());
+			{
+				const auto sound = currentSoundRecording.load();
+
+				const auto column = testSet->addInstance(currentInstanceVector, sound);
+
+				if (column >= 0)
+				{
+					testJournal.push(currentInstanceVector, sound);
+
+					if (snippetCaptureEnabled.load())
+						snippetRecorder.capture(currentOnsetSample, *testSet, column);
+				}
+			}
 		}
 	}
 
@@ -557,16 +1012,11 @@ void AudioClassifier<T>::processCurrentInstanceReduced()
 {
 	auto frameNumber = (stftProcessedCount + 1) + (stftFramesPerBuffer * delayedProcessedCount);
 
-	for (auto i = 0; i < AudioClassifyOptions::totalNumAudioFeatures; ++i)
+	if (frameNumber <= frameRowsReduced.size())
 	{
-		auto feature = static_cast<AudioClassifyOptions::AudioFeature>(i);
-		if (trainingSetReduced->usingFeature(frameNumber, feature))
+		for (const auto& row : frameRowsReduced[frameNumber - 1])
 		{
-			auto featureVal = featureExtractor.getFeature(feature);
-			auto featureIndex = trainingSetReduced->getFeatureRowIndex(frameNumber, feature);
-
-			currentInstanceVectorReduced[featureIndex] = featureVal;
-
+			currentInstanceVectorReduced[row.first] = featureExtractor.getFeature(row.second);
 			++featuresProcessedCountReduced;
 		}
 	}
@@ -590,6 +1040,12 @@ void AudioClassifier<T>::resetClassifierState()
 	//NOTE: May remove these as should be set when recording instance for sound complete. 
 	recordingTrainingData.store(false);
 	recordingTestData.store(false);
+	newTrainingRecording.store(false);
+
+	savedFeatureScalerLoaded = false;
+
+	//Queued snippets point into data sets that may be about to change.
+	snippetRecorder.clearCaptures();
 }
 
 //==============================================================================
@@ -611,25 +1067,26 @@ int AudioClassifier<T>::classify()
 	auto sound = -1;
 
     auto ready = classifierReady.load();
+
+	//Naive Bayes can classify from its running statistics before every sound is fully recorded.
+	if (!ready && currentClassfierType.load() == AudioClassifyOptions::ClassifierType::naiveBayes && reducedVarianceSize == 0)
+		ready = nbc.isReady();
       
     if (!ready || isRecording())
         return -1;
    
     if (noteOnsetDetected())
     {
+		const auto& instance = (reducedVarianceSize > 0) ? currentInstanceVectorReduced : currentInstanceVector;
+		featureScaler.apply(instance.memptr(), scaledInstanceVector.memptr());
+
 	    switch (currentClassfierType.load())
 	    {
 			case AudioClassifyOptions::ClassifierType::nearestNeighbour:
-				if (reducedVarianceSize > 0)
-					sound = knn.classify(currentInstanceVectorReduced);
-				else
-					sound = knn.classify(currentInstanceVector);
+				sound = knn.classify(scaledInstanceVector);
 				break;
 			case AudioClassifyOptions::ClassifierType::naiveBayes:
-				if (reducedVarianceSize > 0)
-					sound = nbc.Classify(currentInstanceVectorReduced);
-				else
-					sound = nbc.Classify(currentInstanceVector);
+				sound = nbc.Classify(scaledInstanceVector);
 				break;
 			default: break; // Sound returned -1 (Invalid label. Valid labels are 0 to numSounds)
 	    }
@@ -643,7 +1100,105 @@ template<typename T>
 void AudioClassifier<T>::reduceFeaturesByVariance(unsigned numFeaturesToTake)
 {
 	//NOTE: Should we check whether training set is ready and return void?
+	if (numFeaturesToTake > 0)
+		useReducedFeatures(trainingSet->getHighestVarianceFeatures(numFeaturesToTake));
+	else
+		useReducedFeatures(std::vector<FeatureFramePair>());
+}
+
+//==============================================================================
+template<typename T>
+FeatureSelectionResult AudioClassifier<T>::selectFeatures(AudioClassifyOptions::FeatureSelectionDirection direction, float accuracyTolerance,
+														  int numFolds, int maxFeatures)
+{
+	if (!trainingSet->isReady())
+		return FeatureSelectionResult();
 
+	FeatureSelector<T> selector(getClassifierConfiguration(), numFolds);
+
+	return applyFeatureSelection(selector, direction, accuracyTolerance, maxFeatures);
+}
+
+//==============================================================================
+template<typename T>
+FeatureExtractionCosts AudioClassifier<T>::measureFeatureCosts(int numIterations) const
+{
+	//A separate extractor so the one used by the audio thread is untouched.
+	FeatureExtractor<T> extractor(getSTFTFrameSize(), static_cast<int>(sampleRate));
+	extractor.setFFTBackendType(getFeatureExtractorFFTBackendType());
+
+	return extractor.measureCosts(numIterations);
+}
+
+//==============================================================================
+template<typename T>
+FeatureSelectionResult AudioClassifier<T>::selectFeaturesWithinBudget(AudioClassifyOptions::FeatureSelectionDirection direction, float accuracyTolerance,
+																	  double cpuBudgetMicroseconds, int numFolds, int maxFeatures)
+{
+	if (!trainingSet->isReady())
+		return FeatureSelectionResult();
+
+	const auto costs = measureFeatureCosts();
+	const auto allFeatures = trainingSet->getFeaturesUsed();
+	const auto framesPerBuffer = static_cast<double>(stftFramesPerBuffer);
+
+	FeatureSelector<T> selector(getClassifierConfiguration(), numFolds);
+
+	selector.setCostModel([&costs, &allFeatures, framesPerBuffer](const std::vector<std::size_t>& rows)
+	{
+		std::vector<AudioClassifyOptions::AudioFeature> features;
+
+		for (auto row : rows)
+			features.push_back(allFeatures[row].second);
+
+		return costs.getFrameCost(features) * framesPerBuffer;
+	}, cpuBudgetMicroseconds);
+
+	return applyFeatureSelection(selector, direction, accuracyTolerance, maxFeatures);
+}
+
+//==============================================================================
+template<typename T>
+FeatureSelectionResult AudioClassifier<T>::applyFeatureSelection(FeatureSelector<T>& selector, AudioClassifyOptions::FeatureSelectionDirection direction,
+																 float accuracyTolerance, int maxFeatures)
+{
+	selector.prepare(trainingSet->getData(), trainingSet->getSoundLabels(), numSounds);
+
+	const auto result = selector.select(direction, accuracyTolerance, static_cast<std::size_t>(std::max(maxFeatures, 0)));
+
+	if (result.selectedFeatures.empty())
+		return result;
+
+	const auto allFeatures = trainingSet->getFeaturesUsed();
+	std::vector<FeatureFramePair> selectedFeatures;
+
+	for (auto row : result.selectedFeatures)
+		selectedFeatures.push_back(allFeatures[row]);
+
+	//Every feature selected is the same as no reduction.
+	if (selectedFeatures.size() == allFeatures.size())
+		selectedFeatures.clear();
+
+	useReducedFeatures(selectedFeatures);
+
+	return result;
+}
+
+//==============================================================================
+template<typename T>
+std::vector<FeatureFramePair> AudioClassifier<T>::getFeaturesUsed() const
+{
+	if (reducedVarianceSize > 0 && trainingSetReduced != nullptr)
+		return trainingSetReduced->getFeaturesUsed();
+
+	return trainingSet->getFeaturesUsed();
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::useReducedFeatures(const std::vector<FeatureFramePair>& features)
+{
+	const auto numFeaturesToTake = static_cast<unsigned>(features.size());
 	auto numFeaturesToUse = 0;
 
 	resetClassifierState();
@@ -652,11 +1207,11 @@ void AudioClassifier<T>::reduceFeaturesByVariance(unsigned numFeaturesToTake)
 	if (numFeaturesToTake > 0)
 	{
 		//NOTE: - Need to check this. Torn state issues etc.
-		trainingSetReduced.reset(new AudioDataSet<T>(trainingSet->getVarianceReducedCopy(numFeaturesToTake)));
+		//Views only hold the selected rows, so the data sets are not copied.
+		trainingSetReduced.reset(new FeatureSubset<T>(*trainingSet, features));
 
 		//Set test set to use same reduced features as training set.
-		testSetReduced.reset(new AudioDataSet<T>(*testSet.get()));
-		testSetReduced->setFeaturesUsed(trainingSetReduced->getFeaturesUsed());
+		updateTestSetReduced();
 
 		currentInstanceVectorReduced.set_size(numFeaturesToTake);
 		currentInstanceVectorReduced.zeros();
@@ -678,6 +1233,11 @@ void AudioClassifier<T>::reduceFeaturesByVariance(unsigned numFeaturesToTake)
 
 	nbc.setNumFeatures(numFeaturesToUse);
 	knn.setNumFeatures(numFeaturesToUse);
+
+	resetFeatureScaler(numFeaturesToUse);
+
+	updateNumMFCCsRequired();
+	updateFrameRows();
 }
 
 //==============================================================================
@@ -729,24 +1289,196 @@ void AudioClassifier<T>::configureDataSets()
 {
 	resetClassifierState();
 
-	trainingSet.reset(new AudioDataSet<T>(numSounds, trainingInstancesPerSound, bufferSize, stftFramesPerBuffer, numDelayedBuffers));
-	testSet.reset(new AudioDataSet<T>(numSounds, testInstancesPerSound, bufferSize, stftFramesPerBuffer, numDelayedBuffers));
-
-	currentInstanceVector.set_size(trainingSet->getNumFeatures());
-	currentInstanceVector.zeros();
+	//The journals were opened for the old feature layout.
+	trainingJournal.close();
+	testJournal.close();
 
 	trainingSetReduced.reset(nullptr);
 	testSetReduced.reset(nullptr);
 	currentInstanceVectorReduced.clear();
 
+	trainingSet.reset(new AudioDataSet<T>(numSounds, trainingInstancesPerSound, bufferSize, stftFramesPerBuffer, numDelayedBuffers, deltaOrder));
+	testSet.reset(new AudioDataSet<T>(numSounds, testInstancesPerSound, bufferSize, stftFramesPerBuffer, numDelayedBuffers, deltaOrder));
+
+	currentInstanceVector.set_size(trainingSet->getNumFeatures());
+	currentInstanceVector.zeros();
+
 
 	knn.setNumFeatures(trainingSet->getNumFeatures());
 	nbc.setNumFeatures(trainingSet->getNumFeatures());
+
+	resetFeatureScaler(trainingSet->getNumFeatures());
+
+	updateNumMFCCsRequired();
+	updateFrameRows();
+
+	prepareSnippetLayouts(snippetCaptureEnabled.load());
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::prepareSnippetRecorder()
+{
+	//Sized for the longest snippet so enabling capture or changing the delayed buffers never reallocates the history.
+	snippetRecorder.prepare(bufferSize * (maxSnippetDelayedBuffers + 2), bufferSize, bufferSize);
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::prepareSnippetLayouts(bool captureEnabled)
+{
+	prepareSnippetLayout(*trainingSet, captureEnabled);
+	prepareSnippetLayout(*testSet, captureEnabled);
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::prepareSnippetLayout(AudioDataSet<T>& dataSet, bool captureEnabled) const
+{
+	//Recorded and loaded data sets keep the snippets they have.
+	if (dataSet.isReady())
+		return;
+
+	const auto snippetLength = captureEnabled ? snippetRecorder.getSnippetLength() : 0;
+	const auto snippetPreRoll = captureEnabled ? snippetRecorder.getPreRoll() : 0;
+	const auto snippetSampleRate = captureEnabled ? static_cast<int>(sampleRate) : 0;
+
+	if (dataSet.getSnippetLength() != snippetLength || dataSet.getSnippetPreRoll() != snippetPreRoll
+		|| dataSet.getSnippetSampleRate() != snippetSampleRate)
+		dataSet.setSnippetLayout(snippetLength, snippetPreRoll, snippetSampleRate);
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::resetFeatureScaler(std::size_t numFeatures)
+{
+	featureScaler.reset(numFeatures);
+	scaledInstanceVector.zeros(numFeatures);
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::rebuildNaiveBayesStatistics()
+{
+	nbc.setNumFeatures(trainingSet->getNumFeatures());
+
+	const auto& data = trainingSet->getData();
+	const auto& labels = trainingSet->getSoundLabels();
+
+	arma::Col<T> scaledInstance(trainingSet->getNumFeatures());
+
+	//Same scaling as the instances processAudioBuffer() adds while recording.
+	for (std::size_t i = 0; i < data.n_cols; ++i)
+	{
+		if (labels[i] < 0 || labels[i] >= numSounds)
+			continue;
+
+		featureScaler.apply(data.colptr(i), scaledInstance.memptr());
+		nbc.addInstance(scaledInstance, labels[i]);
+	}
+
+	nbc.updateModel();
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::updateNumMFCCsRequired()
+{
+	numMFCCsRequired = trainingSet->getNumMFCCsUsed();
+	numMFCCsRequiredReduced = (trainingSetReduced != nullptr) ? trainingSetReduced->getNumMFCCsUsed() : numMFCCsRequired;
+
+	timeDomainRequiredReduced = (trainingSetReduced == nullptr);
+	spectralRequiredReduced = (trainingSetReduced == nullptr);
+
+	if (trainingSetReduced != nullptr)
+	{
+		//Delta features are computed from their base feature.
+		for (const auto& featureFramePair : trainingSetReduced->getFeaturesUsed())
+		{
+			const auto baseFeature = AudioClassifyOptions::getBaseFeature(featureFramePair.second);
+
+			timeDomainRequiredReduced = timeDomainRequiredReduced || FeatureExtractor<T>::isTimeDomainFeature(baseFeature);
+			spectralRequiredReduced = spectralRequiredReduced || FeatureExtractor<T>::isSpectralFeature(baseFeature);
+		}
+	}
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::updateFrameRows()
+{
+	frameRows = trainingSet->getFrameRows();
+
+	if (trainingSetReduced != nullptr)
+		frameRowsReduced = trainingSetReduced->getFrameRows();
+	else
+		frameRowsReduced.clear();
+}
+
+//==============================================================================
+template<typename T>
+void AudioClassifier<T>::updateTestSetReduced()
+{
+	testSetReduced.reset(nullptr);
+
+	if (trainingSetReduced == nullptr)
+		return;
+
+	//A test set recorded or loaded with a different layout can't be viewed with the same features.
+	for (const auto& featureFramePair : trainingSetReduced->getFeaturesUsed())
+	{
+		if (!testSet->usingFeature(featureFramePair.first, featureFramePair.second))
+			return;
+	}
+
+	testSetReduced.reset(new FeatureSubset<T>(*testSet, trainingSetReduced->getFeaturesUsed()));
 }
 
 //==============================================================================
 template<typename T>
 float AudioClassifier<T>::test(std::vector<std::pair<unsigned int, unsigned int>>& outputResults)
+{
+	return testClassifier(currentClassfierType.load(), &outputResults);
+}
+
+//==============================================================================
+template<typename T>
+std::vector<CrossValidationResult> AudioClassifier<T>::crossValidate(const std::vector<ClassifierConfiguration>& configurations,
+																	 int numFolds, bool stratified) const
+{
+	if (!trainingSet->isReady())
+		return std::vector<CrossValidationResult>();
+
+	CrossValidator<T> crossValidator(numFolds, stratified);
+
+	if (reducedVarianceSize > 0 && trainingSetReduced != nullptr)
+	{
+		arma::Mat<T> reducedData;
+		trainingSetReduced->gather(reducedData);
+
+		return crossValidator.evaluate(reducedData, trainingSet->getSoundLabels(), numSounds, configurations);
+	}
+
+	return crossValidator.evaluate(trainingSet->getData(), trainingSet->getSoundLabels(), numSounds, configurations);
+}
+
+//==============================================================================
+template<typename T>
+ClassifierConfiguration AudioClassifier<T>::getClassifierConfiguration()
+{
+	ClassifierConfiguration configuration;
+
+	configuration.classifierType = currentClassfierType.load();
+	configuration.scalerType = scalerType;
+	configuration.numNeighbours = knn.getNumNeighbours();
+	configuration.prototypeBudget = knn.getPrototypeBudget();
+
+	return configuration;
+}
+
+//==============================================================================
+template<typename T>
+float AudioClassifier<T>::testClassifier(AudioClassifyOptions::ClassifierType classifierType, std::vector<std::pair<unsigned int, unsigned int>>* outputResults)
 {
 	//NOTE: Possibly add an error string input param if test set not ready
 	if (!testSet->isReady())
@@ -754,49 +1486,77 @@ float AudioClassifier<T>::test(std::vector<std::pair<unsigned int, unsigned int>
 
 	unsigned int numCorrect = 0;
 
-	const AudioDataSet<T>*  testSetToUse;
+	//Scale the whole test set once, then classify it in parallel batches.
+	arma::Mat<T> scaledData;
 
 	//Check if using reduced feature set.
-	/** NOTE: Would prefer to alter this in future as slightly messy. Better not to be carrying 
-	 * two data set copies all the time. OK for research stage.
-	 **/
 	if (reducedVarianceSize > 0)
-		testSetToUse = testSetReduced.get();
+	{
+		if (testSetReduced == nullptr)
+			return -1.0f;
+
+		testSetReduced->gather(scaledData);
+	}
 	else
-		testSetToUse = testSet.get();
+	{
+		scaledData = testSet->getData();
+	}
+
+	featureScaler.apply(scaledData);
 
+	const auto& soundLabels = testSet->getSoundLabels();
+	const auto numTestInstances = static_cast<std::size_t>(scaledData.n_cols);
 
-	for (auto i = 0; i < testSetToUse->getTotalNumInstances(); ++i)
+	arma::Row<int> predictedLabels(numTestInstances);
+
+	ThreadPool::getShared().parallelFor(numTestInstances, [&](std::size_t begin, std::size_t end)
 	{
-		arma::Col<T> testInstance = testSetToUse->getData().col(i);
-		auto actual = testSetToUse->getSoundLabels()[i];
-		auto predicted = -1;
-		
-	    switch (currentClassfierType.load())
-	    {
+		const arma::Mat<T> range = scaledData.cols(begin, end - 1);
+		arma::Row<int> rangeLabels;
+
+		switch (classifierType)
+		{
 			case AudioClassifyOptions::ClassifierType::nearestNeighbour:
-				predicted = knn.classify(testInstance);
+				knn.classify(range, rangeLabels);
 				break;
 			case AudioClassifyOptions::ClassifierType::naiveBayes:
-				predicted = nbc.Classify(testInstance);
+				nbc.Classify(range, rangeLabels);
 				break;
-			default: break; 
-	    }
+			default:
+				rangeLabels.set_size(end - begin);
+				rangeLabels.fill(-1);
+				break;
+		}
+
+		std::copy(rangeLabels.memptr(), rangeLabels.memptr() + (end - begin), predictedLabels.memptr() + begin);
+	}, 64);
+
+	if (outputResults != nullptr)
+		outputResults->reserve(outputResults->size() + numTestInstances);
+
+	for (std::size_t i = 0; i < numTestInstances; ++i)
+	{
+		const auto actual = soundLabels[i];
+		const auto predicted = predictedLabels[i];
 
 		if (actual == predicted)
 			++numCorrect;
 
-		outputResults.push_back(std::make_pair(actual, predicted));
+		if (outputResults != nullptr)
+			outputResults->push_back(std::make_pair(actual, predicted));
 	}
 
 	//Return percentage accuracy
-	auto result = static_cast<float>(numCorrect) / static_cast<float>(testSetToUse->getTotalNumInstances()) * 100.0f;
-
-	testSetToUse = nullptr;
+	auto result = static_cast<float>(numCorrect) / static_cast<float>(testSet->getTotalNumInstances()) * 100.0f;
 
 	return result;
 }
 
+//==============================================================================
+//Passed by reference to std::max, so needs a definition.
+template<typename T>
+const int AudioClassifier<T>::maxSnippetDelayedBuffers;
+
 //==============================================================================
 template class AudioClassifier<float>;
 template class AudioClassifier<double>;
@@ -21,20 +21,37 @@
 #include <memory>
 #include <atomic>
 
-#include "../../Gist/src/Gist.h"
-
 #include "../AudioClassifyOptions/AudioClassifyOptions.h"
 #include "../AudioDataSet/AudioDataSet.h"
+#include "../AudioDataSet/FeatureSubset.h"
+#include "../AudioDataSet/DataSetJournal.h"
+#include "../AudioDataSet/SnippetRecorder.h"
 
+#include "../FFT/SpectrumAnalyser.h"
+#include "../FFT/FFTBenchmark.h"
 #include "../OnsetDetection/OnsetDetector.h"
 #include "../FeatureExtractor/FeatureExtractor.h"
 
 #include "../NaiveBayes/NaiveBayes.h"
 #include "../NearestNeighbour/NearestNeighbour.h"
 
+#include "../Evaluation/CrossValidator.h"
+#include "../Evaluation/FeatureSelector.h"
+
 //==============================================================================
 using FeatureFramePair = std::pair<int, AudioClassifyOptions::AudioFeature>;
 
+/** Result of AudioClassifier::setKNNPrototypeBudget(). Accuracies are percentages on the
+ *  test set, or -1 if the classifier or test set was not ready to measure them.
+ */
+struct KNNCondensationReport
+{
+	int numTrainingInstances;
+	int numStoredInstances;
+	float accuracyBefore;
+	float accuracyAfter;
+};
+
 template<typename T>
 class AudioClassifier
 {
@@ -74,6 +91,40 @@ public:
 
 	int getSTFTFrameSize() const;
 
+	/** Sets which delta features the data sets use. The delta features of a frame are its feature
+	 *  values minus those of the previous STFT frame in the same instance (and delta-deltas the change in
+	 *  deltas), so they need at least 2 / 3 frames per instance via STFT frames or delayed buffers.
+	 *  The training and test sets will need to be re-recorded.
+	 * @param newDeltaOrder 0 base features only, 1 + delta features, 2 + delta and delta-delta features.
+	 */
+	void setDeltaOrder(int newDeltaOrder);
+	int getDeltaOrder() const;
+
+	//==============================================================================
+	/** Sets the FFT backend used for spectral analysis. Frame sizes the backend does not
+	 *  support (i.e. non power of two sizes for splitRadix) fall back to KissFFT.
+	 */
+	void setFFTBackendType(AudioClassifyOptions::FFTBackendType newBackendType);
+
+	/** @return the backend used for the onset detection spectrum. */
+	AudioClassifyOptions::FFTBackendType getFFTBackendType() const;
+
+	/** @return the backend used for feature extraction, which can differ after selectFastestFFTBackend(). */
+	AudioClassifyOptions::FFTBackendType getFeatureExtractorFFTBackendType() const;
+
+	/** Times each FFT backend at the frame sizes this classifier uses for the current buffer size
+	 *  (bufferSize / n for every STFT frames per buffer setting). 
+	 * Note: This method blocks and allocates. Do not call from the audio thread.
+	 */
+	std::vector<FFTBenchmark::Result> benchmarkFFTBackends(int numIterations = 1000) const;
+
+	/** Benchmarks the FFT backends and selects the fastest one for the onset detection frame size
+	 *  (bufferSize) and, separately, for the feature extraction frame size (getSTFTFrameSize()).
+	 * Note: This method blocks and allocates. Do not call from the audio thread.
+	 * @return the backend selected for onset detection.
+	 */
+	AudioClassifyOptions::FFTBackendType selectFastestFFTBackend();
+
 	/** This method sets the classifier type/learning algorithm to be used.
 	 * @param classifierType the classifier type to be used i.e. AudioClassifyOptions::ClassifierType::knn
 	 */
@@ -84,6 +135,46 @@ public:
 	void setKNNNumNeighbours(int newNumNeighbours);
 	int getKNNNumNeighbours();
 
+	/** Selects brute force or KD-tree neighbour search for the nearest neighbour classifier.
+	 * Note: Selecting the KD-tree builds its index. Do not call from the audio thread.
+	 */
+	void setKNNSearchType(AudioClassifyOptions::KNNSearchType newSearchType);
+	AudioClassifyOptions::KNNSearchType getKNNSearchType() const;
+
+	/** Selects an optional int16 / int8 quantised training set for the brute force nearest neighbour search.
+	 * Note: Builds the quantised copy. Do not call from the audio thread.
+	 */
+	void setKNNQuantisation(AudioClassifyOptions::KNNQuantisation newQuantisation);
+	AudioClassifyOptions::KNNQuantisation getKNNQuantisation() const;
+
+	/** Caps the number of training instances the nearest neighbour classifier searches. Larger
+	 *  training sets are condensed to this many per class k-means prototypes. 0 stores every instance.
+	 *  If the classifier is trained it is retrained with the new budget, and the nearest neighbour
+	 *  accuracy on the test set before and after is reported.
+	 * Note: This method retrains and blocks. Do not call from the audio thread.
+	 */
+	KNNCondensationReport setKNNPrototypeBudget(int newPrototypeBudget);
+	int getKNNPrototypeBudget() const;
+
+	/** Sets the per feature scaling fitted by train() and applied to every instance classified.
+	 *  Takes effect the next time the classifier is trained. Defaults to ScalerType::minMax.
+	 *  A loaded training set sets the type it was saved with and train() keeps its saved scaling.
+	 */
+	void setScalerType(AudioClassifyOptions::ScalerType newScalerType);
+	AudioClassifyOptions::ScalerType getScalerType() const;
+
+	/** Sets how train() samples a training set whose sounds have different numbers of instances,
+	 *  e.g. after appendDataSet(). Takes effect the next time the classifier is trained.
+	 */
+	void setClassBalancing(AudioClassifyOptions::ClassBalancing newClassBalancing);
+	AudioClassifyOptions::ClassBalancing getClassBalancing() const;
+
+	/** Sets the compression saveDataSet() writes. Defaults to DataSetCompression::none, which keeps
+	 *  loaded data sets memory mapped.
+	 */
+	void setDataSetCompression(AudioClassifyOptions::DataSetCompression newDataSetCompression);
+	AudioClassifyOptions::DataSetCompression getDataSetCompression() const;
+
 	/**
 	 *
 	 */
@@ -94,6 +185,19 @@ public:
 	
 	float test(std::vector<std::pair<unsigned int, unsigned int>>& outputResults);
 
+	/** Estimates the accuracy of each classifier configuration from the training set alone by
+	 *  k-fold cross validation (see CrossValidator), so settings can be compared without recording
+	 *  a test set. Uses the variance reduced features if set. The trained classifier is not changed.
+	 * Note: This method allocates and blocks. Do not call from the audio thread.
+	 * @param stratified true to keep the proportion of each sound the same in every fold.
+	 * @return a result per configuration, or none if the training set is not ready.
+	 */
+	std::vector<CrossValidationResult> crossValidate(const std::vector<ClassifierConfiguration>& configurations,
+													 int numFolds = 5, bool stratified = true) const;
+
+	/** @return the current classifier type, scaling and nearest neighbour settings. */
+	ClassifierConfiguration getClassifierConfiguration();
+
 	/** Saves the current data set being used by the model/classifier. 
 	 * This can be loaded again on the next application load so that data sets do not have to be re-recorded. 
      * Note: This method should NOT be called from the audio/callback thread as it involves file IO and will block.
@@ -111,6 +215,45 @@ public:
 	 */
 	bool loadDataSet(const std::string& fileName, AudioClassifyOptions::DataSetType dataSetType, std::string& errorString);
 
+	/** Appends the instances of a saved data set or journal to the current one, e.g. to combine
+	 *  sessions or performers. The current data set must be complete and the file must have the
+	 *  same analysis configuration and no more sounds. The classifier will need re-training.
+	 * Note: This method should NOT be called from the audio/callback thread as it involves file IO and will block.
+	 * @return true if the instances were appended.
+	 */
+	bool appendDataSet(const std::string& fileName, AudioClassifyOptions::DataSetType dataSetType, std::string& errorString);
+
+	/** Starts appending every instance recorded into the data set to a journal file, written by a
+	 *  background thread so the audio thread never waits on file IO. Recording can carry on into
+	 *  an existing journal with the same feature layout. Only instances stored in the data set are
+	 *  journalled, so each recording of a sound adds at most its instances per sound to the journal.
+	 *  Load the journal with loadDataSet().
+	 *  The journal is stopped when the data sets are reconfigured or the data set is loaded.
+	 * Note: Do not call from the audio thread or whilst recording.
+	 * @return true if the journal was opened.
+	 */
+	bool startJournal(const std::string& fileName, AudioClassifyOptions::DataSetType dataSetType, std::string& errorString);
+	void stopJournal(AudioClassifyOptions::DataSetType dataSetType);
+
+	/** Stores the raw audio around each recorded instance with the data sets: one buffer before the
+	 *  onset buffer and the onset buffer plus maxSnippetDelayedBuffers buffers after it.
+	 *  The snippets are saved with the data sets and let reextractDataSets() change the analysis
+	 *  configuration without re-recording. Disabled by default, as each snippet adds
+	 *  (maxSnippetDelayedBuffers + 2) buffers of samples to every instance saved.
+	 * Note: Allocates the snippet storage for data sets that are not yet recorded. Do not call from the audio thread or whilst recording.
+	 */
+	void setSnippetCaptureEnabled(bool enabled);
+	bool getSnippetCaptureEnabled() const;
+
+	/** Rebuilds the training set, and the test set if it has snippets, for new STFT frames per
+	 *  buffer, delayed buffers and delta order from their recorded snippets, in parallel, instead of
+	 *  discarding them as setSTFTFramesPerBuffer() / setNumBuffersDelayed() / setDeltaOrder() do.
+	 *  A test set without snippets is cleared for re-recording. The classifier will need re-training.
+	 * Note: This method allocates and blocks. Do not call from the audio thread.
+	 * @return false with errorString set if the training set has no snippets covering the new configuration.
+	 */
+	bool reextractDataSets(unsigned int newSTFTFramesPerBuffer, unsigned int newNumDelayedBuffers, int newDeltaOrder, std::string& errorString);
+
 
 	/** @return the number of sounds currently being used in the model. */
 	size_t getNumSounds() const;
@@ -151,6 +294,37 @@ public:
 	int getNumFeaturesUsed();
 	std::vector<std::pair<FeatureFramePair, T>> getFeatureVariances();
 
+	/** Reduces the features used by sequential forward / backward wrapper selection (see FeatureSelector)
+	 *  on the training set, scoring each subset by the cross validated accuracy of the current
+	 *  classifier configuration. The smallest subset found within accuracyTolerance percentage
+	 *  points of the best accuracy is used, as reduceFeaturesByVariance() would. The classifier will need re-training.
+	 * Note: This method allocates and blocks, for longer the more features there are. Do not call from the audio thread.
+	 * @param maxFeatures forward only, the largest subset searched. 0 searches every size.
+	 * @return the search, with features as rows of the full training set. Empty if the training set is not ready.
+	 */
+	FeatureSelectionResult selectFeatures(AudioClassifyOptions::FeatureSelectionDirection direction, float accuracyTolerance,
+										  int numFolds = 5, int maxFeatures = 0);
+
+	/** @return the features classified, i.e. the reduced features if set. */
+	std::vector<FeatureFramePair> getFeaturesUsed() const;
+
+	/** Times each stage of feature extraction at the current STFT frame size, sample rate and FFT
+	 *  backend on this machine, see FeatureExtractionCosts.
+	 * Note: This method blocks and allocates. Do not call from the audio thread.
+	 */
+	FeatureExtractionCosts measureFeatureCosts(int numIterations = 1000) const;
+
+	/** As selectFeatures(), but each step optimises cross validated accuracy per microsecond of
+	 *  extraction cost measured by measureFeatureCosts(), and the cheapest subset within
+	 *  accuracyTolerance whose cost fits cpuBudgetMicroseconds is used. The cost of a subset is the
+	 *  extraction time of the STFT frames of one buffer with the stages its features need, so the
+	 *  budget is the share of the buffer's deadline given to feature extraction. If no subset fits
+	 *  the features used are left unchanged.
+	 * Note: This method allocates and blocks. Do not call from the audio thread.
+	 */
+	FeatureSelectionResult selectFeaturesWithinBudget(AudioClassifyOptions::FeatureSelectionDirection direction, float accuracyTolerance,
+													  double cpuBudgetMicroseconds, int numFolds = 5, int maxFeatures = 0);
+
 
 private:
 
@@ -164,6 +338,14 @@ private:
 	unsigned int stftFramesPerBuffer = 1;
 	unsigned int stftProcessedCount = 0;
 
+	int deltaOrder = 0;
+
+	//Slider range for STFT frames per buffer is 1 - 16
+	static const unsigned int maxSTFTFramesPerBuffer = 16;
+
+	//Slider range for delayed buffers is 0 - 5. Snippets cover this many so any setting can be re-extracted.
+	static const int maxSnippetDelayedBuffers = 5;
+
 	//==============================================================================
 	//Holds the number of features processed so far for the current instance
 	unsigned int featuresProcessedCount = 0;
@@ -180,6 +362,18 @@ private:
 
 	//==============================================================================
 	unsigned reducedVarianceSize = 0;
+
+	//Number of MFCCs the FeatureExtractor needs for the full / reduced feature sets.
+	int numMFCCsRequired = FeatureExtractor<T>::numMelBands;
+	int numMFCCsRequiredReduced = FeatureExtractor<T>::numMelBands;
+
+	//Whether the reduced feature set uses any time domain / spectral shape features.
+	bool timeDomainRequiredReduced = true;
+	bool spectralRequiredReduced = true;
+
+	//Instance rows filled after each STFT frame for the full / reduced feature sets.
+	FrameRowTable frameRows;
+	FrameRowTable frameRowsReduced;
 	//==============================================================================
 	T sampleRate = static_cast<T>(0.0);
 	
@@ -198,18 +392,29 @@ private:
 	//Indicates whether currently recording test/training data.
     std::atomic_bool recordingTrainingData;
 	std::atomic_bool recordingTestData;
-	//==============================================================================
 
-    //Array/Buffer to hold mag spectrum used for onset detection.
-    std::unique_ptr<T[]> magSpectrumOSD;
+	//Set when a new training recording starts so the audio thread discards that sound's old Naive Bayes statistics.
+	std::atomic_bool newTrainingRecording;
+	//==============================================================================
 
 	//==============================================================================
-    Gist<T> gistOSD;
+    //Produces the magnitude spectrum used for onset detection.
+    SpectrumAnalyser<T> spectrumOSD;
     OnsetDetector<T> osDetector;
 	FeatureExtractor<T> featureExtractor;
     NaiveBayes<T> nbc;
 	NearestNeighbour<T> knn;
 
+	//Fitted to the training data by train() and saved with the training set.
+	FeatureScaler<T> featureScaler;
+	AudioClassifyOptions::ScalerType scalerType;
+
+	//Set while featureScaler holds the scaler saved with the loaded training set, so train() keeps it.
+	bool savedFeatureScalerLoaded = false;
+
+	AudioClassifyOptions::ClassBalancing classBalancing;
+	AudioClassifyOptions::DataSetCompression dataSetCompression;
+
 	//==============================================================================
 	/**
 	 * NOTE: Eventually need to change to atomic shared pointers which 
@@ -218,17 +423,33 @@ private:
 	 * dataset parameters change. 
 	 */
 	std::unique_ptr<AudioDataSet<T>> trainingSet;
-	std::unique_ptr<AudioDataSet<T>> trainingSetReduced;
-
 	std::unique_ptr<AudioDataSet<T>> testSet;
-	std::unique_ptr<AudioDataSet<T>> testSetReduced;
+
+	//Views of the reduced features of trainingSet / testSet. Reset before the set they view.
+	std::unique_ptr<FeatureSubset<T>> trainingSetReduced;
+	std::unique_ptr<FeatureSubset<T>> testSetReduced;
+
+	//Optional journals of the full feature instances recorded into trainingSet / testSet.
+	DataSetJournal<T> trainingJournal;
+	DataSetJournal<T> testJournal;
+
+	//Raw audio history for the snippets stored with each recorded instance.
+	SnippetRecorder<T> snippetRecorder;
+	std::atomic_bool snippetCaptureEnabled;
+
+	//Position in the snippetRecorder history of the current instance's onset buffer.
+	std::int64_t currentOnsetSample = 0;
 
     //Holds the the feature values/vector for the current instance/block.
 	arma::Col<T> currentInstanceVector;
 	arma::Col<T> currentInstanceVectorReduced;
 
+	//currentInstanceVector(Reduced) after scaling, passed to the classifiers.
+	arma::Col<T> scaledInstanceVector;
+
 	//==============================================================================
 	void setupStft();
+	void prepareSTFTFrameSizes();
 
     void processCurrentInstance();
 	void processCurrentInstanceReduced();
@@ -236,6 +457,20 @@ private:
 	void resetClassifierState();
 
 	void configureDataSets();
+	void prepareSnippetRecorder();
+	void prepareSnippetLayouts(bool captureEnabled);
+	void prepareSnippetLayout(AudioDataSet<T>& dataSet, bool captureEnabled) const;
+	void adoptTrainingSetLayout();
+	void updateNumMFCCsRequired();
+	void updateFrameRows();
+	void updateTestSetReduced();
+	void useReducedFeatures(const std::vector<FeatureFramePair>& features);
+	FeatureSelectionResult applyFeatureSelection(FeatureSelector<T>& selector, AudioClassifyOptions::FeatureSelectionDirection direction,
+												 float accuracyTolerance, int maxFeatures);
+	void resetFeatureScaler(std::size_t numFeatures);
+	void rebuildNaiveBayesStatistics();
+
+	float testClassifier(AudioClassifyOptions::ClassifierType classifierType, std::vector<std::pair<unsigned int, unsigned int>>* outputResults);
 
 	//==============================================================================
 };
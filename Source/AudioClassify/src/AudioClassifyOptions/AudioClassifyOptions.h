@@ -11,6 +11,7 @@
 #ifndef AUDIOCLASSIFYOPTIONS_H_INCLUDED
 #define AUDIOCLASSIFYOPTIONS_H_INCLUDED
 #include <map>
+#include <string>
 
 
 /**
@@ -46,7 +47,53 @@ struct AudioClassifyOptions
 		mfcc_10,
 		mfcc_11,
 		mfcc_12,
-		mfcc_13
+		mfcc_13,
+
+		//First order differences of the features above between consecutive STFT frames.
+		deltaRms,
+		deltaPeakEnergy,
+		deltaZeroCrossingRate,
+		deltaSpectralCentroid,
+		deltaSpectralCrest,
+		deltaSpectralFlatness,
+		deltaSpectralRolloff,
+		deltaSpectralKurtois,
+		deltaMfcc_1,
+		deltaMfcc_2,
+		deltaMfcc_3,
+		deltaMfcc_4,
+		deltaMfcc_5,
+		deltaMfcc_6,
+		deltaMfcc_7,
+		deltaMfcc_8,
+		deltaMfcc_9,
+		deltaMfcc_10,
+		deltaMfcc_11,
+		deltaMfcc_12,
+		deltaMfcc_13,
+
+		//Second order differences (differences of the deltas).
+		deltaDeltaRms,
+		deltaDeltaPeakEnergy,
+		deltaDeltaZeroCrossingRate,
+		deltaDeltaSpectralCentroid,
+		deltaDeltaSpectralCrest,
+		deltaDeltaSpectralFlatness,
+		deltaDeltaSpectralRolloff,
+		deltaDeltaSpectralKurtois,
+		deltaDeltaMfcc_1,
+		deltaDeltaMfcc_2,
+		deltaDeltaMfcc_3,
+		deltaDeltaMfcc_4,
+		deltaDeltaMfcc_5,
+		deltaDeltaMfcc_6,
+		deltaDeltaMfcc_7,
+		deltaDeltaMfcc_8,
+		deltaDeltaMfcc_9,
+		deltaDeltaMfcc_10,
+		deltaDeltaMfcc_11,
+		deltaDeltaMfcc_12,
+		deltaDeltaMfcc_13
 
     };
 
@@ -64,8 +111,109 @@ struct AudioClassifyOptions
 		testSet
 	};
 
+	/** The FFT implementations available to the spectral analysis stages.
+	 *  splitRadix only supports power of two frame sizes. Other sizes fall back to kissFFT.
+	 */
+	enum class FFTBackendType: int
+	{
+		kissFFT = 0,
+		splitRadix
+	};
+
+	/** Neighbour search used by NearestNeighbour. kdTree builds a KDTree index at train time
+	 *  which pays off for large training sets with few features.
+	 */
+	enum class KNNSearchType: int
+	{
+		bruteForce = 0,
+		kdTree
+	};
+
+	/** Optional integer copy of the NearestNeighbour training set scanned by the brute force
+	 *  search. The closest candidates are reranked in full precision.
+	 */
+	enum class KNNQuantisation: int
+	{
+		none = 0,
+		int16,
+		int8
+	};
+
+	/** Per feature scaling fitted on the training set by FeatureScaler and applied to every
+	 *  instance before it reaches a classifier.
+	 */
+	enum class ScalerType: int
+	{
+		none = 0,
+		minMax,
+		zScore
+	};
+
+	/** How train() samples the training set when sounds have different numbers of instances.
+	 *  undersample keeps a random subset of every sound the size of the smallest, oversample
+	 *  repeats instances of every sound up to the size of the largest.
+	 */
+	enum class ClassBalancing: int
+	{
+		none = 0,
+		undersample,
+		oversample
+	};
+
+	/** Compression of the data, label and snippet sections of a saved AudioDataSet. gzip deflates
+	 *  each section as written, shuffledGZIP first groups the bytes of each value by significance
+	 *  (see DataSetFileFormat::shuffleBytes()) so near constant features compress much further.
+	 */
+	enum class DataSetCompression: int
+	{
+		none = 0,
+		gzip,
+		shuffledGZIP
+	};
+
+	/** Search order of FeatureSelector. forward starts from no features and adds the one that most
+	 *  improves cross validated accuracy each step, backward starts from every feature and removes
+	 *  the one whose loss costs least.
+	 */
+	enum class FeatureSelectionDirection: int
+	{
+		forward = 0,
+		backward
+	};
+
+	//Build time default. Define AUDIOCLASSIFY_USE_SPLIT_RADIX_FFT in the exporter extraDefs to change.
+#ifdef AUDIOCLASSIFY_USE_SPLIT_RADIX_FFT
+	static const FFTBackendType defaultFFTBackend = FFTBackendType::splitRadix;
+#else
+	static const FFTBackendType defaultFFTBackend = FFTBackendType::kissFFT;
+#endif
+
+	/** @return 0 for the base features, 1 for deltas and 2 for delta-deltas. */
+	static int getDeltaOrder(AudioFeature feature)
+	{
+		return static_cast<int>(feature) / numBaseAudioFeatures;
+	}
+
+	/** @return the feature a delta or delta-delta feature is derived from. Base features return themselves. */
+	static AudioFeature getBaseFeature(AudioFeature feature)
+	{
+		return static_cast<AudioFeature>(static_cast<int>(feature) % numBaseAudioFeatures);
+	}
+
+	/** @return the delta (deltaOrder = 1) or delta-delta (deltaOrder = 2) version of baseFeature. */
+	static AudioFeature getDeltaFeature(AudioFeature baseFeature, int deltaOrder)
+	{
+		return static_cast<AudioFeature>(static_cast<int>(getBaseFeature(baseFeature)) + (deltaOrder * numBaseAudioFeatures));
+	}
+
 	static std::string getFeatureName(AudioFeature feature)
 	{
+		if (getDeltaOrder(feature) == 1)
+			return "Delta " + getFeatureName(getBaseFeature(feature));
+
+		if (getDeltaOrder(feature) == 2)
+			return "Delta-Delta " + getFeatureName(getBaseFeature(feature));
+
 		switch (feature)
 		{
 			case AudioFeature::rms:
@@ -114,7 +262,20 @@ struct AudioClassifyOptions
 		}
 	}
 
-	static const int totalNumAudioFeatures = 21;
+	static std::string getFFTBackendName(FFTBackendType backendType)
+	{
+		switch (backendType)
+		{
+			case FFTBackendType::kissFFT:
+				return "KissFFT";
+			case FFTBackendType::splitRadix:
+				return "Split Radix";
+			default: return "";
+		}
+	}
+
+	static const int numBaseAudioFeatures = 21;
+	static const int totalNumAudioFeatures = numBaseAudioFeatures * 3;
 	//static const int totalNumAudioFeatures = 8;
 };
 
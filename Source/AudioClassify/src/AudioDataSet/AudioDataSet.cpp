@@ -10,14 +10,160 @@
 
 #include "AudioDataSet.h"
 #include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <random>
 
-#include "../PreProcessing/PreProcessing.h"
+#include "DataSetFileFormat.h"
+#include "../FeatureExtractor/FeatureExtractor.h"
+#include "../Threading/ThreadPool.h"
+
+namespace
+{
+	//Reads numValues float or double values (as saved) from unaligned file bytes into destination.
+	template<typename Source, typename T>
+	void convertValues(const char* source, T* destination, std::size_t numValues)
+	{
+		Source value;
+
+		for (std::size_t i = 0; i < numValues; ++i)
+		{
+			std::memcpy(&value, source + (i * sizeof(Source)), sizeof(Source));
+			destination[i] = static_cast<T>(value);
+		}
+	}
+
+	template<typename T>
+	void readValues(const char* source, std::uint32_t valueSize, T* destination, std::size_t numValues)
+	{
+		if (valueSize == sizeof(float))
+			convertValues<float>(source, destination, numValues);
+		else
+			convertValues<double>(source, destination, numValues);
+	}
+
+	void writePadding(OutputStream& os, std::uint64_t sectionOffset)
+	{
+		const auto position = static_cast<std::uint64_t>(os.getPosition());
+
+		if (sectionOffset > position)
+			os.writeRepeatedByte(0, static_cast<size_t>(sectionOffset - position));
+	}
+
+	/** Writes numRecords records of recordValues values of valueSize bytes as a section, compressed
+	 *  as flags says.
+	 * @return the number of bytes stored.
+	 */
+	std::uint64_t writeSection(OutputStream& os, const void* values, std::size_t numRecords, std::size_t recordValues, std::size_t valueSize,
+							   std::uint32_t flags)
+	{
+		const auto start = os.getPosition();
+		const auto* bytes = static_cast<const char*>(values);
+		const auto recordSize = recordValues * valueSize;
+
+		if ((flags & DataSetFileFormat::flagGZIP) == 0)
+		{
+			os.write(bytes, numRecords * recordSize);
+		}
+		else
+		{
+			const auto recordsPerBlock = DataSetFileFormat::getRecordsPerBlock(recordValues);
+
+			GZIPCompressorOutputStream gzip(&os, -1, false);
+			std::vector<char> shuffled((flags & DataSetFileFormat::flagByteShuffle) != 0 ? recordsPerBlock * recordSize : 0);
+
+			for (std::size_t first = 0; first < numRecords; first += recordsPerBlock)
+			{
+				const auto blockRecords = std::min(recordsPerBlock, numRecords - first);
+				const auto* block = bytes + (first * recordSize);
+
+				if (!shuffled.empty())
+				{
+					DataSetFileFormat::shuffleBytes(block, shuffled.data(), blockRecords, recordValues, valueSize);
+					block = shuffled.data();
+				}
+
+				gzip.write(block, blockRecords * recordSize);
+			}
+
+			//Ends the compressed stream, the destination stays open.
+			gzip.flush();
+		}
+
+		return static_cast<std::uint64_t>(os.getPosition() - start);
+	}
+
+	/** Reads a section written by writeSection(), streaming compressed sections through a block
+	 *  sized buffer. readBlock(bytes, firstValue, numValues) receives the values as saved.
+	 * @return false if a compressed section does not hold exactly numRecords records.
+	 */
+	template<typename ReadBlock>
+	bool readSection(const char* section, std::uint64_t storedSize, std::size_t numRecords, std::size_t recordValues, std::size_t valueSize,
+					 std::uint32_t flags, ReadBlock readBlock)
+	{
+		if ((flags & DataSetFileFormat::flagGZIP) == 0)
+		{
+			readBlock(section, 0, numRecords * recordValues);
+			return true;
+		}
+
+		GZIPDecompressorInputStream gzip(new MemoryInputStream(section, static_cast<size_t>(storedSize), false), true);
+
+		const auto recordsPerBlock = DataSetFileFormat::getRecordsPerBlock(recordValues);
+		const auto shuffled = (flags & DataSetFileFormat::flagByteShuffle) != 0;
+
+		std::vector<char> block(recordsPerBlock * recordValues * valueSize);
+		std::vector<char> unshuffled(shuffled ? block.size() : 0);
+
+		for (std::size_t first = 0; first < numRecords; first += recordsPerBlock)
+		{
+			const auto blockRecords = std::min(recordsPerBlock, numRecords - first);
+			const auto blockBytes = static_cast<int>(blockRecords * recordValues * valueSize);
+
+			if (gzip.read(block.data(), blockBytes) != blockBytes)
+				return false;
+
+			if (shuffled)
+			{
+				DataSetFileFormat::unshuffleBytes(block.data(), unshuffled.data(), blockRecords, recordValues, valueSize);
+				readBlock(unshuffled.data(), first * recordValues, blockRecords * recordValues);
+			}
+			else
+			{
+				readBlock(block.data(), first * recordValues, blockRecords * recordValues);
+			}
+		}
+
+		char extra;
+		return gzip.read(&extra, 1) == 0;
+	}
+
+	bool featureInRange(int frame, int feature, int totalNumSTFTFrames)
+	{
+		return feature >= 0 && feature < AudioClassifyOptions::totalNumAudioFeatures && frame >= 1 && frame <= totalNumSTFTFrames;
+	}
+
+	bool labelsInRange(const char* labels, std::size_t numLabels, int numSounds)
+	{
+		for (std::size_t i = 0; i < numLabels; ++i)
+		{
+			std::int32_t label;
+			std::memcpy(&label, labels + (i * sizeof(label)), sizeof(label));
+
+			if (label < 0 || label >= numSounds)
+				return false;
+		}
+
+		return true;
+	}
+}
 
 template<typename T>
 AudioDataSet<T>::AudioDataSet()
 	: bufferSize(0),
 	  stftFramesPerBuffer(0),
       numDelayedBuffers(0),
+      deltaOrder(0),
       numSounds(0),
 	  instancesPerSound(0)
 {
@@ -25,233 +171,1102 @@ AudioDataSet<T>::AudioDataSet()
 }
 
 //==============================================================================
-template<typename T>
-AudioDataSet<T>::AudioDataSet(int initNumSounds, int initInstancePerSound, int initBufferSize,
-		int initSTFTFramesPerBuffer, int initNumDelayedBuffers)
-	: bufferSize(initBufferSize),
-	  numSounds(initNumSounds), 
-	  instancesPerSound(initInstancePerSound)
+template<typename T>
+AudioDataSet<T>::AudioDataSet(int initNumSounds, int initInstancePerSound, int initBufferSize,
+		int initSTFTFramesPerBuffer, int initNumDelayedBuffers, int initDeltaOrder)
+	: bufferSize(initBufferSize),
+	  deltaOrder(initDeltaOrder),
+	  numSounds(initNumSounds), 
+	  instancesPerSound(initInstancePerSound)
+{
+	stftFramesPerBuffer = initSTFTFramesPerBuffer;
+	numDelayedBuffers = initNumDelayedBuffers;
+
+	initialise();
+}
+
+//==============================================================================
+template<typename T>
+AudioDataSet<T>::AudioDataSet(const AudioDataSet<T>& other)
+{
+	*this = other;
+}
+
+//==============================================================================
+template<typename T>
+AudioDataSet<T>& AudioDataSet<T>::operator=(const AudioDataSet<T>& other)
+{
+	if (this == &other)
+		return *this;
+
+	instanceCount = other.instanceCount;
+	bufferSize = other.bufferSize;
+	stftFramesPerBuffer = other.stftFramesPerBuffer;
+	numDelayedBuffers = other.numDelayedBuffers;
+	deltaOrder = other.deltaOrder;
+	numSounds = other.numSounds;
+	instancesPerSound = other.instancesPerSound;
+	numInstances = other.numInstances;
+
+	snippetLength = other.snippetLength;
+	snippetPreRoll = other.snippetPreRoll;
+	snippetSampleRate = other.snippetSampleRate;
+
+	soundsReady = other.soundsReady;
+
+	data = other.data;
+	soundLabels = other.soundLabels;
+	snippets = other.snippets;
+
+	//A mapped copy shares the mapping rather than copying it.
+	mappedFile = other.mappedFile;
+	mappedData = other.mappedData;
+	mappedSoundLabels = other.mappedSoundLabels;
+	mappedSnippets = other.mappedSnippets;
+
+	featuresUsed = other.featuresUsed;
+	featureScaler = other.featureScaler;
+
+	featureStatistics = other.featureStatistics;
+	featureStatisticsValid = other.featureStatisticsValid;
+	instancesRecorded = other.instancesRecorded;
+
+	//The views must point into this data set's own storage.
+	updateViews();
+
+	return *this;
+}
+
+//==============================================================================
+template <typename T>
+AudioDataSet<T>::~AudioDataSet()
+{
+	
+}
+
+//==============================================================================
+template<typename T>
+bool AudioDataSet<T>::load(const std::string & absoluteFilePath, std::string & errorString)
+{
+	File file(absoluteFilePath);
+	
+	if(!file.exists())
+	{
+		errorString = "No such file exists.";
+		return false;
+	}
+
+	//Binary files and journals start with their format magic, anything else is read as the older ValueTree format.
+	char fileMagic[sizeof(DataSetFileFormat::magic)] = {};
+
+	{
+		FileInputStream is(file);
+
+		if (is.getStatus().failed())
+		{
+			errorString = "Error opening file";
+			return false;
+		}
+
+		is.read(fileMagic, sizeof(fileMagic));
+	}
+
+	/** Read into an empty data set and only swapped in once the whole file has been read and checked,
+	 *  so a rejected file leaves this data set as it was. The empty set has no snippets and its feature
+	 *  statistics are recomputed from the loaded data when first needed, so a mapped file is not read up front.
+	 */
+	AudioDataSet<T> loaded;
+
+	auto success = false;
+
+	if (DataSetFileFormat::hasMagic(fileMagic, sizeof(fileMagic)))
+		success = loaded.loadBinary(file, errorString);
+	else if (DataSetFileFormat::hasJournalMagic(fileMagic, sizeof(fileMagic)))
+		success = loaded.loadJournal(file, errorString);
+	else
+		success = loaded.loadValueTree(file, errorString);
+
+	if (!success)
+		return false;
+
+	//Assume sounds ready if loaded as required by save
+	loaded.soundsReady.assign(loaded.numSounds, true);
+	loaded.instanceCount = 0;
+
+	swap(loaded);
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+void AudioDataSet<T>::swap(AudioDataSet<T>& other)
+{
+	std::swap(instanceCount, other.instanceCount);
+	std::swap(bufferSize, other.bufferSize);
+	std::swap(stftFramesPerBuffer, other.stftFramesPerBuffer);
+	std::swap(numDelayedBuffers, other.numDelayedBuffers);
+	std::swap(deltaOrder, other.deltaOrder);
+	std::swap(numSounds, other.numSounds);
+	std::swap(instancesPerSound, other.instancesPerSound);
+	std::swap(numInstances, other.numInstances);
+
+	std::swap(snippetLength, other.snippetLength);
+	std::swap(snippetPreRoll, other.snippetPreRoll);
+	std::swap(snippetSampleRate, other.snippetSampleRate);
+
+	soundsReady.swap(other.soundsReady);
+
+	data.swap(other.data);
+	soundLabels.swap(other.soundLabels);
+	snippets.swap(other.snippets);
+
+	mappedFile.swap(other.mappedFile);
+	std::swap(mappedData, other.mappedData);
+	std::swap(mappedSoundLabels, other.mappedSoundLabels);
+	std::swap(mappedSnippets, other.mappedSnippets);
+
+	featuresUsed.swap(other.featuresUsed);
+	std::swap(featureScaler, other.featureScaler);
+
+	std::swap(featureStatistics, other.featureStatistics);
+	std::swap(featureStatisticsValid, other.featureStatisticsValid);
+	instancesRecorded.swap(other.instancesRecorded);
+
+	//The views still point into the storage each set had before the swap.
+	updateViews();
+	other.updateViews();
+}
+
+//==============================================================================
+template<typename T>
+bool AudioDataSet<T>::loadBinary(const File& file, std::string& errorString)
+{
+	auto mapped = std::make_shared<MemoryMappedFile>(file, MemoryMappedFile::readOnly);
+
+	const auto* fileStart = static_cast<const char*>(mapped->getData());
+	auto fileSize = static_cast<std::uint64_t>(mapped->getSize());
+
+	//Read the whole file instead if it cannot be mapped.
+	MemoryBlock fileData;
+
+	if (fileStart == nullptr)
+	{
+		mapped.reset();
+
+		if (!file.loadFileAsData(fileData))
+		{
+			errorString = "Error reading file";
+			return false;
+		}
+
+		fileStart = static_cast<const char*>(fileData.getData());
+		fileSize = static_cast<std::uint64_t>(fileData.getSize());
+	}
+
+	DataSetFileFormat::Header header;
+
+	if (fileSize < sizeof(header))
+	{
+		errorString = "Data set file is truncated";
+		return false;
+	}
+
+	std::memcpy(&header, fileStart, sizeof(header));
+
+	const std::string headerError = DataSetFileFormat::validate(header, fileSize);
+
+	if (!headerError.empty())
+	{
+		errorString = headerError;
+		return false;
+	}
+
+	numSounds = header.numSounds;
+	instancesPerSound = header.instancesPerSound;
+	numInstances = header.numInstances;
+	bufferSize = header.bufferSize;
+	stftFramesPerBuffer = header.stftFramesPerBuffer;
+	numDelayedBuffers = header.numDelayedBuffers;
+	deltaOrder = header.deltaOrder;
+	snippetLength = header.snippetLength;
+	snippetPreRoll = header.snippetPreRoll;
+	snippetSampleRate = header.snippetSampleRate;
+
+	const auto numFeatures = static_cast<std::size_t>(header.numFeatures);
+	const auto numInstances = static_cast<std::size_t>(header.numInstances);
+	const auto numSnippetSamples = static_cast<std::size_t>(snippetLength);
+
+	featuresUsed.resize(0);
+
+	for (std::size_t i = 0; i < numFeatures; ++i)
+	{
+		DataSetFileFormat::FeatureLayoutEntry entry;
+		std::memcpy(&entry, fileStart + header.featureLayoutOffset + (i * sizeof(entry)), sizeof(entry));
+
+		if (!featureInRange(entry.frame, entry.feature, getTotalNumSTFTFrames()))
+		{
+			errorString = "Corrupt data set feature layout";
+			return false;
+		}
+
+		featuresUsed.push_back(std::make_pair(static_cast<int>(entry.frame), static_cast<AudioClassifyOptions::AudioFeature>(entry.feature)));
+	}
+
+	static_assert(sizeof(int) == sizeof(std::int32_t), "Sound labels are saved as int32");
+
+	if (mapped != nullptr && header.valueSize == sizeof(T) && !DataSetFileFormat::isCompressed(header))
+	{
+		//Labels index the classifiers' per sound statistics, so are checked even when mapped.
+		if (!labelsInRange(fileStart + header.labelsOffset, numInstances, numSounds))
+		{
+			errorString = "Corrupt data set labels";
+			return false;
+		}
+
+		//Use the aligned sections in place. updateViews() wraps them.
+		mappedData = reinterpret_cast<const T*>(fileStart + header.dataOffset);
+		mappedSoundLabels = reinterpret_cast<const int*>(fileStart + header.labelsOffset);
+		mappedSnippets = (header.snippetOffset != 0) ? reinterpret_cast<const T*>(fileStart + header.snippetOffset) : nullptr;
+		mappedFile = mapped;
+
+		data.reset();
+		soundLabels.reset();
+		snippets.reset();
+	}
+	else
+	{
+		//Copied, converted or decompressed into owned storage. Compressed sections are streamed into place.
+		const auto valueSize = header.valueSize;
+		auto sectionsRead = true;
+
+		data.set_size(numFeatures, numInstances);
+		soundLabels.set_size(numInstances);
+
+		sectionsRead = readSection(fileStart + header.dataOffset, header.dataStoredSize, numInstances, numFeatures, valueSize, header.flags,
+								   [this, valueSize] (const char* values, std::size_t first, std::size_t count)
+								   {
+									   readValues(values, valueSize, data.memptr() + first, count);
+								   });
+
+		sectionsRead = sectionsRead && readSection(fileStart + header.labelsOffset, header.labelsStoredSize, numInstances, 1, sizeof(std::int32_t), header.flags,
+												   [this] (const char* values, std::size_t first, std::size_t count)
+												   {
+													   std::memcpy(soundLabels.memptr() + first, values, count * sizeof(int));
+												   });
+
+		if (sectionsRead && header.snippetOffset != 0)
+		{
+			snippets.set_size(numSnippetSamples, numInstances);
+
+			//Snippets are shuffled as one long recording, neighbouring samples being the most alike.
+			sectionsRead = readSection(fileStart + header.snippetOffset, header.snippetStoredSize, snippets.n_elem, 1, valueSize, header.flags,
+									   [this, valueSize] (const char* values, std::size_t first, std::size_t count)
+									   {
+										   readValues(values, valueSize, snippets.memptr() + first, count);
+									   });
+		}
+
+		if (!sectionsRead)
+		{
+			errorString = "Corrupt compressed data set section";
+			return false;
+		}
+
+		if (!labelsInRange(reinterpret_cast<const char*>(soundLabels.memptr()), numInstances, numSounds))
+		{
+			errorString = "Corrupt data set labels";
+			return false;
+		}
+	}
+
+	featureScaler.reset(numFeatures);
+
+	const auto scalerType = static_cast<AudioClassifyOptions::ScalerType>(header.scalerType);
+
+	if (header.scalerOffset != 0 && scalerType != AudioClassifyOptions::ScalerType::none)
+	{
+		arma::Col<T> scalesLoaded(numFeatures);
+		arma::Col<T> offsetsLoaded(numFeatures);
+
+		readValues(fileStart + header.scalerOffset, header.valueSize, scalesLoaded.memptr(), numFeatures);
+		readValues(fileStart + header.scalerOffset + (numFeatures * header.valueSize), header.valueSize, offsetsLoaded.memptr(), numFeatures);
+
+		featureScaler.setParameters(scalerType, scalesLoaded, offsetsLoaded);
+	}
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+bool AudioDataSet<T>::loadJournal(const File& file, std::string& errorString)
+{
+	MemoryBlock fileData;
+
+	if (!file.loadFileAsData(fileData))
+	{
+		errorString = "Error reading file";
+		return false;
+	}
+
+	const auto* fileStart = static_cast<const char*>(fileData.getData());
+	const auto fileSize = static_cast<std::uint64_t>(fileData.getSize());
+
+	DataSetFileFormat::JournalHeader header;
+
+	if (fileSize < sizeof(header))
+	{
+		errorString = "Journal is truncated";
+		return false;
+	}
+
+	std::memcpy(&header, fileStart, sizeof(header));
+
+	const std::string headerError = DataSetFileFormat::validateJournal(header, fileSize);
+
+	if (!headerError.empty())
+	{
+		errorString = headerError;
+		return false;
+	}
+
+	const auto numFeatures = static_cast<std::size_t>(header.numFeatures);
+	const auto recordsOffset = DataSetFileFormat::getJournalRecordsOffset(header);
+	const auto recordSize = DataSetFileFormat::getJournalRecordSize(header);
+
+	//A partly written last record is ignored.
+	const auto numRecords = static_cast<std::size_t>((fileSize - recordsOffset) / recordSize);
+
+	auto readLabel = [&](std::size_t record)
+	{
+		std::int32_t label;
+		std::memcpy(&label, fileStart + recordsOffset + (record * recordSize), sizeof(label));
+		return label;
+	};
+
+	std::vector<std::size_t> soundCounts;
+
+	for (std::size_t r = 0; r < numRecords; ++r)
+	{
+		const auto label = readLabel(r);
+
+		if (label < 0)
+			continue;
+
+		if (static_cast<std::size_t>(label) >= soundCounts.size())
+			soundCounts.resize(label + 1, 0);
+
+		++soundCounts[label];
+	}
+
+	if (soundCounts.empty() || *std::min_element(soundCounts.begin(), soundCounts.end()) == 0)
+	{
+		errorString = "Journal does not hold instances for every sound";
+		return false;
+	}
+
+	numSounds = static_cast<int>(soundCounts.size());
+	instancesPerSound = static_cast<int>(*std::min_element(soundCounts.begin(), soundCounts.end()));
+	numInstances = 0;
+
+	for (auto count : soundCounts)
+		numInstances += static_cast<int>(count);
+
+	bufferSize = header.bufferSize;
+	stftFramesPerBuffer = header.stftFramesPerBuffer;
+	numDelayedBuffers = header.numDelayedBuffers;
+	deltaOrder = header.deltaOrder;
+
+	featuresUsed.resize(0);
+
+	for (std::size_t i = 0; i < numFeatures; ++i)
+	{
+		DataSetFileFormat::FeatureLayoutEntry entry;
+		std::memcpy(&entry, fileStart + header.headerSize + (i * sizeof(entry)), sizeof(entry));
+
+		if (!featureInRange(entry.frame, entry.feature, getTotalNumSTFTFrames()))
+		{
+			errorString = "Corrupt data set feature layout";
+			return false;
+		}
+
+		featuresUsed.push_back(std::make_pair(static_cast<int>(entry.frame), static_cast<AudioClassifyOptions::AudioFeature>(entry.feature)));
+	}
+
+	//Every record is kept in the order recorded, so sounds may have different numbers of instances.
+	data.set_size(numFeatures, numInstances);
+	soundLabels.set_size(numInstances);
+
+	auto column = 0;
+
+	for (std::size_t r = 0; r < numRecords; ++r)
+	{
+		const auto label = readLabel(r);
+
+		if (label < 0)
+			continue;
+
+		const auto* values = fileStart + recordsOffset + (r * recordSize) + sizeof(std::int32_t);
+
+		readValues(values, header.valueSize, data.colptr(column), numFeatures);
+		soundLabels[column++] = label;
+	}
+
+	featureScaler.reset(numFeatures);
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+bool AudioDataSet<T>::loadValueTree(const File& file, std::string& errorString)
+{
+	FileInputStream is(file);
+
+	if (is.getStatus().failed())
+	{
+		errorString = "Error opening file";
+		return false;
+	}
+
+	auto vt = ValueTree::readFromStream(is);
+
+	numSounds = vt.getProperty("NumSounds");
+	instancesPerSound = vt.getProperty("InstancesPerSound");
+	bufferSize = vt.getProperty("BufferSize");
+	stftFramesPerBuffer = vt.getProperty("STFTFramesPerBuffer");
+	numDelayedBuffers = vt.getProperty("NumDelayedBuffers");
+	deltaOrder = vt.getProperty("DeltaOrder", var(0));
+	numInstances = numSounds * instancesPerSound;
+
+	auto featuresUsedLoaded = vt.getChildWithName("FeaturesUsed");
+
+	//Going to reset features used
+	featuresUsed.resize(0);
+
+	for(auto i = 0; i < featuresUsedLoaded.getNumChildren(); ++i)
+	{
+		auto featureFramePair = featuresUsedLoaded.getChild(i);
+		auto frame = int(featureFramePair.getProperty("Frame"));
+		auto featureIndex = int(featureFramePair.getProperty("Feature"));
+
+		if (!featureInRange(frame, featureIndex, getTotalNumSTFTFrames()))
+		{
+			errorString = "Corrupt data set feature layout";
+			return false;
+		}
+
+		featuresUsed.push_back(std::make_pair(frame, static_cast<AudioClassifyOptions::AudioFeature>(featureIndex)));
+	}
+	
+	//Copied straight out of the MemoryBlocks into the data set.
+	auto dataBlock = vt.getProperty("Data").getBinaryData();
+	auto soundLabelsBlock = vt.getProperty("SoundLabels").getBinaryData();
+
+	data.set_size(featuresUsed.size(), getTotalNumInstances());
+	soundLabels.set_size(getTotalNumInstances());
+
+	if (dataBlock == nullptr || soundLabelsBlock == nullptr
+		|| dataBlock->getSize() != data.n_elem * sizeof(T) || soundLabelsBlock->getSize() != soundLabels.n_elem * sizeof(int))
+	{
+		errorString = "Corrupt data set file";
+		return false;
+	}
+
+	std::memcpy(data.memptr(), dataBlock->getData(), dataBlock->getSize());
+	std::memcpy(soundLabels.memptr(), soundLabelsBlock->getData(), soundLabelsBlock->getSize());
+
+	featureScaler.reset(featuresUsed.size());
+
+	//Scaler parameters are only present if a model was trained on the data set before saving.
+	auto scalerType = static_cast<AudioClassifyOptions::ScalerType>(int(vt.getProperty("ScalerType", var(0))));
+
+	if (scalerType != AudioClassifyOptions::ScalerType::none)
+	{
+		auto scalesBlock = vt.getProperty("ScalerScales").getBinaryData();
+		auto offsetsBlock = vt.getProperty("ScalerOffsets").getBinaryData();
+
+		if (scalesBlock == nullptr || offsetsBlock == nullptr
+			|| scalesBlock->getSize() != featuresUsed.size() * sizeof(T) || offsetsBlock->getSize() != featuresUsed.size() * sizeof(T))
+		{
+			errorString = "Corrupt data set file";
+			return false;
+		}
+
+		arma::Col<T> scalesLoaded(static_cast<T*>(scalesBlock->getData()), featuresUsed.size());
+		arma::Col<T> offsetsLoaded(static_cast<T*>(offsetsBlock->getData()), featuresUsed.size());
+
+		featureScaler.setParameters(scalerType, scalesLoaded, offsetsLoaded);
+	}
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+bool AudioDataSet<T>::save(const std::string & absoluteFilePath, std::string & errorString,
+						   AudioClassifyOptions::DataSetCompression compression)
+{
+	if (getTotalNumInstances() <= 0)
+	{
+		errorString = "No data to save";
+		return false;
+	}
+
+	if (!isReady())
+	{
+		errorString = "Data set not ready. Finish recording instances";
+		return false;
+	}
+
+	//The mapped file may be the one being replaced.
+	makeDataOwned();
+
+	File file(absoluteFilePath);
+	file.deleteFile();
+
+	FileOutputStream os(file);
+	
+	if (os.getStatus().failed())
+	{
+		errorString = "Error creating file";
+		os.flush();
+		return false;
+	}
+
+	const auto hasScaler = featureScaler.getType() != AudioClassifyOptions::ScalerType::none
+						   && featureScaler.getNumFeatures() == featuresUsed.size();
+
+	DataSetFileFormat::Header header {};
+
+	std::memcpy(header.magic, DataSetFileFormat::magic, sizeof(header.magic));
+	header.version = DataSetFileFormat::currentVersion;
+	header.headerSize = sizeof(header);
+	header.valueSize = sizeof(T);
+
+	if (compression == AudioClassifyOptions::DataSetCompression::gzip)
+		header.flags = DataSetFileFormat::flagGZIP;
+	else if (compression == AudioClassifyOptions::DataSetCompression::shuffledGZIP)
+		header.flags = DataSetFileFormat::flagGZIP | DataSetFileFormat::flagByteShuffle;
+
+	header.numSounds = numSounds;
+	header.instancesPerSound = instancesPerSound;
+	header.bufferSize = bufferSize;
+	header.stftFramesPerBuffer = stftFramesPerBuffer;
+	header.numDelayedBuffers = numDelayedBuffers;
+	header.deltaOrder = deltaOrder;
+	header.numFeatures = getNumFeatures();
+	header.numInstances = numInstances;
+	header.scalerType = hasScaler ? static_cast<std::int32_t>(featureScaler.getType()) : 0;
+
+	if (hasSnippets())
+	{
+		header.snippetLength = snippetLength;
+		header.snippetPreRoll = snippetPreRoll;
+		header.snippetSampleRate = snippetSampleRate;
+	}
+
+	//Compressed sizes are only known once written, so each section is laid out after the one before
+	//it and the header is rewritten at the end.
+	DataSetFileFormat::layoutSections(header, hasScaler);
+
+	os.write(&header, sizeof(header));
+
+	writePadding(os, header.featureLayoutOffset);
+
+	for (const auto& featureFramePair : featuresUsed)
+	{
+		const DataSetFileFormat::FeatureLayoutEntry entry { featureFramePair.first, static_cast<std::int32_t>(featureFramePair.second) };
+		os.write(&entry, sizeof(entry));
+	}
+
+	//The storage may have room for more instances, only the first numInstances are written.
+	writePadding(os, header.dataOffset);
+	header.dataStoredSize = writeSection(os, data.memptr(), numInstances, featuresUsed.size(), sizeof(T), header.flags);
+	DataSetFileFormat::layoutSections(header, hasScaler);
+
+	writePadding(os, header.labelsOffset);
+	header.labelsStoredSize = writeSection(os, soundLabels.memptr(), numInstances, 1, sizeof(int), header.flags);
+	DataSetFileFormat::layoutSections(header, hasScaler);
+
+	if (hasScaler)
+	{
+		writePadding(os, header.scalerOffset);
+		os.write(featureScaler.getScales().memptr(), featureScaler.getNumFeatures() * sizeof(T));
+		os.write(featureScaler.getOffsets().memptr(), featureScaler.getNumFeatures() * sizeof(T));
+	}
+
+	if (header.snippetOffset != 0)
+	{
+		writePadding(os, header.snippetOffset);
+		header.snippetStoredSize = writeSection(os, snippets.memptr(), static_cast<std::size_t>(snippetLength) * numInstances, 1, sizeof(T), header.flags);
+		DataSetFileFormat::layoutSections(header, hasScaler);
+	}
+
+	if (DataSetFileFormat::isCompressed(header))
+	{
+		os.setPosition(0);
+		os.write(&header, sizeof(header));
+	}
+
+	os.flush();
+
+	if (os.getStatus().failed())
+	{
+		errorString = "Error writing file";
+		return false;
+	}
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+bool AudioDataSet<T>::isMemoryMapped() const
+{
+	return mappedFile != nullptr;
+}
+
+//==============================================================================
+template<typename T>
+std::vector<FeatureFramePair> AudioDataSet<T>::getHighestVarianceFeatures(int numFeatures)
+{
+	const arma::uvec selected = getHighestVarianceRows(numFeatures);
+	std::vector<FeatureFramePair> highestVarianceFeatures;
+
+	for (std::size_t i = 0; i < selected.n_elem; ++i)
+		highestVarianceFeatures.push_back(featuresUsed[selected[i]]);
+
+	return highestVarianceFeatures;
+}
+
+//==============================================================================
+template<typename T>
+arma::uvec AudioDataSet<T>::getHighestVarianceRows(int numFeatures)
+{
+	const arma::Col<T> variances = getFeatureStatistics().getNormalisedVariances();
+	const arma::uvec sorted = arma::sort_index(variances, 1);
+
+	return sorted.head(std::min<arma::uword>(static_cast<arma::uword>(numFeatures), sorted.n_elem));
+}
+
+//==============================================================================
+template <typename T>
+std::vector<std::pair<FeatureFramePair, T>> AudioDataSet<T>::getFeatureVariances()
+{
+	std::vector<std::pair<FeatureFramePair, T>> results;
+
+	const arma::Col<T> variances = getFeatureStatistics().getNormalisedVariances();
+	const arma::uvec sorted = arma::sort_index(variances, 1);
+
+	for (auto i = 0; i < sorted.n_elem; ++i)
+		results.push_back(std::make_pair(featuresUsed[sorted[i]], variances[sorted[i]]));
+
+	return results;
+}
+
+//==============================================================================
+template <typename T>
+const FeatureStatistics<T>& AudioDataSet<T>::getFeatureStatistics()
 {
-	stftFramesPerBuffer = initSTFTFramesPerBuffer;
-	numDelayedBuffers = initNumDelayedBuffers;
+	if (!featureStatisticsValid)
+	{
+		featureStatistics.reset(featuresUsed.size());
 
-	initialise();
+		//Whilst recording, only the instances recorded so far.
+		if (instancesRecorded.empty())
+		{
+			featureStatistics.add(getData());
+		}
+		else
+		{
+			for (std::size_t j = 0; j < instancesRecorded.size(); ++j)
+			{
+				if (instancesRecorded[j])
+					featureStatistics.add(getData().colptr(j));
+			}
+		}
+
+		featureStatisticsValid = true;
+	}
+
+	return featureStatistics;
 }
 
 //==============================================================================
-template <typename T>
-AudioDataSet<T>::~AudioDataSet()
+template<typename T>
+int AudioDataSet<T>::addInstance(const arma::Col<T>& instance, int soundLabel)
 {
+	//Loaded data sets are complete, so are never recorded into.
+	assert(!isMemoryMapped());
+	assert(instance.n_rows == data.n_rows);
 	
+	auto totalInstances = numSounds * instancesPerSound;
+
+	//May change to assertion. 
+	if (totalInstances == 0)
+		return -1;
+
+	if (instanceCount == 0)
+		instanceCount = soundLabel * instancesPerSound;
+
+	if (instanceCount < instancesPerSound * (soundLabel + 1))
+	{
+		data.col(instanceCount) = instance;
+		soundLabels[instanceCount] = soundLabel;
+
+		//Welford statistics cannot remove an instance, so an overwrite leaves them to be recomputed.
+		if (instanceCount < static_cast<int>(instancesRecorded.size()) && !instancesRecorded[instanceCount])
+		{
+			instancesRecorded[instanceCount] = true;
+
+			if (featureStatisticsValid)
+				featureStatistics.add(instance.memptr());
+		}
+		else
+		{
+			featureStatisticsValid = false;
+		}
+
+		return instanceCount++;
+	}
+
+	soundsReady[soundLabel] = true;
+	instanceCount = 0;
+
+	return -1;
 }
 
 //==============================================================================
 template<typename T>
-bool AudioDataSet<T>::load(const std::string & absoluteFilePath, std::string & errorString)
+bool AudioDataSet<T>::append(const AudioDataSet<T>& other, std::string& errorString)
 {
-	File file(absoluteFilePath);
-	
-	if(!file.exists())
+	//The source must not move whilst the storage grows.
+	if (&other == this)
 	{
-		errorString = "No such file exists.";
-		return false;
+		const AudioDataSet<T> copy(other);
+		return append(copy, errorString);
 	}
 
-	FileInputStream is(file);
-
-	if (is.getStatus().failed())
+	if (!isReady() || !other.isReady())
 	{
-		errorString = "Error opening file";
+		errorString = "Data sets not ready. Finish recording instances before appending";
 		return false;
 	}
 
-	auto vt = ValueTree::readFromStream(is);
+	if (bufferSize != other.bufferSize || stftFramesPerBuffer != other.stftFramesPerBuffer || numDelayedBuffers != other.numDelayedBuffers
+		|| deltaOrder != other.deltaOrder || featuresUsed != other.featuresUsed)
+	{
+		errorString = "Data sets have different feature layouts";
+		return false;
+	}
 
-	numSounds = vt.getProperty("NumSounds");
-	instancesPerSound = vt.getProperty("InstancesPerSound");
-	bufferSize = vt.getProperty("BufferSize");
-	stftFramesPerBuffer = vt.getProperty("STFTFramesPerBuffer");
-	numDelayedBuffers = vt.getProperty("NumDelayedBuffers");
+	makeDataOwned();
 
-	auto featuresUsedLoaded = vt.getChildWithName("FeaturesUsed");
+	const auto keepSnippets = hasSnippets() && snippetLength == other.snippetLength
+							  && snippetPreRoll == other.snippetPreRoll && snippetSampleRate == other.snippetSampleRate;
 
-	//Going to reset features used
-	featuresUsed.resize(0);
+	if (!keepSnippets)
+		setSnippetLayout(0, 0, 0);
 
-	for(auto i = 0; i < featuresUsedLoaded.getNumChildren(); ++i)
-	{
-		auto featureFramePair = featuresUsedLoaded.getChild(i);
-		auto frame = int(featureFramePair.getProperty("Frame"));
-		auto feature = static_cast<AudioClassifyOptions::AudioFeature>(int(featureFramePair.getProperty("Feature")));
+	const auto numOtherInstances = other.getTotalNumInstances();
+	const auto numInstancesRequired = numInstances + numOtherInstances;
+	const auto capacity = static_cast<int>(data.n_cols);
 
-		featuresUsed.push_back(std::make_pair(frame, feature));
-	}
-	
-	auto dataBlock = vt.getProperty("Data").getBinaryData();
-	arma::Mat<T> dataLoaded(static_cast<T*>(dataBlock->getData()), featuresUsed.size(), getTotalNumInstances());
+	if (numInstancesRequired > capacity)
+		setStorageCapacity(std::max(numInstancesRequired, capacity + (capacity / 2)));
 
-	auto soundLabelsBlock = vt.getProperty("SoundLabels").getBinaryData();
-	arma::Row<int> soundLabelsLoaded(static_cast<int*>(soundLabelsBlock->getData()), getTotalNumInstances());
+	const auto numFeatures = featuresUsed.size();
+	const auto& otherData = other.getData();
+	const auto& otherSoundLabels = other.getSoundLabels();
 
-	setData(dataLoaded);
-	setSoundLabels(soundLabelsLoaded);
+	std::copy(otherData.memptr(), otherData.memptr() + (numFeatures * numOtherInstances), data.colptr(numInstances));
+	std::copy(otherSoundLabels.memptr(), otherSoundLabels.memptr() + numOtherInstances, soundLabels.memptr() + numInstances);
 
-	//Assume sounds ready if loaded as required by save
-	for (auto& v : soundsReady)
+	if (keepSnippets)
 	{
-		v = true;
+		const auto& otherSnippets = other.getSnippets();
+		std::copy(otherSnippets.memptr(), otherSnippets.memptr() + (static_cast<std::size_t>(snippetLength) * numOtherInstances), snippets.colptr(numInstances));
 	}
 
+	numInstances = numInstancesRequired;
+	numSounds = std::max(numSounds, other.numSounds);
+	instanceCount = 0;
+
+	updateViews();
+
+	const auto soundCounts = getNumInstancesOfSounds();
+	instancesPerSound = *std::min_element(soundCounts.begin(), soundCounts.end());
+
+	soundsReady.resize(numSounds);
+
+	for (auto sound = 0; sound < numSounds; ++sound)
+		soundsReady[sound] = soundCounts[sound] > 0;
+
+	featureScaler.reset(numFeatures);
+
+	if (featureStatisticsValid && other.featureStatisticsValid)
+		featureStatistics.merge(other.featureStatistics);
+	else
+		featureStatisticsValid = false;
+
+	instancesRecorded.clear();
+
 	return true;
 }
 
 //==============================================================================
 template<typename T>
-bool AudioDataSet<T>::save(const std::string & absoluteFilePath, std::string & errorString)
+void AudioDataSet<T>::reserveInstances(int newCapacity)
 {
-	if (getTotalNumInstances() <= 0)
-	{
-		errorString = "No data to save";
-		return false;
-	}
+	makeDataOwned();
 
-	if (!isReady())
+	if (newCapacity > static_cast<int>(data.n_cols))
+		setStorageCapacity(newCapacity);
+}
+
+//==============================================================================
+template<typename T>
+std::vector<int> AudioDataSet<T>::getNumInstancesOfSounds() const
+{
+	std::vector<int> soundCounts(numSounds, 0);
+
+	for (arma::uword i = 0; i < soundLabelsView.n_elem; ++i)
 	{
-		errorString = "Data set not ready. Finish recording instances";
-		return false;
-	}
+		const auto label = soundLabelsView[i];
 
-	File file(absoluteFilePath);
-	file.deleteFile();
+		if (label >= 0 && label < numSounds)
+			++soundCounts[label];
+	}
 
-	ValueTree vt("AudioDataSet");
+	return soundCounts;
+}
 
-	vt.setProperty("NumSounds", var(numSounds), nullptr);
-	vt.setProperty("InstancesPerSound", var(instancesPerSound), nullptr);
-	vt.setProperty("NumFeatures", var(getNumFeatures()), nullptr);
-	vt.setProperty("BufferSize", var(bufferSize), nullptr);
-	vt.setProperty("STFTFramesPerBuffer", var(stftFramesPerBuffer), nullptr);
-	vt.setProperty("NumDelayedBuffers", var(numDelayedBuffers), nullptr);
+//==============================================================================
+template<typename T>
+arma::uvec AudioDataSet<T>::getBalancedInstanceIndices(AudioClassifyOptions::ClassBalancing balancing, unsigned int seed) const
+{
+	std::vector<std::vector<arma::uword>> soundInstances(numSounds);
 
-	auto dataBlockSize = static_cast<size_t>(data.size() * sizeof(T));
-	MemoryBlock dataMb(data.mem, dataBlockSize);
-	vt.setProperty("Data", var(dataMb), nullptr);
+	for (arma::uword i = 0; i < soundLabelsView.n_elem; ++i)
+	{
+		const auto label = soundLabelsView[i];
 
-	auto soundLabelsBlockSize = static_cast<size_t>(soundLabels.size() * sizeof(int));
-	MemoryBlock soundLabelsMb(soundLabels.mem, soundLabelsBlockSize);
-	vt.setProperty("SoundLabels", var(soundLabelsMb), nullptr);
+		if (label >= 0 && label < numSounds)
+			soundInstances[label].push_back(i);
+	}
 
+	std::size_t smallest = numInstances;
+	std::size_t largest = 0;
 
-	ValueTree featuresUsedTree("FeaturesUsed");
-	
-	for (auto featureFramePair : featuresUsed)
+	for (const auto& instances : soundInstances)
 	{
-		ValueTree pair("FeatureFramePair");
-		pair.setProperty("Frame", var(featureFramePair.first), nullptr);
-		pair.setProperty("Feature", var(static_cast<int>(featureFramePair.second)), nullptr);
+		if (instances.empty())
+			continue;
 
-		featuresUsedTree.addChild(pair, -1, nullptr);
+		smallest = std::min(smallest, instances.size());
+		largest = std::max(largest, instances.size());
 	}
 
-	vt.addChild(featuresUsedTree, -1, nullptr);
+	std::mt19937 randomEngine(seed);
+	std::vector<arma::uword> indices;
 
-
-	FileOutputStream os(file);
-	
-	if (os.getStatus().failed())
+	for (auto& instances : soundInstances)
 	{
-		errorString = "Error creating file";
-		os.flush();
-		return false;
-	}
+		if (instances.empty())
+			continue;
 
-	vt.writeToStream(os);
-	os.flush();
+		switch (balancing)
+		{
+			case AudioClassifyOptions::ClassBalancing::undersample:
+				std::shuffle(instances.begin(), instances.end(), randomEngine);
+				indices.insert(indices.end(), instances.begin(), instances.begin() + smallest);
+				break;
+			case AudioClassifyOptions::ClassBalancing::oversample:
+			{
+				//Every instance once, then shuffled passes over them, so repeat counts differ by at most one.
+				const auto numOriginal = instances.size();
+				indices.insert(indices.end(), instances.begin(), instances.end());
+
+				for (auto filled = numOriginal; filled < largest; filled += numOriginal)
+				{
+					std::shuffle(instances.begin(), instances.end(), randomEngine);
+					indices.insert(indices.end(), instances.begin(), instances.begin() + std::min(numOriginal, largest - filled));
+				}
+				break;
+			}
+			default:
+				indices.insert(indices.end(), instances.begin(), instances.end());
+				break;
+		}
+	}
 
-	return true;
+	return arma::uvec(indices);
 }
 
 //==============================================================================
 template<typename T>
-AudioDataSet<T> AudioDataSet<T>::getVarianceReducedCopy(int numFeatures)
+void AudioDataSet<T>::setSnippetLayout(int newSnippetLength, int newSnippetPreRoll, int newSnippetSampleRate)
 {
-	arma::Mat<T> dataNormalised(data);
-	PreProcessing::normalise(dataNormalised);
+	assert(newSnippetLength >= 0 && newSnippetPreRoll >= 0 && newSnippetPreRoll <= newSnippetLength);
 
-	arma::Col<T> variances = arma::var(dataNormalised, 1, 1);
+	makeDataOwned();
 
-	arma::uvec sorted = arma::sort_index(variances, 1);
-	
-	arma::Mat<T> reducedData(numFeatures, data.n_cols);
-	std::vector<FeatureFramePair> reducedFeaturesUsed;
+	snippetLength = newSnippetLength;
+	snippetPreRoll = newSnippetPreRoll;
+	snippetSampleRate = newSnippetSampleRate;
 
-	for (auto i = 0; i < numFeatures; ++i)
-	{
-		reducedData.row(i) = data.row(sorted[i]);
-		reducedFeaturesUsed.push_back(featuresUsed[sorted[i]]);
-	}
+	if (snippetLength > 0)
+		snippets.zeros(snippetLength, data.n_cols);
+	else
+		snippets.reset();
 
-	AudioDataSet reduced(numSounds, instancesPerSound, bufferSize,
-		stftFramesPerBuffer, numDelayedBuffers);
+	updateViews();
+}
 
-	reduced.data = reducedData;
-	reduced.soundLabels = soundLabels;
-	reduced.featuresUsed = reducedFeaturesUsed;
+//==============================================================================
+template<typename T>
+void AudioDataSet<T>::setSnippet(int instanceIndex, const T* samples)
+{
+	assert(!isMemoryMapped());
+	assert(hasSnippets() && instanceIndex >= 0 && instanceIndex < numInstances);
 
-	return reduced;
+	std::copy(samples, samples + snippetLength, snippets.colptr(instanceIndex));
 }
 
 //==============================================================================
-template <typename T>
-std::vector<std::pair<FeatureFramePair, T>> AudioDataSet<T>::getFeatureVariances()
+template<typename T>
+bool AudioDataSet<T>::hasSnippets() const
 {
-	std::vector<std::pair<FeatureFramePair, T>> results;
+	return snippetLength > 0;
+}
 
-	arma::Mat<T> dataNormalised(data);
-	PreProcessing::normalise(dataNormalised);
+//==============================================================================
+template<typename T>
+int AudioDataSet<T>::getSnippetLength() const
+{
+	return snippetLength;
+}
 
-	arma::Col<T> variances = arma::var(dataNormalised, 1, 1);
-	arma::uvec sorted = arma::sort_index(variances, 1);
+//==============================================================================
+template<typename T>
+int AudioDataSet<T>::getSnippetPreRoll() const
+{
+	return snippetPreRoll;
+}
 
-	for (auto i = 0; i < sorted.n_elem; ++i)
-		results.push_back(std::make_pair(featuresUsed[sorted[i]], variances[sorted[i]]));
+//==============================================================================
+template<typename T>
+int AudioDataSet<T>::getSnippetSampleRate() const
+{
+	return snippetSampleRate;
+}
 
-	return results;
+//==============================================================================
+template<typename T>
+const arma::Mat<T>& AudioDataSet<T>::getSnippets() const
+{
+	return snippetsView;
 }
 
 //==============================================================================
 template<typename T>
-void AudioDataSet<T>::addInstance(const arma::Col<T>& instance, int soundLabel)
+bool AudioDataSet<T>::getReextractedCopy(AudioDataSet<T>& result, int newSTFTFramesPerBuffer, int newNumDelayedBuffers, int newDeltaOrder,
+										 std::string& errorString, ThreadPool* pool) const
 {
-	assert(instance.n_rows == data.n_rows);
-	
-	auto totalInstances = numSounds * instancesPerSound;
+	if (!hasSnippets())
+	{
+		errorString = "Data set has no recorded audio to re-extract from";
+		return false;
+	}
 
-	//May change to assertion. 
-	if (totalInstances == 0)
-		return;
+	if (newSTFTFramesPerBuffer <= 0 || newSTFTFramesPerBuffer > bufferSize || newNumDelayedBuffers < 0 || newDeltaOrder < 0 || newDeltaOrder > 2)
+	{
+		errorString = "Invalid analysis configuration";
+		return false;
+	}
 
-	if (instanceCount == 0)
-		instanceCount = soundLabel * instancesPerSound;
+	if (snippetPreRoll + ((newNumDelayedBuffers + 1) * bufferSize) > snippetLength)
+	{
+		errorString = "Recorded audio is too short for " + std::to_string(newNumDelayedBuffers) + " delayed buffers";
+		return false;
+	}
 
-	if (instanceCount < instancesPerSound * (soundLabel + 1))
+	AudioDataSet<T> reextracted(numSounds, instancesPerSound, bufferSize, newSTFTFramesPerBuffer, newNumDelayedBuffers, newDeltaOrder);
+
+	reextracted.numInstances = numInstances;
+	reextracted.data.zeros(reextracted.featuresUsed.size(), numInstances);
+	reextracted.soundLabels = getSoundLabels();
+	reextracted.soundsReady = soundsReady;
+	reextracted.snippets = getSnippets();
+	reextracted.snippetLength = snippetLength;
+	reextracted.snippetPreRoll = snippetPreRoll;
+	reextracted.snippetSampleRate = snippetSampleRate;
+	reextracted.featureStatisticsValid = false;
+	reextracted.instancesRecorded.clear();
+	reextracted.updateViews();
+
+	const auto totalFrames = reextracted.getTotalNumSTFTFrames();
+	const auto frameRows = reextracted.getFrameRows();
+
+	const auto frameSize = bufferSize / newSTFTFramesPerBuffer;
+	const auto numMFCCs = reextracted.getNumMFCCsUsed();
+	const auto& sourceSnippets = reextracted.snippets;
+	auto& reextractedData = reextracted.data;
+
+	//Unless the frames don't fill each buffer, an instance's frames follow each other from its onset buffer.
+	const auto framesContiguous = (frameSize * newSTFTFramesPerBuffer == bufferSize);
+
+	//Each instance's frames are one batch. One instance is too few frames to split, so the instances are split instead.
+	auto extractInstances = [&](std::size_t begin, std::size_t end)
 	{
-		data.col(instanceCount) = instance;
-		soundLabels[instanceCount] = soundLabel;
+		FeatureExtractor<T> extractor(frameSize, snippetSampleRate);
+		extractor.setNumMFCCs(numMFCCs);
 
-		++instanceCount;
-	}
+		arma::Mat<T> frameFeatures;
+		std::vector<T> frameAudio(framesContiguous ? 0 : static_cast<std::size_t>(totalFrames * frameSize));
+
+		for (auto instance = begin; instance < end; ++instance)
+		{
+			const auto* frames = sourceSnippets.colptr(instance) + snippetPreRoll;
+
+			//Skip the samples left after the last frame of each buffer, as the live classifier does.
+			if (!framesContiguous)
+			{
+				for (auto frame = 0; frame < totalFrames; ++frame)
+				{
+					const auto* frameStart = frames + ((frame / newSTFTFramesPerBuffer) * bufferSize) + ((frame % newSTFTFramesPerBuffer) * frameSize);
+					std::copy(frameStart, frameStart + frameSize, frameAudio.begin() + (frame * frameSize));
+				}
+
+				frames = frameAudio.data();
+			}
+
+			extractor.processFrames(frames, static_cast<std::size_t>(totalFrames), frameSize, frameFeatures);
+
+			for (auto frame = 0; frame < totalFrames; ++frame)
+			{
+				for (const auto& row : frameRows[frame])
+					reextractedData(row.first, instance) = frameFeatures(frame, static_cast<int>(row.second));
+			}
+		}
+	};
+
+	//Ranges are large enough to amortise creating an extractor per range.
+	if (pool != nullptr)
+		pool->parallelFor(sourceSnippets.n_cols, extractInstances, 16);
 	else
-	{
-		soundsReady[soundLabel] = true;
-		instanceCount = 0;
-	}
-	
+		extractInstances(0, sourceSnippets.n_cols);
+
+	result = reextracted;
+
+	return true;
 }
 
 //==============================================================================
 template<typename T>
-bool AudioDataSet<T>::usingFeature(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature)
+bool AudioDataSet<T>::usingFeature(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature) const
 {
 	for (auto featureFramePair : featuresUsed)
 	{
@@ -264,7 +1279,26 @@ bool AudioDataSet<T>::usingFeature(int stftFrameNumber, AudioClassifyOptions::Au
 
 //==============================================================================
 template<typename T>
-int AudioDataSet<T>::getFeatureRowIndex(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature)
+int AudioDataSet<T>::getNumMFCCsUsed() const
+{
+	auto numMFCCs = 0;
+
+	for (const auto& featureFramePair : featuresUsed)
+	{
+		//Delta MFCCs need their base MFCC computed too
+		auto baseFeature = AudioClassifyOptions::getBaseFeature(featureFramePair.second);
+		auto mfccIndex = static_cast<int>(baseFeature) - static_cast<int>(AudioClassifyOptions::AudioFeature::mfcc_1);
+
+		if (mfccIndex >= numMFCCs)
+			numMFCCs = mfccIndex + 1;
+	}
+
+	return numMFCCs;
+}
+
+//==============================================================================
+template<typename T>
+int AudioDataSet<T>::getFeatureRowIndex(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature) const
 {
 	for (auto i = 0; i < featuresUsed.size(); ++i)
 	{
@@ -276,6 +1310,31 @@ int AudioDataSet<T>::getFeatureRowIndex(int stftFrameNumber, AudioClassifyOption
 	return -1;
 }
 
+//==============================================================================
+template<typename T>
+FrameRowTable AudioDataSet<T>::getFrameRows() const
+{
+	return makeFrameRows(featuresUsed, getTotalNumSTFTFrames());
+}
+
+//==============================================================================
+template<typename T>
+FrameRowTable AudioDataSet<T>::makeFrameRows(const std::vector<FeatureFramePair>& features, int totalNumSTFTFrames)
+{
+	FrameRowTable frameRows(totalNumSTFTFrames);
+
+	//Frame numbers in featuresUsed start at 1.
+	for (std::size_t row = 0; row < features.size(); ++row)
+	{
+		const auto frame = features[row].first;
+
+		if (frame >= 1 && frame <= totalNumSTFTFrames)
+			frameRows[frame - 1].push_back(std::make_pair(static_cast<int>(row), features[row].second));
+	}
+
+	return frameRows;
+}
+
 //==============================================================================
 template<typename T>
 std::vector<FeatureFramePair> AudioDataSet<T>::getFeaturesUsed() const
@@ -287,35 +1346,46 @@ std::vector<FeatureFramePair> AudioDataSet<T>::getFeaturesUsed() const
 template<typename T>
 void AudioDataSet<T>::setFeaturesUsed(const std::vector<FeatureFramePair>& newFeaturesUsed)
 {
+	makeDataOwned();
+
 	auto numFeatures = newFeaturesUsed.size();
 	arma::Mat<T> reducedData(numFeatures, getTotalNumInstances());
+	arma::uvec rows(numFeatures);
 
 	for (auto i = 0; i < numFeatures; ++i)
 	{
 		auto feature = newFeaturesUsed[i];
 		auto index = getFeatureRowIndex(feature.first, feature.second);
 		
-		reducedData.row(i) = data.row(index);
+		reducedData.row(i) = dataView.row(index);
+		rows[i] = index;
 	}
 
+	if (featureStatisticsValid)
+		featureStatistics.selectFeatures(rows);
+
 	data.copy_size(reducedData);
 	data = reducedData;
 
 	featuresUsed.resize(0);
 	featuresUsed = newFeaturesUsed;
+
+	featureScaler.reset(featuresUsed.size());
+
+	updateViews();
 }
 //==============================================================================
 template<typename T>
 const arma::Mat<T>& AudioDataSet<T>::getData() const
 {
-	return data;
+	return dataView;
 }
 
 //==============================================================================
 template<typename T>
 const arma::Row<int>& AudioDataSet<T>::getSoundLabels() const
 {
-	return soundLabels;
+	return soundLabelsView;
 }
 
 //==============================================================================
@@ -340,6 +1410,13 @@ int AudioDataSet<T>::getNumDelayedBuffers() const
 	return numDelayedBuffers;
 }
 
+//==============================================================================
+template<typename T>
+int AudioDataSet<T>::getDeltaOrder() const
+{
+	return deltaOrder;
+}
+
 //==============================================================================
 template<typename T>
 int AudioDataSet<T>::getNumSounds() const
@@ -365,7 +1442,7 @@ int AudioDataSet<T>::getNumFeatures() const
 template<typename T>
 int AudioDataSet<T>::getTotalNumInstances() const
 {
-	return numSounds * instancesPerSound;
+	return numInstances;
 }
 
 //==============================================================================
@@ -403,18 +1480,80 @@ bool AudioDataSet<T>::checkSoundReady(const int sound) const
 
 //==============================================================================
 template<typename T>
-void AudioDataSet<T>::setData(const arma::Mat<T>& newData)
+const FeatureScaler<T>& AudioDataSet<T>::getFeatureScaler() const
+{
+	return featureScaler;
+}
+
+//==============================================================================
+template<typename T>
+void AudioDataSet<T>::setFeatureScaler(const FeatureScaler<T>& newFeatureScaler)
+{
+	featureScaler = newFeatureScaler;
+}
+
+//==============================================================================
+template<typename T>
+void AudioDataSet<T>::makeDataOwned()
+{
+	if (!isMemoryMapped())
+		return;
+
+	data = dataView;
+	soundLabels = soundLabelsView;
+	snippets = snippetsView;
+
+	unmapFile();
+	updateViews();
+}
+
+//==============================================================================
+template<typename T>
+void AudioDataSet<T>::unmapFile()
 {
-	data.clear();
-	data = newData;
+	//Release the views before the mapping they point into.
+	dataView.reset();
+	soundLabelsView.reset();
+	snippetsView.reset();
+
+	mappedData = nullptr;
+	mappedSoundLabels = nullptr;
+	mappedSnippets = nullptr;
+	mappedFile.reset();
 }
 
 //==============================================================================
 template<typename T>
-void AudioDataSet<T>::setSoundLabels(const arma::Row<int>& newLabels)
+void AudioDataSet<T>::updateViews()
 {
-	soundLabels.clear();
-	soundLabels = newLabels;
+	auto* dataStart = isMemoryMapped() ? const_cast<T*>(mappedData) : data.memptr();
+	auto* soundLabelsStart = isMemoryMapped() ? const_cast<int*>(mappedSoundLabels) : soundLabels.memptr();
+	auto* snippetsStart = isMemoryMapped() ? const_cast<T*>(mappedSnippets) : snippets.memptr();
+
+	//Not strict, so they can be reset or reassigned without touching the memory they point into.
+	dataView = arma::Mat<T>(dataStart, featuresUsed.size(), numInstances, false, false);
+	soundLabelsView = arma::Row<int>(soundLabelsStart, numInstances, false, false);
+
+	if (hasSnippets())
+		snippetsView = arma::Mat<T>(snippetsStart, snippetLength, numInstances, false, false);
+	else
+		snippetsView.reset();
+}
+
+//==============================================================================
+template<typename T>
+void AudioDataSet<T>::setStorageCapacity(int newCapacity)
+{
+	assert(!isMemoryMapped() && newCapacity >= numInstances);
+
+	//resize() keeps the existing instances.
+	data.resize(featuresUsed.size(), newCapacity);
+	soundLabels.resize(newCapacity);
+
+	if (hasSnippets())
+		snippets.resize(snippetLength, newCapacity);
+
+	updateViews();
 }
 
 //==============================================================================
@@ -429,19 +1568,33 @@ void AudioDataSet<T>::initialise()
 
 	soundsReady.resize(numSounds, false);
 
+	//Delta features need deltaOrder previous frames within the instance
+	auto numFeaturesPerFrame = AudioClassifyOptions::numBaseAudioFeatures * (deltaOrder + 1);
+
 	for (auto i = 0; i < totalFrames; ++i)
 	{
-		for (auto j = 0; j < AudioClassifyOptions::totalNumAudioFeatures; ++j)
+		for (auto j = 0; j < numFeaturesPerFrame; ++j)
 		{
 			auto frame = i + 1;
 			auto feature = static_cast<AudioClassifyOptions::AudioFeature>(j);
-			featuresUsed.push_back(std::make_pair(frame, feature));
+
+			if (AudioClassifyOptions::getDeltaOrder(feature) < frame)
+				featuresUsed.push_back(std::make_pair(frame, feature));
 		}
 	}
 
 	data.set_size(featuresUsed.size(), totalInstances);
 	data.fill(static_cast<T>(0.0));
 
+	numInstances = totalInstances;
+
+	featureScaler.reset(featuresUsed.size());
+
+	featureStatistics.reset(featuresUsed.size());
+	featureStatisticsValid = true;
+	instancesRecorded.assign(totalInstances, false);
+
+	updateViews();
 }
 
 //==============================================================================
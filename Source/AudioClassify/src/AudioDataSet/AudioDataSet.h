@@ -17,12 +17,22 @@
 
 #include <armadillo.h>
 
+#include <memory>
+
 #include "JuceHeader.h"
 
 #include "../AudioClassifyOptions/AudioClassifyOptions.h"
+#include "../PreProcessing/FeatureScaler.h"
+#include "../PreProcessing/FeatureStatistics.h"
 
 using FeatureFramePair = std::pair<int, AudioClassifyOptions::AudioFeature>;
 
+/** The (row, feature) pairs of an instance filled after each STFT frame, indexed by frame number - 1. */
+using FeatureRowPair = std::pair<int, AudioClassifyOptions::AudioFeature>;
+using FrameRowTable = std::vector<std::vector<FeatureRowPair>>;
+
+class ThreadPool;
+
 template<typename T>
 class AudioDataSet
 {
@@ -30,22 +40,122 @@ public:
 
 	AudioDataSet();
 
+	/** @param initDeltaOrder 0 for the base features only, 1 to also use the delta features and 2
+	 *  to use both delta and delta-delta features. Deltas are only added from the 2nd STFT frame of an
+	 *  instance and delta-deltas from the 3rd, as earlier frames have no previous frame to difference.
+	 */
 	AudioDataSet(int initNumSounds, int initInstancePerSound, int initBufferSize,
-		int initSTFTFramesPerBuffer = 1, int initNumDelayedBuffers = 0);
+		int initSTFTFramesPerBuffer = 1, int initNumDelayedBuffers = 0, int initDeltaOrder = 0);
+
+	AudioDataSet(const AudioDataSet<T>& other);
+	AudioDataSet<T>& operator=(const AudioDataSet<T>& other);
 
 	~AudioDataSet();
 
+	/** Loads a data set saved by save(). Binary files (see DataSetFileFormat) are memory mapped
+	 *  and, when saved uncompressed with the same value type as T, the data and labels are used
+	 *  in place without copying. Recording journals (see DataSetJournal) and files in the older ValueTree
+	 *  format are also read.
+	 * Note: Blocks on file IO. Do not call from the audio thread.
+	 */
 	bool load(const std::string& absoluteFilePath, std::string& errorString);
-	bool save(const std::string& absoluteFilePath, std::string& errorString);
 
-	AudioDataSet<T> getVarianceReducedCopy(int numFeatures);
+	/** Saves the data set in the binary DataSetFileFormat.
+	 *  Compressed files are smaller but are decompressed into memory on load instead of being
+	 *  mapped, see DataSetBenchmark to compare the options on a given data set.
+	 * Note: Blocks on file IO. Do not call from the audio thread.
+	 */
+	bool save(const std::string& absoluteFilePath, std::string& errorString,
+			  AudioClassifyOptions::DataSetCompression compression = AudioClassifyOptions::DataSetCompression::none);
+
+	/** @return true if the data is a read only view of a memory mapped file. A mapped data set
+	 *  is complete, so addInstance() is never needed, and any method that changes the data first
+	 *  moves it into owned memory.
+	 */
+	bool isMemoryMapped() const;
+
+	/** @return the numFeatures features with the highest normalised variance, highest first. The
+	 *  features are ranked from getFeatureStatistics(). View them with a FeatureSubset to use them
+	 *  without a copy.
+	 */
+	std::vector<FeatureFramePair> getHighestVarianceFeatures(int numFeatures);
+
+	/** @return every feature with its variance after min-max normalisation, highest first.
+	 *  O(numFeatures) once the statistics are up to date, see getFeatureStatistics().
+	 */
 	std::vector<std::pair<FeatureFramePair, T>> getFeatureVariances();
 
-	void addInstance(const arma::Col<T>& instance, int soundLabel);
+	/** Running statistics of every feature over the instances recorded or loaded. Kept up to date
+	 *  by addInstance(), append() and setFeaturesUsed(). After a load, or if a recorded instance
+	 *  is overwritten, they are recomputed in one pass over the data on the next call.
+	 */
+	const FeatureStatistics<T>& getFeatureStatistics();
+
+	/** Rebuilds the feature data for a new analysis configuration from the recorded snippets, so
+	 *  changing the STFT frames, delayed buffers or delta order does not need a re-recording. Each
+	 *  instance is extracted as the live classifier would have from the buffers starting at its
+	 *  onset, using every feature of the new configuration. The labels and snippets are kept.
+	 * Note: This method allocates and blocks. Do not call from the audio thread.
+	 * @param pool if not nullptr instances are extracted in parallel on its threads.
+	 * @return false with errorString set if the data set has no snippets or they are too short.
+	 */
+	bool getReextractedCopy(AudioDataSet<T>& result, int newSTFTFramesPerBuffer, int newNumDelayedBuffers, int newDeltaOrder,
+							std::string& errorString, ThreadPool* pool = nullptr) const;
+
+	/** @return the instance column the instance was stored in, or -1 if the sound was already complete. */
+	int addInstance(const arma::Col<T>& instance, int soundLabel);
+
+	/** Appends every instance of other, e.g. to combine recordings from several sessions or performers.
+	 *  Both data sets must be complete and have the same buffer size, STFT frames, delayed buffers and
+	 *  feature layout. Sounds are matched by label, so the result has the larger number of sounds and
+	 *  may hold a different number of instances of each. Snippets are kept if both data sets have them
+	 *  with the same layout, otherwise they are dropped. The feature scaler is reset.
+	 *  Storage grows geometrically, so a series of appends only copies the instances added.
+	 * Note: This method allocates. Do not call from the audio thread.
+	 */
+	bool append(const AudioDataSet<T>& other, std::string& errorString);
+
+	/** Allocates storage for newCapacity instances so appends up to that size do not reallocate.
+	 * Note: This method allocates. Do not call from the audio thread.
+	 */
+	void reserveInstances(int newCapacity);
+
+	/** @return the number of instances of each sound, which may differ after append(). */
+	std::vector<int> getNumInstancesOfSounds() const;
+
+	/** @return the instance columns of a class balanced sample of the data set, grouped by sound.
+	 *  With ClassBalancing::none every column is returned. Repeatable for a given seed.
+	 */
+	arma::uvec getBalancedInstanceIndices(AudioClassifyOptions::ClassBalancing balancing, unsigned int seed = 1234) const;
+
+	/** Allocates room for a raw audio snippet per instance (see SnippetRecorder), zeroed until set.
+	 *  A snippet holds snippetPreRoll samples before the instance's onset buffer followed by the
+	 *  onset buffer and the buffers after it.
+	 * Note: This method allocates. Do not call from the audio thread.
+	 * @param newSnippetLength the samples per snippet, 0 to hold no snippets.
+	 */
+	void setSnippetLayout(int newSnippetLength, int newSnippetPreRoll, int newSnippetSampleRate);
+
+	/** Copies getSnippetLength() samples into the snippet of an instance column. Does not allocate. */
+	void setSnippet(int instanceIndex, const T* samples);
+
+	bool hasSnippets() const;
+	int getSnippetLength() const;
+	int getSnippetPreRoll() const;
+	int getSnippetSampleRate() const;
+
+	/** @return the snippets, getSnippetLength() x getTotalNumInstances(). */
+	const arma::Mat<T>& getSnippets() const;
 
 	//NOTE: Potentially add setUsingFeature method in future to allow explicit on/off of features. 
-	bool usingFeature(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature);
-	int getFeatureRowIndex(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature);
+	bool usingFeature(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature) const;
+	int getFeatureRowIndex(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature) const;
+
+	/** Groups the rows of features by the STFT frame they are extracted from, so filling an instance
+	 *  frame by frame doesn't have to search featuresUsed for every feature.
+	 */
+	FrameRowTable getFrameRows() const;
+	static FrameRowTable makeFrameRows(const std::vector<FeatureFramePair>& features, int totalNumSTFTFrames);
 
 	/** Returns a vector of Feature-Frame pairs containing all features used by this dataset.
 	 * Note: This method shold not be called from an audio callback thread as it returns a 
@@ -54,6 +164,11 @@ public:
 	std::vector<FeatureFramePair> getFeaturesUsed() const;
 	void setFeaturesUsed(const std::vector<FeatureFramePair>& newFeaturesUsed);
 
+	/** @return the number of MFCCs a FeatureExtractor has to compute for this data set, i.e. the
+	 *  index of the highest MFCC used in any frame + 1.
+	 */
+	int getNumMFCCsUsed() const;
+
 	const arma::Mat<T>& getData() const;
 	const arma::Row<int>& getSoundLabels() const;
 
@@ -64,8 +179,13 @@ public:
 
 	int getNumDelayedBuffers() const;
 
+	int getDeltaOrder() const;
+
 	int getNumSounds() const;
 
+	/** @return the number of instances recorded per sound. For data sets built with append() or
+	 *  loaded from a journal, the number of instances of the sound with the fewest.
+	 */
 	int getInstancesPerSound() const;
 
 	int getNumFeatures() const;
@@ -74,6 +194,12 @@ public:
 	int getTotalNumSTFTFrames() const;
 
 	bool isReady() const;
+
+	/** The scaler fitted to this data set when a model was last trained on it. It is saved and
+	 *  loaded with the data set. Identity (ScalerType::none) until set.
+	 */
+	const FeatureScaler<T>& getFeatureScaler() const;
+	void setFeatureScaler(const FeatureScaler<T>& newFeatureScaler);
 	
 	bool checkSoundReady(const int sound) const;
 
@@ -85,21 +211,60 @@ private:
 	int bufferSize;
 	int stftFramesPerBuffer;
 	int numDelayedBuffers;
+	int deltaOrder;
 
 	int numSounds;
 	int instancesPerSound;
 
+	//Equal to numSounds * instancesPerSound unless built with append() or loaded from a journal.
+	int numInstances = 0;
+
+	int snippetLength = 0;
+	int snippetPreRoll = 0;
+	int snippetSampleRate = 0;
+
 	std::vector<bool> soundsReady;
 
+	//Owned storage. May have room for more than numInstances instances, see reserveInstances().
 	arma::Mat<T> data;
 	arma::Row<int> soundLabels;
+	arma::Mat<T> snippets;
+
+	//Sections of the mapped file, used in place of the owned storage while it is mapped.
+	std::shared_ptr<MemoryMappedFile> mappedFile;
+	const T* mappedData = nullptr;
+	const int* mappedSoundLabels = nullptr;
+	const T* mappedSnippets = nullptr;
+
+	//Non owning views of the first numInstances instances of the mapped sections or owned storage.
+	arma::Mat<T> dataView;
+	arma::Row<int> soundLabelsView;
+	arma::Mat<T> snippetsView;
 
 	std::vector<FeatureFramePair> featuresUsed;
 
-	void setData(const arma::Mat<T>& newData);
-	void setSoundLabels(const arma::Row<int>& newLabels);
+	FeatureScaler<T> featureScaler;
+
+	FeatureStatistics<T> featureStatistics;
+	bool featureStatisticsValid = false;
+
+	//Instance columns added to featureStatistics by addInstance(). Columns beyond it count as added.
+	std::vector<bool> instancesRecorded;
+
+	bool loadBinary(const File& file, std::string& errorString);
+	bool loadJournal(const File& file, std::string& errorString);
+	bool loadValueTree(const File& file, std::string& errorString);
+
+	void swap(AudioDataSet<T>& other);
+
+	void makeDataOwned();
+	void unmapFile();
+	void updateViews();
+	void setStorageCapacity(int newCapacity);
 
 	void initialise();
+
+	arma::uvec getHighestVarianceRows(int numFeatures);
 };
 
 
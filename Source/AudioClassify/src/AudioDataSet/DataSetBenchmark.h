@@ -0,0 +1,161 @@
+/*
+  ==============================================================================
+
+    DataSetBenchmark.h
+    Created: 19 Oct 2026 11:03:41pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef DATASETBENCHMARK_H_INCLUDED
+#define DATASETBENCHMARK_H_INCLUDED
+
+#include <vector>
+#include <chrono>
+#include <random>
+#include <string>
+
+#include "AudioDataSet.h"
+
+/** Benchmarks comparing the DataSetCompression options of AudioDataSet::save(). Each option is
+ *  saved to and loaded from the same file so the file size, save time and load time can be
+ *  weighed against each other for a given data set.
+ *
+ *  Uncompressed files are memory mapped on load and only read as the data is used, so every
+ *  load is followed by one pass over the data to make the load times comparable.
+ *
+ *  Note: These functions allocate and block on file IO for the duration of the benchmark. Do
+ *  not call from the audio thread.
+ */
+namespace DataSetBenchmark
+{
+	struct Result
+	{
+		AudioClassifyOptions::DataSetCompression compression;
+		int numFeatures;
+		int numInstances;
+		std::int64_t fileSize;
+		double saveMilliseconds;
+		double loadMilliseconds;
+	};
+
+	//===============================================================================
+	/** Builds a complete data set of random instances clustered by sound. A nearConstantFraction
+	 *  of the features only vary in their lowest bits, as recorded features that barely change
+	 *  between instances (e.g. high MFCCs of a percussive sound) do.
+	 */
+	template<typename T>
+	AudioDataSet<T> makeDataSet(int numSounds, int instancesPerSound, int stftFramesPerBuffer, int deltaOrder,
+								double nearConstantFraction = 0.5)
+	{
+		AudioDataSet<T> dataSet(numSounds, instancesPerSound, 512, stftFramesPerBuffer, 0, deltaOrder);
+
+		const auto numFeatures = dataSet.getNumFeatures();
+
+		std::mt19937 randomEngine(1234);
+		std::uniform_real_distribution<double> centres(-10.0, 10.0);
+		std::uniform_real_distribution<double> choice(0.0, 1.0);
+		std::normal_distribution<double> spread(0.0, 1.0);
+
+		arma::Mat<T> soundCentres(numFeatures, numSounds);
+		std::vector<double> featureSpreads(numFeatures);
+
+		for (std::size_t i = 0; i < soundCentres.n_elem; ++i)
+			soundCentres[i] = static_cast<T>(centres(randomEngine));
+
+		for (auto& featureSpread : featureSpreads)
+			featureSpread = (choice(randomEngine) < nearConstantFraction) ? 1.0e-6 : 1.0;
+
+		arma::Col<T> instance(numFeatures);
+
+		for (auto sound = 0; sound < numSounds; ++sound)
+		{
+			for (auto i = 0; i < instancesPerSound; ++i)
+			{
+				for (auto f = 0; f < numFeatures; ++f)
+					instance[f] = soundCentres(f, sound) + static_cast<T>(featureSpreads[f] * spread(randomEngine));
+
+				dataSet.addInstance(instance, sound);
+			}
+
+			//As when recording, adding past the last instance marks the sound ready.
+			dataSet.addInstance(instance, sound);
+		}
+
+		return dataSet;
+	}
+
+	//===============================================================================
+	/** Saves dataSet to filePath with one compression option then loads it back.
+	 * @return the result, with negative times if the save or load failed.
+	 */
+	template<typename T>
+	Result timeCompression(AudioDataSet<T>& dataSet, AudioClassifyOptions::DataSetCompression compression,
+						   const std::string& filePath)
+	{
+		Result result { compression, dataSet.getNumFeatures(), dataSet.getTotalNumInstances(), 0, -1.0, -1.0 };
+		std::string errorString;
+
+		const auto saveStart = std::chrono::steady_clock::now();
+
+		if (!dataSet.save(filePath, errorString, compression))
+			return result;
+
+		const auto saveEnd = std::chrono::steady_clock::now();
+
+		AudioDataSet<T> loaded;
+
+		const auto loadStart = std::chrono::steady_clock::now();
+
+		if (!loaded.load(filePath, errorString))
+			return result;
+
+		//Keep the pass over the data observable so it is not optimised away.
+		volatile T checksum = arma::accu(loaded.getData());
+		(void) checksum;
+
+		const auto loadEnd = std::chrono::steady_clock::now();
+
+		const std::chrono::duration<double, std::milli> saveElapsed = saveEnd - saveStart;
+		const std::chrono::duration<double, std::milli> loadElapsed = loadEnd - loadStart;
+
+		result.fileSize = File(filePath).getSize();
+		result.saveMilliseconds = saveElapsed.count();
+		result.loadMilliseconds = loadElapsed.count();
+
+		return result;
+	}
+
+	//===============================================================================
+	/** Times every compression option on synthetic data sets of each size, using filePath as
+	 *  scratch space. The file is deleted afterwards. The defaults compare a small and a large
+	 *  library of 4 STFT frames with deltas and delta-deltas.
+	 */
+	template<typename T>
+	std::vector<Result> run(const std::string& filePath,
+							const std::vector<int>& instancesPerSoundCounts = { 50, 2000 },
+							int numSounds = 8, int stftFramesPerBuffer = 4, int deltaOrder = 2)
+	{
+		std::vector<Result> results;
+
+		const AudioClassifyOptions::DataSetCompression compressions[] = { AudioClassifyOptions::DataSetCompression::none,
+																		  AudioClassifyOptions::DataSetCompression::gzip,
+																		  AudioClassifyOptions::DataSetCompression::shuffledGZIP };
+
+		for (auto instancesPerSound : instancesPerSoundCounts)
+		{
+			auto dataSet = makeDataSet<T>(numSounds, instancesPerSound, stftFramesPerBuffer, deltaOrder);
+
+			for (auto compression : compressions)
+				results.push_back(timeCompression<T>(dataSet, compression, filePath));
+		}
+
+		File(filePath).deleteFile();
+
+		return results;
+	}
+}
+
+
+#endif  // DATASETBENCHMARK_H_INCLUDED
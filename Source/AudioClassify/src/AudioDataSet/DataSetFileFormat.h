@@ -0,0 +1,291 @@
+/*
+  ==============================================================================
+
+    DataSetFileFormat.h
+    Created: 19 Oct 2026 9:02:37pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef DATASETFILEFORMAT_H_INCLUDED
+#define DATASETFILEFORMAT_H_INCLUDED
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+/** Layout of the binary AudioDataSet file written by AudioDataSet::save().
+ *
+ *  [Header][FeatureLayoutEntry x numFeatures][data][labels][scaler scales][scaler offsets][snippets]
+ *
+ *  The data is the numFeatures x numInstances matrix in column major order, the labels are one
+ *  int32 per instance and the optional scaler parameters are numFeatures values each. The optional
+ *  snippets are the snippetLength x numInstances matrix of raw audio recorded around each
+ *  instance's onset, see AudioDataSet::setSnippetLayout(). Values are valueSize bytes (float or
+ *  double as saved), everything is little endian and every section starts on a sectionAlignment
+ *  boundary. A memory mapped file can therefore be wrapped by arma::Mat directly without copying.
+ *
+ *  Sounds may have different numbers of instances (see AudioDataSet::append()), so numInstances
+ *  need not be numSounds x instancesPerSound.
+ *
+ *  The data, labels and snippets may be saved compressed (see flags). Each is then a zlib stream
+ *  of its stored size, optionally of byte shuffled blocks of whole instances (see shuffleBytes()),
+ *  and is decompressed into memory on load rather than mapped. The feature layout and scaler are
+ *  small and never compressed.
+ *
+ *  Recording journals (see DataSetJournal) use a second, append only layout:
+ *
+ *  [JournalHeader][FeatureLayoutEntry x numFeatures][record][record]...
+ *
+ *  Each record is an int32 sound label followed by numFeatures values. A record cut short by a
+ *  crash is ignored when the journal is read or reopened.
+ */
+namespace DataSetFileFormat
+{
+	static const char magic[8] = { 'B', 'B', 'V', 'X', 'D', 'S', 'E', 'T' };
+	static const std::uint32_t currentVersion = 1;
+	static const std::uint64_t sectionAlignment = 64;
+
+	//Header flags.
+	static const std::uint32_t flagGZIP = 1 << 0;
+	static const std::uint32_t flagByteShuffle = 1 << 1;
+
+	//Compressed sections are shuffled and streamed in blocks of whole instances of about this many values.
+	static const std::size_t shuffleBlockValues = 16384;
+
+	struct Header
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t headerSize;
+		std::uint32_t valueSize;
+		std::uint32_t flags;
+
+		std::int32_t numSounds;
+		std::int32_t instancesPerSound;
+		std::int32_t bufferSize;
+		std::int32_t stftFramesPerBuffer;
+		std::int32_t numDelayedBuffers;
+		std::int32_t deltaOrder;
+		std::int32_t numFeatures;
+		std::int32_t numInstances;
+		std::int32_t scalerType;
+		std::uint32_t reserved;
+
+		//Byte offsets from the start of the file. scalerOffset is 0 when no scaler is saved.
+		std::uint64_t featureLayoutOffset;
+		std::uint64_t dataOffset;
+		std::uint64_t labelsOffset;
+		std::uint64_t scalerOffset;
+		std::uint64_t fileSize;
+
+		//snippetOffset is 0 when no snippets are saved.
+		std::int32_t snippetLength;
+		std::int32_t snippetPreRoll;
+		std::int32_t snippetSampleRate;
+		std::uint32_t reserved2;
+		std::uint64_t snippetOffset;
+
+		//Bytes stored in each section, smaller than the values they hold when compressed.
+		std::uint64_t dataStoredSize;
+		std::uint64_t labelsStoredSize;
+		std::uint64_t snippetStoredSize;
+	};
+
+	static_assert(sizeof(Header) == 152, "DataSetFileFormat::Header layout must not change within a version");
+
+	struct FeatureLayoutEntry
+	{
+		std::int32_t frame;
+		std::int32_t feature;
+	};
+
+	static const char journalMagic[8] = { 'B', 'B', 'V', 'X', 'J', 'R', 'N', 'L' };
+	static const std::uint32_t currentJournalVersion = 1;
+
+	struct JournalHeader
+	{
+		char magic[8];
+		std::uint32_t version;
+		std::uint32_t headerSize;
+		std::uint32_t valueSize;
+
+		std::int32_t numFeatures;
+		std::int32_t bufferSize;
+		std::int32_t stftFramesPerBuffer;
+		std::int32_t numDelayedBuffers;
+		std::int32_t deltaOrder;
+	};
+
+	static_assert(sizeof(JournalHeader) == 40, "DataSetFileFormat::JournalHeader layout must not change within a version");
+
+	//===============================================================================
+	inline std::uint64_t alignOffset(std::uint64_t offset)
+	{
+		return (offset + sectionAlignment - 1) & ~(sectionAlignment - 1);
+	}
+
+	inline bool isCompressed(const Header& header)
+	{
+		return (header.flags & flagGZIP) != 0;
+	}
+
+	/** Regroups numRecords records (instances) of recordValues values of valueSize bytes by byte
+	 *  significance, then by value within the record, i.e. the first byte of the first feature of
+	 *  every instance, then of the second feature and so on. The sign, exponent and high mantissa
+	 *  bytes of a feature vary little between instances so form long runs that compress well.
+	 */
+	inline void shuffleBytes(const char* source, char* destination, std::size_t numRecords, std::size_t recordValues, std::size_t valueSize)
+	{
+		const auto numValues = numRecords * recordValues;
+
+		for (std::size_t r = 0; r < numRecords; ++r)
+			for (std::size_t v = 0; v < recordValues; ++v)
+				for (std::size_t b = 0; b < valueSize; ++b)
+					destination[(b * numValues) + (v * numRecords) + r] = source[(((r * recordValues) + v) * valueSize) + b];
+	}
+
+	/** Reverses shuffleBytes(). */
+	inline void unshuffleBytes(const char* source, char* destination, std::size_t numRecords, std::size_t recordValues, std::size_t valueSize)
+	{
+		const auto numValues = numRecords * recordValues;
+
+		for (std::size_t r = 0; r < numRecords; ++r)
+			for (std::size_t v = 0; v < recordValues; ++v)
+				for (std::size_t b = 0; b < valueSize; ++b)
+					destination[(((r * recordValues) + v) * valueSize) + b] = source[(b * numValues) + (v * numRecords) + r];
+	}
+
+	/** @return the number of whole records of recordValues values in each compressed block. */
+	inline std::size_t getRecordsPerBlock(std::size_t recordValues)
+	{
+		return (recordValues < shuffleBlockValues) ? shuffleBlockValues / recordValues : 1;
+	}
+
+	/** @return true if the size bytes at data start with the binary data set magic. */
+	inline bool hasMagic(const void* data, std::size_t size)
+	{
+		return size >= sizeof(magic) && std::memcmp(data, magic, sizeof(magic)) == 0;
+	}
+
+	inline bool hasJournalMagic(const void* data, std::size_t size)
+	{
+		return size >= sizeof(journalMagic) && std::memcmp(data, journalMagic, sizeof(journalMagic)) == 0;
+	}
+
+	inline std::uint64_t getJournalRecordsOffset(const JournalHeader& header)
+	{
+		return header.headerSize + (static_cast<std::uint64_t>(header.numFeatures) * sizeof(FeatureLayoutEntry));
+	}
+
+	inline std::uint64_t getJournalRecordSize(const JournalHeader& header)
+	{
+		return sizeof(std::int32_t) + (static_cast<std::uint64_t>(header.numFeatures) * header.valueSize);
+	}
+
+	/** @return an empty string if a journal header read from a file of fileSize bytes is usable, otherwise the reason it is not. */
+	inline const char* validateJournal(const JournalHeader& header, std::uint64_t fileSize)
+	{
+		if (!hasJournalMagic(header.magic, sizeof(header.magic)))
+			return "Not a data set journal";
+
+		if (header.version == 0 || header.version > currentJournalVersion)
+			return "Journal was recorded by a newer version";
+
+		if (header.headerSize < sizeof(JournalHeader))
+			return "Corrupt journal header";
+
+		if (header.valueSize != sizeof(float) && header.valueSize != sizeof(double))
+			return "Unsupported journal value size";
+
+		if (header.numFeatures <= 0)
+			return "Corrupt journal dimensions";
+
+		if (fileSize < getJournalRecordsOffset(header))
+			return "Journal is truncated";
+
+		return "";
+	}
+
+	/** Fills in the section offsets of header from its counts and sizes. Uncompressed sections are
+	 *  stored at their full size, the stored sizes of compressed ones must already be set. Offsets
+	 *  only depend on the sizes of the sections before them, so a writer that compresses as it
+	 *  goes can lay out each section once the previous one is written.
+	 */
+	inline void layoutSections(Header& header, bool hasScaler)
+	{
+		const auto numFeatures = static_cast<std::uint64_t>(header.numFeatures);
+		const auto numInstances = static_cast<std::uint64_t>(header.numInstances);
+
+		if (!isCompressed(header))
+		{
+			header.dataStoredSize = numFeatures * numInstances * header.valueSize;
+			header.labelsStoredSize = numInstances * sizeof(std::int32_t);
+			header.snippetStoredSize = static_cast<std::uint64_t>(header.snippetLength) * numInstances * header.valueSize;
+		}
+
+		header.featureLayoutOffset = alignOffset(header.headerSize);
+		header.dataOffset = alignOffset(header.featureLayoutOffset + (numFeatures * sizeof(FeatureLayoutEntry)));
+		header.labelsOffset = alignOffset(header.dataOffset + header.dataStoredSize);
+
+		const auto labelsEnd = header.labelsOffset + header.labelsStoredSize;
+
+		header.scalerOffset = hasScaler ? alignOffset(labelsEnd) : 0;
+		header.fileSize = hasScaler ? header.scalerOffset + (2 * numFeatures * header.valueSize) : labelsEnd;
+
+		if (header.snippetLength > 0)
+		{
+			header.snippetOffset = alignOffset(header.fileSize);
+			header.fileSize = header.snippetOffset + header.snippetStoredSize;
+		}
+		else
+		{
+			header.snippetOffset = 0;
+		}
+	}
+
+	/** Checks a header read from a file of fileSize bytes before any section is accessed.
+	 * @return an empty string if the header is usable, otherwise the reason it is not.
+	 */
+	inline const char* validate(const Header& header, std::uint64_t fileSize)
+	{
+		if (!hasMagic(header.magic, sizeof(header.magic)))
+			return "Not a binary data set file";
+
+		if (header.version == 0 || header.version > currentVersion)
+			return "Data set file was saved by a newer version";
+
+		if (header.headerSize < sizeof(Header))
+			return "Corrupt data set header";
+
+		if ((header.flags & ~(flagGZIP | flagByteShuffle)) != 0 || ((header.flags & flagByteShuffle) != 0 && !isCompressed(header)))
+			return "Unsupported data set compression";
+
+		if (header.valueSize != sizeof(float) && header.valueSize != sizeof(double))
+			return "Unsupported data set value size";
+
+		if (header.numFeatures <= 0 || header.numInstances <= 0 || header.numSounds <= 0 || header.instancesPerSound < 0)
+			return "Corrupt data set dimensions";
+
+		if (header.snippetLength < 0 || header.snippetPreRoll < 0 || header.snippetPreRoll > header.snippetLength
+			|| (header.snippetLength > 0 && header.snippetSampleRate <= 0))
+			return "Corrupt data set snippet layout";
+
+		Header expected = header;
+		layoutSections(expected, header.scalerOffset != 0);
+
+		if (header.featureLayoutOffset != expected.featureLayoutOffset || header.dataOffset != expected.dataOffset
+			|| header.labelsOffset != expected.labelsOffset || header.scalerOffset != expected.scalerOffset
+			|| header.snippetOffset != expected.snippetOffset || header.fileSize != expected.fileSize)
+			return "Corrupt data set section offsets";
+
+		if (fileSize < header.fileSize)
+			return "Data set file is truncated";
+
+		return "";
+	}
+}
+
+
+#endif  // DATASETFILEFORMAT_H_INCLUDED
@@ -0,0 +1,246 @@
+/*
+  ==============================================================================
+
+    DataSetJournal.cpp
+    Created: 19 Oct 2026 9:48:51pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "DataSetJournal.h"
+#include "DataSetFileFormat.h"
+
+#include <chrono>
+#include <cstring>
+#include <cassert>
+
+//==============================================================================
+template<typename T>
+DataSetJournal<T>::DataSetJournal()
+	: accepting(false),
+	  writerRunning(false),
+	  numDropped(0),
+	  numFeatures(0)
+{
+}
+
+//==============================================================================
+template<typename T>
+DataSetJournal<T>::~DataSetJournal()
+{
+	close();
+}
+
+//==============================================================================
+template<typename T>
+bool DataSetJournal<T>::open(const std::string& absoluteFilePath, const AudioDataSet<T>& dataSet, std::string& errorString)
+{
+	close();
+
+	File file(absoluteFilePath);
+
+	const auto featuresUsed = dataSet.getFeaturesUsed();
+
+	DataSetFileFormat::JournalHeader header {};
+
+	std::memcpy(header.magic, DataSetFileFormat::journalMagic, sizeof(header.magic));
+	header.version = DataSetFileFormat::currentJournalVersion;
+	header.headerSize = sizeof(header);
+	header.valueSize = sizeof(T);
+	header.numFeatures = static_cast<std::int32_t>(featuresUsed.size());
+	header.bufferSize = dataSet.getBufferSize();
+	header.stftFramesPerBuffer = dataSet.getSTFTFramesPerBuffer();
+	header.numDelayedBuffers = dataSet.getNumDelayedBuffers();
+	header.deltaOrder = dataSet.getDeltaOrder();
+
+	const auto appending = file.exists() && file.getSize() > 0;
+	std::uint64_t validSize = 0;
+
+	if (appending)
+	{
+		FileInputStream is(file);
+		DataSetFileFormat::JournalHeader existing;
+
+		const auto fileSize = static_cast<std::uint64_t>(file.getSize());
+
+		if (is.getStatus().failed() || is.read(&existing, static_cast<int>(sizeof(existing))) != static_cast<int>(sizeof(existing)))
+		{
+			errorString = "Error reading journal";
+			return false;
+		}
+
+		const std::string headerError = DataSetFileFormat::validateJournal(existing, fileSize);
+
+		if (!headerError.empty())
+		{
+			errorString = headerError;
+			return false;
+		}
+
+		auto matches = existing.valueSize == header.valueSize && existing.numFeatures == header.numFeatures
+					   && existing.bufferSize == header.bufferSize && existing.stftFramesPerBuffer == header.stftFramesPerBuffer
+					   && existing.numDelayedBuffers == header.numDelayedBuffers && existing.deltaOrder == header.deltaOrder;
+
+		is.setPosition(existing.headerSize);
+
+		for (std::size_t i = 0; matches && i < featuresUsed.size(); ++i)
+		{
+			DataSetFileFormat::FeatureLayoutEntry entry;
+			is.read(&entry, static_cast<int>(sizeof(entry)));
+
+			matches = entry.frame == featuresUsed[i].first && entry.feature == static_cast<std::int32_t>(featuresUsed[i].second);
+		}
+
+		if (!matches)
+		{
+			errorString = "Journal was recorded with a different feature layout";
+			return false;
+		}
+
+		const auto recordsOffset = DataSetFileFormat::getJournalRecordsOffset(existing);
+		const auto recordSize = DataSetFileFormat::getJournalRecordSize(existing);
+
+		validSize = recordsOffset + (((fileSize - recordsOffset) / recordSize) * recordSize);
+	}
+
+	stream.reset(new FileOutputStream(file));
+
+	if (stream->getStatus().failed())
+	{
+		errorString = "Error opening journal";
+		stream.reset();
+		return false;
+	}
+
+	if (appending)
+	{
+		//Drop a record cut short by a crash so new records line up.
+		stream->setPosition(static_cast<int64>(validSize));
+		stream->truncate();
+	}
+	else
+	{
+		stream->write(&header, sizeof(header));
+
+		for (const auto& featureFramePair : featuresUsed)
+		{
+			const DataSetFileFormat::FeatureLayoutEntry entry { featureFramePair.first, static_cast<std::int32_t>(featureFramePair.second) };
+			stream->write(&entry, sizeof(entry));
+		}
+
+		stream->flush();
+	}
+
+	numFeatures = featuresUsed.size();
+
+	queue.reset(new SPSCQueue<T>(queueCapacity, numFeatures + 1));
+	pushRecord.assign(numFeatures + 1, static_cast<T>(0.0));
+	writeRecord.assign(numFeatures + 1, static_cast<T>(0.0));
+
+	numDropped.store(0);
+
+	writerRunning.store(true);
+	writerThread = std::thread([this]() { writerLoop(); });
+
+	accepting.store(true);
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+void DataSetJournal<T>::close()
+{
+	accepting.store(false);
+
+	if (writerThread.joinable())
+	{
+		writerRunning.store(false);
+		writerThread.join();
+	}
+
+	stream.reset();
+}
+
+//==============================================================================
+template<typename T>
+bool DataSetJournal<T>::isOpen() const
+{
+	return accepting.load();
+}
+
+//==============================================================================
+template<typename T>
+bool DataSetJournal<T>::push(const arma::Col<T>& instance, int soundLabel)
+{
+	if (!accepting.load())
+		return false;
+
+	assert(instance.n_elem == numFeatures);
+
+	//Sound labels are small integers so are held exactly in the record's first value.
+	pushRecord[0] = static_cast<T>(soundLabel);
+	std::copy(instance.memptr(), instance.memptr() + numFeatures, pushRecord.data() + 1);
+
+	if (!queue->push(pushRecord.data()))
+	{
+		numDropped.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+std::size_t DataSetJournal<T>::getNumDropped() const
+{
+	return numDropped.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+template<typename T>
+void DataSetJournal<T>::writerLoop()
+{
+	while (writerRunning.load())
+	{
+		if (!writeQueued())
+			std::this_thread::sleep_for(std::chrono::milliseconds(writerIntervalMs));
+	}
+
+	//Anything pushed before close() stopped accepting.
+	writeQueued();
+}
+
+//==============================================================================
+template<typename T>
+bool DataSetJournal<T>::writeQueued()
+{
+	auto numWritten = 0;
+
+	while (queue->pop(writeRecord.data()))
+	{
+		const auto soundLabel = static_cast<std::int32_t>(writeRecord[0]);
+
+		stream->write(&soundLabel, sizeof(soundLabel));
+		stream->write(writeRecord.data() + 1, numFeatures * sizeof(T));
+
+		++numWritten;
+	}
+
+	//Flushed after every batch so a crash only loses instances still in the queue.
+	if (numWritten > 0)
+		stream->flush();
+
+	return numWritten > 0;
+}
+
+//==============================================================================
+//Passed by reference to std::chrono, so needs a definition.
+template<typename T>
+const int DataSetJournal<T>::writerIntervalMs;
+
+//==============================================================================
+template class DataSetJournal<float>;
+template class DataSetJournal<double>;
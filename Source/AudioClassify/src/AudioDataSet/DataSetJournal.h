@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    DataSetJournal.h
+    Created: 19 Oct 2026 9:48:51pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef DATASETJOURNAL_H_INCLUDED
+#define DATASETJOURNAL_H_INCLUDED
+
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <vector>
+
+#include "AudioDataSet.h"
+#include "../Threading/SPSCQueue.h"
+
+/** Append only recording journal for an AudioDataSet (see DataSetFileFormat).
+ *
+ *  Instances pushed from the audio thread go into a lock free SPSCQueue and a background
+ *  writer thread appends them to the journal file, flushing after every batch. The journal
+ *  is not limited by the data set's preallocated size, can be reopened to carry on recording
+ *  over several sessions and keeps every instance written before a crash. It is read back
+ *  with AudioDataSet::load().
+ */
+template<typename T>
+class DataSetJournal
+{
+public:
+	DataSetJournal();
+	~DataSetJournal();
+
+	/** Opens a journal for instances with the feature layout of dataSet and starts the writer
+	 *  thread. A missing file is created. An existing journal is appended to if it was recorded
+	 *  with the same layout and value type, after dropping any partly written last record.
+	 * Note: Allocates and blocks on file IO. Do not call from the audio thread or whilst instances are being pushed.
+	 * @param errorString output parameter which will contain an error message if applicable.
+	 * @return true if the journal is open.
+	 */
+	bool open(const std::string& absoluteFilePath, const AudioDataSet<T>& dataSet, std::string& errorString);
+
+	/** Stops accepting instances, writes any still queued and stops the writer thread.
+	 * Note: Blocks. Do not call from the audio thread or whilst instances are being pushed.
+	 */
+	void close();
+
+	bool isOpen() const;
+
+	/** Queues an instance to be appended to the journal. Lock free and does not allocate.
+	 * @return false if the journal is not open, or the queue is full and the instance was dropped.
+	 */
+	bool push(const arma::Col<T>& instance, int soundLabel);
+
+	/** @return the number of instances dropped since open() because the writer fell queueCapacity instances behind. */
+	std::size_t getNumDropped() const;
+
+	static const std::size_t queueCapacity = 1024;
+	static const int writerIntervalMs = 10;
+
+private:
+	std::unique_ptr<SPSCQueue<T>> queue;
+	std::unique_ptr<FileOutputStream> stream;
+	std::thread writerThread;
+
+	std::atomic_bool accepting;
+	std::atomic_bool writerRunning;
+	std::atomic<std::size_t> numDropped;
+
+	std::size_t numFeatures;
+
+	//Queue records are [sound label, features...]. One buffer for each side of the queue.
+	std::vector<T> pushRecord;
+	std::vector<T> writeRecord;
+
+	void writerLoop();
+	bool writeQueued();
+
+	DataSetJournal(const DataSetJournal&) = delete;
+	DataSetJournal& operator=(const DataSetJournal&) = delete;
+};
+
+
+#endif  // DATASETJOURNAL_H_INCLUDED
@@ -0,0 +1,155 @@
+/*
+  ==============================================================================
+
+    FeatureSubset.cpp
+    Created: 20 Oct 2026 12:17:33am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "FeatureSubset.h"
+
+#include <cassert>
+
+//==============================================================================
+template<typename T>
+FeatureSubset<T>::FeatureSubset(const AudioDataSet<T>& dataSetToView, const std::vector<FeatureFramePair>& newFeaturesUsed)
+	: dataSet(dataSetToView),
+	  featuresUsed(newFeaturesUsed)
+{
+	dataRows.set_size(featuresUsed.size());
+
+	for (std::size_t i = 0; i < featuresUsed.size(); ++i)
+	{
+		const auto row = dataSet.getFeatureRowIndex(featuresUsed[i].first, featuresUsed[i].second);
+		assert(row >= 0);
+
+		dataRows[i] = static_cast<arma::uword>(row);
+	}
+
+	readOrder = arma::sort_index(dataRows);
+}
+
+//==============================================================================
+template<typename T>
+FeatureSubset<T>::~FeatureSubset()
+{
+}
+
+//==============================================================================
+template<typename T>
+const AudioDataSet<T>& FeatureSubset<T>::getDataSet() const
+{
+	return dataSet;
+}
+
+//==============================================================================
+template<typename T>
+int FeatureSubset<T>::getNumFeatures() const
+{
+	return static_cast<int>(featuresUsed.size());
+}
+
+//==============================================================================
+template<typename T>
+bool FeatureSubset<T>::usingFeature(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature) const
+{
+	return getFeatureRowIndex(stftFrameNumber, feature) >= 0;
+}
+
+//==============================================================================
+template<typename T>
+int FeatureSubset<T>::getFeatureRowIndex(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature) const
+{
+	for (std::size_t i = 0; i < featuresUsed.size(); ++i)
+	{
+		if (featuresUsed[i].first == stftFrameNumber && featuresUsed[i].second == feature)
+			return static_cast<int>(i);
+	}
+
+	return -1;
+}
+
+//==============================================================================
+template<typename T>
+const std::vector<FeatureFramePair>& FeatureSubset<T>::getFeaturesUsed() const
+{
+	return featuresUsed;
+}
+
+//==============================================================================
+template<typename T>
+FrameRowTable FeatureSubset<T>::getFrameRows() const
+{
+	return AudioDataSet<T>::makeFrameRows(featuresUsed, dataSet.getTotalNumSTFTFrames());
+}
+
+//==============================================================================
+template<typename T>
+const arma::uvec& FeatureSubset<T>::getDataRowIndices() const
+{
+	return dataRows;
+}
+
+//==============================================================================
+template<typename T>
+int FeatureSubset<T>::getNumMFCCsUsed() const
+{
+	auto numMFCCs = 0;
+
+	for (const auto& featureFramePair : featuresUsed)
+	{
+		//Delta MFCCs need their base MFCC computed too
+		auto baseFeature = AudioClassifyOptions::getBaseFeature(featureFramePair.second);
+		auto mfccIndex = static_cast<int>(baseFeature) - static_cast<int>(AudioClassifyOptions::AudioFeature::mfcc_1);
+
+		if (mfccIndex >= numMFCCs)
+			numMFCCs = mfccIndex + 1;
+	}
+
+	return numMFCCs;
+}
+
+//==============================================================================
+template<typename T>
+void FeatureSubset<T>::gather(arma::Mat<T>& output) const
+{
+	const auto& data = dataSet.getData();
+
+	output.set_size(featuresUsed.size(), data.n_cols);
+
+	for (std::size_t j = 0; j < data.n_cols; ++j)
+		gatherInstance(data.colptr(j), output.colptr(j));
+}
+
+//==============================================================================
+template<typename T>
+void FeatureSubset<T>::gather(const arma::uvec& instanceIndices, arma::Mat<T>& output) const
+{
+	const auto& data = dataSet.getData();
+
+	output.set_size(featuresUsed.size(), instanceIndices.n_elem);
+
+	for (std::size_t j = 0; j < instanceIndices.n_elem; ++j)
+	{
+		assert(instanceIndices[j] < data.n_cols);
+		gatherInstance(data.colptr(instanceIndices[j]), output.colptr(j));
+	}
+}
+
+//==============================================================================
+template<typename T>
+void FeatureSubset<T>::gatherInstance(const T* instance, T* output) const
+{
+	//Reading the instance column in ascending order touches each of its cache lines once.
+	for (std::size_t k = 0; k < readOrder.n_elem; ++k)
+	{
+		const auto i = readOrder[k];
+		output[i] = instance[dataRows[i]];
+	}
+}
+
+//==============================================================================
+template class FeatureSubset<float>;
+template class FeatureSubset<double>;
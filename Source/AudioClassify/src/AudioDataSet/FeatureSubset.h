@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    FeatureSubset.h
+    Created: 20 Oct 2026 12:17:33am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef FEATURESUBSET_H_INCLUDED
+#define FEATURESUBSET_H_INCLUDED
+
+#include <vector>
+
+#include "AudioDataSet.h"
+
+/** A view of a subset of the features of an AudioDataSet, e.g. the features with the highest
+ *  variance, without copying its data.
+ *
+ *  The view holds the row index of each selected feature in the data set and reads the data
+ *  set's current data whenever it is gathered, so it stays valid as instances are recorded or
+ *  appended. The data set must outlive the view.
+ *
+ *  Classifiers are trained from gather(), which copies only the selected rows, one instance
+ *  column at a time in ascending row order.
+ */
+template<typename T>
+class FeatureSubset
+{
+public:
+	/** @param newFeaturesUsed the features to view, in the order they are gathered. Each must be
+	 *  used by dataSetToView.
+	 */
+	FeatureSubset(const AudioDataSet<T>& dataSetToView, const std::vector<FeatureFramePair>& newFeaturesUsed);
+	~FeatureSubset();
+
+	const AudioDataSet<T>& getDataSet() const;
+
+	int getNumFeatures() const;
+
+	bool usingFeature(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature) const;
+
+	/** @return the row of the feature in gathered data, or -1 if it is not in the subset. */
+	int getFeatureRowIndex(int stftFrameNumber, AudioClassifyOptions::AudioFeature feature) const;
+
+	const std::vector<FeatureFramePair>& getFeaturesUsed() const;
+
+	/** @see AudioDataSet::getFrameRows(), rows are those of gathered data. */
+	FrameRowTable getFrameRows() const;
+
+	/** @return the row of each feature of the subset in the data set's data. */
+	const arma::uvec& getDataRowIndices() const;
+
+	/** @see AudioDataSet::getNumMFCCsUsed() */
+	int getNumMFCCsUsed() const;
+
+	/** Copies the selected features of every instance into output (getNumFeatures() x instances). */
+	void gather(arma::Mat<T>& output) const;
+
+	/** Copies the selected features of the given instance columns into output, in the order given. */
+	void gather(const arma::uvec& instanceIndices, arma::Mat<T>& output) const;
+
+private:
+	const AudioDataSet<T>& dataSet;
+
+	std::vector<FeatureFramePair> featuresUsed;
+	arma::uvec dataRows;
+
+	//Positions in featuresUsed sorted by their data row, the order each instance is read in.
+	arma::uvec readOrder;
+
+	void gatherInstance(const T* instance, T* output) const;
+};
+
+
+#endif  // FEATURESUBSET_H_INCLUDED
@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    SnippetRecorder.cpp
+    Created: 19 Oct 2026 10:14:52pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "SnippetRecorder.h"
+
+#include <algorithm>
+#include <cassert>
+
+//==============================================================================
+template<typename T>
+SnippetRecorder<T>::SnippetRecorder()
+{
+}
+
+//==============================================================================
+template<typename T>
+SnippetRecorder<T>::~SnippetRecorder()
+{
+}
+
+//==============================================================================
+template<typename T>
+void SnippetRecorder<T>::prepare(int newSnippetLength, int newPreRoll, int maxBufferSize)
+{
+	assert(newSnippetLength >= 0 && newPreRoll >= 0 && newPreRoll <= newSnippetLength);
+
+	snippetLength = newSnippetLength;
+	preRoll = newPreRoll;
+
+	//A window completes within one push of its end, so the history needs one push beyond the window.
+	maxPushSize = static_cast<std::size_t>(std::max(maxBufferSize, 1));
+	historySize = (snippetLength > 0) ? static_cast<std::size_t>(snippetLength) + maxPushSize : 0;
+
+	history.assign(2 * historySize, static_cast<T>(0.0));
+	numSamplesPushed = 0;
+
+	numPending = 0;
+	clearRequested.store(false);
+	numDropped.store(0);
+}
+
+//==============================================================================
+template<typename T>
+void SnippetRecorder<T>::clearCaptures()
+{
+	clearRequested.store(true);
+}
+
+//==============================================================================
+template<typename T>
+void SnippetRecorder<T>::applyClearRequest()
+{
+	if (clearRequested.exchange(false))
+		numPending = 0;
+}
+
+//==============================================================================
+template<typename T>
+void SnippetRecorder<T>::pushBuffer(const T* buffer, int numSamples)
+{
+	applyClearRequest();
+
+	if (historySize == 0)
+		return;
+
+	auto remaining = static_cast<std::size_t>(std::max(numSamples, 0));
+
+	while (remaining > 0)
+	{
+		const auto numToWrite = std::min(remaining, maxPushSize);
+
+		writeHistory(buffer, numToWrite);
+		completeCaptures();
+
+		buffer += numToWrite;
+		remaining -= numToWrite;
+	}
+}
+
+//==============================================================================
+template<typename T>
+void SnippetRecorder<T>::writeHistory(const T* samples, std::size_t numSamples)
+{
+	auto position = static_cast<std::size_t>(numSamplesPushed % static_cast<std::int64_t>(historySize));
+
+	for (std::size_t i = 0; i < numSamples; ++i)
+	{
+		history[position] = samples[i];
+		history[position + historySize] = samples[i];
+
+		if (++position == historySize)
+			position = 0;
+	}
+
+	numSamplesPushed += static_cast<std::int64_t>(numSamples);
+}
+
+//==============================================================================
+template<typename T>
+std::int64_t SnippetRecorder<T>::getNumSamplesPushed() const
+{
+	return numSamplesPushed;
+}
+
+//==============================================================================
+template<typename T>
+bool SnippetRecorder<T>::capture(std::int64_t onsetSample, AudioDataSet<T>& dataSet, int column)
+{
+	applyClearRequest();
+
+	if (historySize == 0 || dataSet.getSnippetLength() != snippetLength || dataSet.getSnippetPreRoll() != preRoll)
+		return false;
+
+	if (numPending == maxPendingCaptures)
+	{
+		++numDropped;
+		return false;
+	}
+
+	pendingCaptures[numPending++] = { onsetSample - preRoll, &dataSet, column };
+
+	//The window may already be complete if it ends with the instance.
+	completeCaptures();
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+void SnippetRecorder<T>::completeCaptures()
+{
+	const auto size = static_cast<std::int64_t>(historySize);
+	auto i = 0;
+
+	while (i < numPending)
+	{
+		const auto& pending = pendingCaptures[i];
+
+		if (pending.startSample + snippetLength > numSamplesPushed)
+		{
+			++i;
+			continue;
+		}
+
+		if (numSamplesPushed - pending.startSample <= size)
+		{
+			//Samples before the first push read as the zeros the history starts with.
+			const auto position = ((pending.startSample % size) + size) % size;
+			pending.dataSet->setSnippet(pending.column, history.data() + position);
+		}
+		else
+		{
+			++numDropped;
+		}
+
+		pendingCaptures[i] = pendingCaptures[--numPending];
+	}
+}
+
+//==============================================================================
+template<typename T>
+int SnippetRecorder<T>::getSnippetLength() const
+{
+	return snippetLength;
+}
+
+//==============================================================================
+template<typename T>
+int SnippetRecorder<T>::getPreRoll() const
+{
+	return preRoll;
+}
+
+//==============================================================================
+template<typename T>
+int SnippetRecorder<T>::getNumDropped() const
+{
+	return numDropped.load();
+}
+
+//==============================================================================
+template class SnippetRecorder<float>;
+template class SnippetRecorder<double>;
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    SnippetRecorder.h
+    Created: 19 Oct 2026 10:14:52pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef SNIPPETRECORDER_H_INCLUDED
+#define SNIPPETRECORDER_H_INCLUDED
+
+#include <vector>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "AudioDataSet.h"
+
+/** Keeps a history of the input audio so the raw audio window around each recorded onset can be
+ *  stored with its instance (see AudioDataSet::setSnippet()).
+ *
+ *  The history is a preallocated ring written twice, once at each half, so any window it holds
+ *  is contiguous. A capture is queued when an instance is stored and copied into the data set
+ *  once the end of its window has been pushed, so the window may run past the instance's own
+ *  buffers.
+ *
+ *  pushBuffer() and capture() do not allocate or lock and are called from the audio thread.
+ *  prepare() reallocates the history, so it is only called while they can't run, i.e. on
+ *  construction and from prepareToPlay.
+ */
+template<typename T>
+class SnippetRecorder
+{
+public:
+	SnippetRecorder();
+	~SnippetRecorder();
+
+	/** Allocates the history and clears any queued captures.
+	 * Note: This method allocates. Do not call whilst pushBuffer() or capture() may run.
+	 * @param newSnippetLength the number of samples in each window, 0 to record nothing.
+	 * @param newPreRoll the number of samples in each window before the onset buffer.
+	 * @param maxBufferSize the largest buffer expected in pushBuffer(). Larger buffers are pushed in parts.
+	 */
+	void prepare(int newSnippetLength, int newPreRoll, int maxBufferSize);
+
+	/** Drops any queued captures, e.g. before the data sets they point into are replaced. Can be
+	 *  called from any thread. The captures are dropped by the audio thread before it next pushes a
+	 *  buffer or queues a capture, so none completes after this returns.
+	 */
+	void clearCaptures();
+
+	void pushBuffer(const T* buffer, int numSamples);
+
+	/** @return the total number of samples pushed, i.e. the position of the next sample pushed. */
+	std::int64_t getNumSamplesPushed() const;
+
+	/** Queues the window starting getPreRoll() samples before onsetSample to be copied into
+	 *  instance column of dataSet once it has been pushed.
+	 * @return false if the data set has a different snippet layout or too many captures are queued.
+	 */
+	bool capture(std::int64_t onsetSample, AudioDataSet<T>& dataSet, int column);
+
+	int getSnippetLength() const;
+	int getPreRoll() const;
+
+	/** @return the number of captures lost because the queue was full or the window had left the history. */
+	int getNumDropped() const;
+
+	static const int maxPendingCaptures = 16;
+
+private:
+	struct PendingCapture
+	{
+		std::int64_t startSample;
+		AudioDataSet<T>* dataSet;
+		int column;
+	};
+
+	int snippetLength = 0;
+	int preRoll = 0;
+
+	//history holds historySize samples twice over.
+	std::vector<T> history;
+	std::size_t historySize = 0;
+	std::size_t maxPushSize = 0;
+	std::int64_t numSamplesPushed = 0;
+
+	//Only touched by the audio thread once prepared. clearCaptures() requests the clear through clearRequested.
+	std::array<PendingCapture, maxPendingCaptures> pendingCaptures;
+	int numPending = 0;
+	std::atomic_bool clearRequested { false };
+
+	std::atomic_int numDropped { 0 };
+
+	void applyClearRequest();
+	void writeHistory(const T* samples, std::size_t numSamples);
+	void completeCaptures();
+};
+
+
+#endif  // SNIPPETRECORDER_H_INCLUDED
@@ -0,0 +1,301 @@
+/*
+  ==============================================================================
+
+    CrossValidator.cpp
+    Created: 20 Oct 2026 12:58:10am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "CrossValidator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <random>
+
+#include "../PreProcessing/FeatureScaler.h"
+#include "../NaiveBayes/NaiveBayes.h"
+#include "../NearestNeighbour/NearestNeighbour.h"
+
+//==============================================================================
+template<typename T>
+CrossValidator<T>::CrossValidator(int initNumFolds, bool initStratified, unsigned int initSeed)
+	: numFolds(std::max(initNumFolds, 2)),
+	  stratified(initStratified),
+	  seed(initSeed)
+{
+}
+
+//==============================================================================
+template<typename T>
+CrossValidator<T>::~CrossValidator()
+{
+}
+
+//==============================================================================
+template<typename T>
+void CrossValidator<T>::setNumFolds(int newNumFolds)
+{
+	numFolds = std::max(newNumFolds, 2);
+}
+
+//==============================================================================
+template<typename T>
+int CrossValidator<T>::getNumFolds() const
+{
+	return numFolds;
+}
+
+//==============================================================================
+template<typename T>
+void CrossValidator<T>::setStratified(bool newStratified)
+{
+	stratified = newStratified;
+}
+
+//==============================================================================
+template<typename T>
+bool CrossValidator<T>::isStratified() const
+{
+	return stratified;
+}
+
+//==============================================================================
+template<typename T>
+void CrossValidator<T>::setSeed(unsigned int newSeed)
+{
+	seed = newSeed;
+}
+
+//==============================================================================
+template<typename T>
+void CrossValidator<T>::makeFolds(const arma::Row<int>& labels, int numClasses)
+{
+	const auto numInstances = static_cast<std::size_t>(labels.n_elem);
+
+	foldTrainingIndices.clear();
+	foldTestIndices.clear();
+
+	if (numInstances < 2)
+		return;
+
+	const auto foldsToMake = std::min(static_cast<std::size_t>(numFolds), numInstances);
+
+	std::mt19937 randomEngine(seed);
+	std::vector<std::size_t> instanceFolds(numInstances);
+
+	//Deal shuffled instances round robin. Stratified deals each class in turn, carrying on from
+	//the fold the previous class finished on so the fold sizes stay within one of each other.
+	std::vector<std::vector<std::size_t>> groups(stratified ? static_cast<std::size_t>(numClasses) : 1);
+
+	for (std::size_t j = 0; j < numInstances; ++j)
+	{
+		assert(labels[j] >= 0 && labels[j] < numClasses);
+		groups[stratified ? static_cast<std::size_t>(labels[j]) : 0].push_back(j);
+	}
+
+	std::size_t nextFold = 0;
+
+	for (auto& group : groups)
+	{
+		std::shuffle(group.begin(), group.end(), randomEngine);
+
+		for (auto instance : group)
+		{
+			instanceFolds[instance] = nextFold;
+			nextFold = (nextFold + 1) % foldsToMake;
+		}
+	}
+
+	std::vector<std::size_t> foldSizes(foldsToMake, 0);
+
+	for (auto fold : instanceFolds)
+		++foldSizes[fold];
+
+	for (std::size_t fold = 0; fold < foldsToMake; ++fold)
+	{
+		arma::uvec trainingIndices(numInstances - foldSizes[fold]);
+		arma::uvec testIndices(foldSizes[fold]);
+
+		std::size_t numTraining = 0;
+		std::size_t numTest = 0;
+
+		for (std::size_t j = 0; j < numInstances; ++j)
+		{
+			if (instanceFolds[j] == fold)
+				testIndices[numTest++] = j;
+			else
+				trainingIndices[numTraining++] = j;
+		}
+
+		foldTrainingIndices.push_back(trainingIndices);
+		foldTestIndices.push_back(testIndices);
+	}
+}
+
+//==============================================================================
+template<typename T>
+int CrossValidator<T>::getNumFoldsMade() const
+{
+	return static_cast<int>(foldTestIndices.size());
+}
+
+//==============================================================================
+template<typename T>
+const arma::uvec& CrossValidator<T>::getFoldTrainingIndices(int fold) const
+{
+	assert(fold >= 0 && fold < getNumFoldsMade());
+	return foldTrainingIndices[fold];
+}
+
+//==============================================================================
+template<typename T>
+const arma::uvec& CrossValidator<T>::getFoldTestIndices(int fold) const
+{
+	assert(fold >= 0 && fold < getNumFoldsMade());
+	return foldTestIndices[fold];
+}
+
+//==============================================================================
+template<typename T>
+std::vector<CrossValidationResult> CrossValidator<T>::evaluate(const arma::Mat<T>& data, const arma::Row<int>& labels, int numClasses,
+															   const std::vector<ClassifierConfiguration>& configurations, ThreadPool& pool)
+{
+	assert(data.n_cols == labels.n_elem);
+
+	makeFolds(labels, numClasses);
+
+	const auto numConfigurations = configurations.size();
+	const auto foldsMade = static_cast<std::size_t>(getNumFoldsMade());
+
+	//Every task writes the predictions of its own fold's instances only.
+	std::vector<arma::Row<int>> predictedLabels(numConfigurations);
+
+	for (auto& predicted : predictedLabels)
+	{
+		predicted.set_size(labels.n_elem);
+		predicted.fill(-1);
+	}
+
+	pool.parallelFor(numConfigurations * foldsMade, [&](std::size_t begin, std::size_t end)
+	{
+		for (auto task = begin; task < end; ++task)
+		{
+			const auto configuration = task / foldsMade;
+			const auto fold = static_cast<int>(task % foldsMade);
+
+			const auto& trainingIndices = getFoldTrainingIndices(fold);
+			const auto& testIndices = getFoldTestIndices(fold);
+
+			arma::Mat<T> trainingData = data.cols(trainingIndices);
+			const arma::Row<int> trainingLabels = labels.cols(trainingIndices);
+			arma::Mat<T> testData = data.cols(testIndices);
+
+			arma::Row<int> foldPredictions;
+			trainAndClassify(trainingData, trainingLabels, testData, numClasses, configurations[configuration], foldPredictions);
+
+			for (std::size_t j = 0; j < testIndices.n_elem; ++j)
+				predictedLabels[configuration][testIndices[j]] = foldPredictions[j];
+		}
+	});
+
+	std::vector<CrossValidationResult> results(numConfigurations);
+
+	for (std::size_t c = 0; c < numConfigurations; ++c)
+	{
+		results[c].configuration = configurations[c];
+		summarise(labels, predictedLabels[c], numClasses, results[c]);
+	}
+
+	return results;
+}
+
+//==============================================================================
+template<typename T>
+void CrossValidator<T>::trainAndClassify(arma::Mat<T>& trainingData, const arma::Row<int>& trainingLabels, arma::Mat<T>& testData,
+										 int numClasses, const ClassifierConfiguration& configuration, arma::Row<int>& predictedLabels)
+{
+	//Fitted on the training folds only, as train() fits it on the training set only.
+	FeatureScaler<T> scaler;
+	scaler.fit(trainingData, configuration.scalerType);
+	scaler.apply(trainingData);
+	scaler.apply(testData);
+
+	const auto numFeatures = static_cast<unsigned int>(trainingData.n_rows);
+
+	switch (configuration.classifierType)
+	{
+		case AudioClassifyOptions::ClassifierType::nearestNeighbour:
+		{
+			NearestNeighbour<T> knn(numFeatures, numClasses, trainingData.n_cols / numClasses);
+			knn.setNumNeighbours(configuration.numNeighbours);
+			knn.setPrototypeBudget(configuration.prototypeBudget);
+			knn.train(trainingData, trainingLabels);
+			knn.classify(testData, predictedLabels);
+			break;
+		}
+		case AudioClassifyOptions::ClassifierType::naiveBayes:
+		{
+			NaiveBayes<T> nbc(numClasses, numFeatures);
+			nbc.Train(trainingData, trainingLabels);
+			nbc.Classify(testData, predictedLabels);
+			break;
+		}
+		default:
+			predictedLabels.set_size(testData.n_cols);
+			predictedLabels.fill(-1);
+			break;
+	}
+}
+
+//==============================================================================
+template<typename T>
+void CrossValidator<T>::summarise(const arma::Row<int>& labels, const arma::Row<int>& predictedLabels, int numClasses,
+								  CrossValidationResult& result) const
+{
+	const auto foldsMade = getNumFoldsMade();
+
+	result.foldAccuracies.assign(foldsMade, 0.0f);
+	result.confusionMatrix.zeros(numClasses, numClasses);
+
+	for (auto fold = 0; fold < foldsMade; ++fold)
+	{
+		const auto& testIndices = foldTestIndices[fold];
+		std::size_t numCorrect = 0;
+
+		for (std::size_t k = 0; k < testIndices.n_elem; ++k)
+		{
+			const auto actual = labels[testIndices[k]];
+			const auto predicted = predictedLabels[testIndices[k]];
+
+			if (actual == predicted)
+				++numCorrect;
+
+			if (predicted >= 0 && predicted < numClasses)
+				++result.confusionMatrix(actual, predicted);
+		}
+
+		result.foldAccuracies[fold] = static_cast<float>(numCorrect) / static_cast<float>(testIndices.n_elem) * 100.0f;
+	}
+
+	auto mean = 0.0;
+
+	for (auto accuracy : result.foldAccuracies)
+		mean += accuracy;
+
+	mean = (foldsMade > 0) ? mean / foldsMade : 0.0;
+
+	auto squaredDiffSum = 0.0;
+
+	for (auto accuracy : result.foldAccuracies)
+		squaredDiffSum += (accuracy - mean) * (accuracy - mean);
+
+	result.meanAccuracy = static_cast<float>(mean);
+	result.accuracyStandardDeviation = (foldsMade > 1) ? static_cast<float>(std::sqrt(squaredDiffSum / (foldsMade - 1))) : 0.0f;
+}
+
+//==============================================================================
+template class CrossValidator<float>;
+template class CrossValidator<double>;
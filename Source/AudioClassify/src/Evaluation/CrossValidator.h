@@ -0,0 +1,131 @@
+/*
+  ==============================================================================
+
+    CrossValidator.h
+    Created: 20 Oct 2026 12:58:10am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef CROSSVALIDATOR_H_INCLUDED
+#define CROSSVALIDATOR_H_INCLUDED
+
+#ifdef _WIN64
+#define ARMA_64BIT_WORD
+#endif
+
+#include <armadillo.h>
+
+#include <vector>
+
+#include "../AudioClassifyOptions/AudioClassifyOptions.h"
+#include "../Threading/ThreadPool.h"
+
+//==============================================================================
+/** One classifier and the settings it is trained with, as evaluated by CrossValidator. */
+struct ClassifierConfiguration
+{
+	AudioClassifyOptions::ClassifierType classifierType = AudioClassifyOptions::ClassifierType::naiveBayes;
+	AudioClassifyOptions::ScalerType scalerType = AudioClassifyOptions::ScalerType::minMax;
+
+	//Nearest neighbour only, see NearestNeighbour::setNumNeighbours() / setPrototypeBudget().
+	int numNeighbours = 5;
+	std::size_t prototypeBudget = 0;
+};
+
+/** Cross validated accuracy of one ClassifierConfiguration. Accuracies are percentages. */
+struct CrossValidationResult
+{
+	ClassifierConfiguration configuration;
+
+	std::vector<float> foldAccuracies;
+	float meanAccuracy;
+	float accuracyStandardDeviation;
+
+	//numClasses x numClasses counts of actual (row) against predicted (column) labels over every fold.
+	arma::umat confusionMatrix;
+};
+
+//==============================================================================
+/** Estimates classifier accuracy from a single labelled data set by k-fold cross validation.
+ *
+ *  The instances are shuffled and dealt into numFolds folds, optionally stratified so every fold
+ *  holds the same proportion of each class. Each fold is classified by a model trained on the
+ *  other folds, with the feature scaling fitted on those folds only, so every instance is tested
+ *  exactly once by a model that never saw it.
+ *
+ *  Every (configuration, fold) pair is trained and scored as a separate task on a ThreadPool.
+ *
+ *  Note: Allocates and blocks. Do not call from the audio thread.
+ */
+template<typename T>
+class CrossValidator
+{
+public:
+	/** @param initNumFolds the number of folds, at least 2. Clamped to the number of instances when
+	 *  the folds are made, so a large value gives leave one out cross validation.
+	 * @param initStratified true to keep the class proportions of every fold the same.
+	 * @param initSeed seed of the shuffle, so the same folds are made for the same labels.
+	 */
+	CrossValidator(int initNumFolds = 5, bool initStratified = true, unsigned int initSeed = 1234);
+	~CrossValidator();
+
+	void setNumFolds(int newNumFolds);
+	int getNumFolds() const;
+
+	void setStratified(bool newStratified);
+	bool isStratified() const;
+
+	void setSeed(unsigned int newSeed);
+
+	/** Deals the instances with the given labels into folds, see getFoldTrainingIndices() / getFoldTestIndices().
+	 *  Called by evaluate(), call directly to reuse the folds for other per fold work.
+	 * @param labels the class of each instance, in [0, numClasses).
+	 */
+	void makeFolds(const arma::Row<int>& labels, int numClasses);
+
+	/** @return the number of folds made by the last makeFolds() call. */
+	int getNumFoldsMade() const;
+
+	/** @return the instances the model of a fold is trained on, in ascending order. */
+	const arma::uvec& getFoldTrainingIndices(int fold) const;
+
+	/** @return the instances a fold tests, in ascending order. */
+	const arma::uvec& getFoldTestIndices(int fold) const;
+
+	/** Cross validates each configuration on the same folds.
+	 * @param data the unscaled instances, one per column.
+	 * @param labels the class of each column of data, in [0, numClasses).
+	 * @return a result per configuration, in the order given.
+	 */
+	std::vector<CrossValidationResult> evaluate(const arma::Mat<T>& data, const arma::Row<int>& labels, int numClasses,
+												const std::vector<ClassifierConfiguration>& configurations,
+												ThreadPool& pool = ThreadPool::getShared());
+
+	/** Fits the configuration's scaling to trainingData, trains its classifier on the scaled data and
+	 *  classifies testData with it.
+	 * @param trainingData the unscaled training instances. Scaled in place.
+	 * @param testData the unscaled instances to classify. Scaled in place.
+	 * @param predictedLabels receives the label predicted for each column of testData.
+	 */
+	static void trainAndClassify(arma::Mat<T>& trainingData, const arma::Row<int>& trainingLabels, arma::Mat<T>& testData,
+								 int numClasses, const ClassifierConfiguration& configuration, arma::Row<int>& predictedLabels);
+
+	/** Fills in the fold accuracies, their mean and sample standard deviation and the confusion
+	 *  matrix of result from the label predicted for every instance by the folds made last.
+	 */
+	void summarise(const arma::Row<int>& labels, const arma::Row<int>& predictedLabels, int numClasses,
+				   CrossValidationResult& result) const;
+
+private:
+	int numFolds;
+	bool stratified;
+	unsigned int seed;
+
+	std::vector<arma::uvec> foldTrainingIndices;
+	std::vector<arma::uvec> foldTestIndices;
+};
+
+
+#endif  // CROSSVALIDATOR_H_INCLUDED
@@ -0,0 +1,317 @@
+/*
+  ==============================================================================
+
+    FeatureSelector.cpp
+    Created: 20 Oct 2026 1:36:52am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "FeatureSelector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "../PreProcessing/FeatureScaler.h"
+
+//==============================================================================
+template<typename T>
+const double FeatureSelector<T>::minCostDifference = 1.0e-3;
+
+//==============================================================================
+template<typename T>
+FeatureSelector<T>::FeatureSelector(const ClassifierConfiguration& initConfiguration, int numFolds, bool stratified, unsigned int seed)
+	: configuration(initConfiguration),
+	  crossValidator(numFolds, stratified, seed)
+{
+}
+
+//==============================================================================
+template<typename T>
+FeatureSelector<T>::~FeatureSelector()
+{
+}
+
+//==============================================================================
+template<typename T>
+void FeatureSelector<T>::setCostModel(SubsetCostFunction newSubsetCost, double newCostBudget)
+{
+	subsetCost = newSubsetCost;
+	costBudget = newCostBudget;
+}
+
+//==============================================================================
+template<typename T>
+double FeatureSelector<T>::getCost(const std::vector<std::size_t>& features) const
+{
+	return (subsetCost != nullptr && !features.empty()) ? subsetCost(features) : 0.0;
+}
+
+//==============================================================================
+template<typename T>
+void FeatureSelector<T>::prepare(const arma::Mat<T>& data, const arma::Row<int>& labels, int newNumClasses)
+{
+	assert(data.n_cols == labels.n_elem);
+
+	numClasses = newNumClasses;
+	numFeatures = data.n_rows;
+	accuracyCache.clear();
+
+	crossValidator.makeFolds(labels, numClasses);
+
+	folds.clear();
+	folds.resize(crossValidator.getNumFoldsMade());
+
+	for (std::size_t f = 0; f < folds.size(); ++f)
+	{
+		const auto& trainingIndices = crossValidator.getFoldTrainingIndices(static_cast<int>(f));
+		const auto& testIndices = crossValidator.getFoldTestIndices(static_cast<int>(f));
+
+		auto& fold = folds[f];
+
+		fold.trainingData = data.cols(trainingIndices);
+		fold.trainingLabels = labels.cols(trainingIndices);
+		fold.testData = data.cols(testIndices);
+		fold.testLabels = labels.cols(testIndices);
+
+		//Fitted on the training folds only, see CrossValidator::trainAndClassify().
+		FeatureScaler<T> scaler;
+		scaler.fit(fold.trainingData, configuration.scalerType);
+		scaler.apply(fold.trainingData);
+		scaler.apply(fold.testData);
+	}
+}
+
+//==============================================================================
+template<typename T>
+std::size_t FeatureSelector<T>::getNumFeatures() const
+{
+	return numFeatures;
+}
+
+//==============================================================================
+template<typename T>
+std::vector<float> FeatureSelector<T>::evaluate(const std::vector<std::vector<std::size_t>>& subsets, ThreadPool& pool)
+{
+	std::vector<float> accuracies(subsets.size(), -1.0f);
+
+	if (folds.empty())
+		return accuracies;
+
+	std::vector<std::vector<std::size_t>> keys(subsets.size());
+	std::vector<std::size_t> uncached;
+
+	for (std::size_t s = 0; s < subsets.size(); ++s)
+	{
+		assert(!subsets[s].empty());
+
+		keys[s] = subsets[s];
+		std::sort(keys[s].begin(), keys[s].end());
+
+		const auto cached = accuracyCache.find(keys[s]);
+
+		if (cached != accuracyCache.end())
+			accuracies[s] = cached->second;
+		else
+			uncached.push_back(s);
+	}
+
+	//The data is already scaled, so the classifiers are trained on it as is.
+	auto scaledConfiguration = configuration;
+	scaledConfiguration.scalerType = AudioClassifyOptions::ScalerType::none;
+
+	const auto numFolds = folds.size();
+	std::vector<float> foldAccuracies(uncached.size() * numFolds, 0.0f);
+
+	pool.parallelFor(foldAccuracies.size(), [&](std::size_t begin, std::size_t end)
+	{
+		arma::Mat<T> trainingData;
+		arma::Mat<T> testData;
+		arma::Row<int> predictedLabels;
+
+		for (auto task = begin; task < end; ++task)
+		{
+			const auto& subset = keys[uncached[task / numFolds]];
+			const auto& fold = folds[task % numFolds];
+
+			gatherRows(fold.trainingData, subset, trainingData);
+			gatherRows(fold.testData, subset, testData);
+
+			CrossValidator<T>::trainAndClassify(trainingData, fold.trainingLabels, testData, numClasses, scaledConfiguration, predictedLabels);
+
+			std::size_t numCorrect = 0;
+
+			for (std::size_t j = 0; j < fold.testLabels.n_elem; ++j)
+			{
+				if (predictedLabels[j] == fold.testLabels[j])
+					++numCorrect;
+			}
+
+			foldAccuracies[task] = static_cast<float>(numCorrect) / static_cast<float>(fold.testLabels.n_elem) * 100.0f;
+		}
+	});
+
+	//Mean of the fold accuracies, as CrossValidationResult::meanAccuracy.
+	for (std::size_t u = 0; u < uncached.size(); ++u)
+	{
+		auto sum = 0.0;
+
+		for (std::size_t f = 0; f < numFolds; ++f)
+			sum += foldAccuracies[(u * numFolds) + f];
+
+		const auto s = uncached[u];
+
+		accuracies[s] = static_cast<float>(sum / numFolds);
+		accuracyCache[keys[s]] = accuracies[s];
+	}
+
+	return accuracies;
+}
+
+//==============================================================================
+template<typename T>
+FeatureSelectionResult FeatureSelector<T>::select(AudioClassifyOptions::FeatureSelectionDirection direction, float accuracyTolerance,
+												  std::size_t maxFeatures, ThreadPool& pool)
+{
+	FeatureSelectionResult result;
+
+	if (folds.empty() || numFeatures == 0)
+		return result;
+
+	const auto costAware = (subsetCost != nullptr);
+
+	std::vector<std::size_t> current;
+	auto currentAccuracy = 0.0f;
+	auto currentCost = 0.0;
+
+	if (direction == AudioClassifyOptions::FeatureSelectionDirection::backward)
+	{
+		for (std::size_t i = 0; i < numFeatures; ++i)
+			current.push_back(i);
+
+		currentAccuracy = evaluate({ current }, pool)[0];
+		currentCost = getCost(current);
+
+		result.steps.push_back({ current, currentAccuracy, currentCost });
+	}
+
+	const auto forward = (direction == AudioClassifyOptions::FeatureSelectionDirection::forward);
+	const auto forwardLimit = (maxFeatures > 0) ? std::min(maxFeatures, numFeatures) : numFeatures;
+
+	while (forward ? (current.size() < forwardLimit) : (current.size() > 1))
+	{
+		std::vector<std::vector<std::size_t>> candidates;
+		std::vector<double> candidateCosts;
+
+		if (forward)
+		{
+			for (std::size_t i = 0; i < numFeatures; ++i)
+			{
+				if (std::find(current.begin(), current.end(), i) != current.end())
+					continue;
+
+				auto candidate = current;
+				candidate.insert(std::upper_bound(candidate.begin(), candidate.end(), i), i);
+
+				const auto cost = getCost(candidate);
+
+				//A forward search never gets cheaper, so over budget candidates are not worth evaluating.
+				if (costAware && cost > costBudget)
+					continue;
+
+				candidates.push_back(candidate);
+				candidateCosts.push_back(cost);
+			}
+		}
+		else
+		{
+			for (std::size_t k = 0; k < current.size(); ++k)
+			{
+				auto candidate = current;
+				candidate.erase(candidate.begin() + k);
+
+				candidateCosts.push_back(getCost(candidate));
+				candidates.push_back(candidate);
+			}
+		}
+
+		if (candidates.empty())
+			break;
+
+		const auto accuracies = evaluate(candidates, pool);
+
+		std::size_t best = 0;
+		auto bestScore = 0.0;
+
+		for (std::size_t c = 0; c < candidates.size(); ++c)
+		{
+			auto score = static_cast<double>(accuracies[c]);
+
+			//Accuracy gained per unit of cost added forwards, or minus the accuracy lost per unit of cost saved backwards.
+			if (costAware)
+			{
+				const auto costDifference = std::max(std::abs(candidateCosts[c] - currentCost), minCostDifference);
+				score = (accuracies[c] - currentAccuracy) / costDifference;
+			}
+
+			if (c == 0 || score > bestScore)
+			{
+				best = c;
+				bestScore = score;
+			}
+		}
+
+		current = candidates[best];
+		currentAccuracy = accuracies[best];
+		currentCost = candidateCosts[best];
+
+		result.steps.push_back({ current, currentAccuracy, currentCost });
+	}
+
+	for (const auto& step : result.steps)
+	{
+		if (!costAware || step.cost <= costBudget)
+			result.bestAccuracy = std::max(result.bestAccuracy, step.meanAccuracy);
+	}
+
+	for (const auto& step : result.steps)
+	{
+		if ((costAware && step.cost > costBudget) || step.meanAccuracy < result.bestAccuracy - accuracyTolerance)
+			continue;
+
+		const auto smaller = step.features.size() < result.selectedFeatures.size();
+		const auto better = costAware ? (step.cost < result.selectedCost || (step.cost == result.selectedCost && smaller)) : smaller;
+
+		if (result.selectedFeatures.empty() || better)
+		{
+			result.selectedFeatures = step.features;
+			result.selectedAccuracy = step.meanAccuracy;
+			result.selectedCost = step.cost;
+		}
+	}
+
+	return result;
+}
+
+//==============================================================================
+template<typename T>
+void FeatureSelector<T>::gatherRows(const arma::Mat<T>& input, const std::vector<std::size_t>& rows, arma::Mat<T>& output)
+{
+	output.set_size(rows.size(), input.n_cols);
+
+	//Rows are ascending, so each column of the input is read in memory order.
+	for (std::size_t j = 0; j < input.n_cols; ++j)
+	{
+		const auto* in = input.colptr(j);
+		auto* out = output.colptr(j);
+
+		for (std::size_t k = 0; k < rows.size(); ++k)
+			out[k] = in[rows[k]];
+	}
+}
+
+//==============================================================================
+template class FeatureSelector<float>;
+template class FeatureSelector<double>;
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    FeatureSelector.h
+    Created: 20 Oct 2026 1:36:52am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef FEATURESELECTOR_H_INCLUDED
+#define FEATURESELECTOR_H_INCLUDED
+
+#ifdef _WIN64
+#define ARMA_64BIT_WORD
+#endif
+
+#include <armadillo.h>
+
+#include <functional>
+#include <map>
+#include <vector>
+
+#include "../AudioClassifyOptions/AudioClassifyOptions.h"
+#include "../Threading/ThreadPool.h"
+#include "CrossValidator.h"
+
+//==============================================================================
+/** A feature subset visited by FeatureSelector, its cross validated accuracy (percentage) and its
+ *  cost if the selector has a cost model.
+ */
+struct FeatureSelectionStep
+{
+	std::vector<std::size_t> features;
+	float meanAccuracy;
+	double cost;
+};
+
+/** Result of FeatureSelector::select(). Features are row indices of the data the selector was prepared with. */
+struct FeatureSelectionResult
+{
+	//The subset after every step of the search, in search order.
+	std::vector<FeatureSelectionStep> steps;
+
+	float bestAccuracy = -1.0f;
+
+	//The smallest (or cheapest, with a cost model) subset of steps within the accuracy tolerance of bestAccuracy, in ascending order.
+	std::vector<std::size_t> selectedFeatures;
+	float selectedAccuracy = -1.0f;
+	double selectedCost = 0.0;
+};
+
+//==============================================================================
+/** Sequential forward / backward wrapper feature selection. Every candidate subset is scored by the
+ *  cross validated accuracy of the classifier configuration actually used, so features are chosen
+ *  for how well they separate the sounds rather than for their variance.
+ *
+ *  prepare() makes the folds once and caches each fold's scaled training and test data over every
+ *  feature. Scaling is per feature, so a candidate subset only gathers its rows from the cache and
+ *  never refits the scaling. The accuracy of each subset evaluated is cached too.
+ *
+ *  Each step of the search trains and scores every (candidate subset, fold) pair as a separate task
+ *  on a ThreadPool using the batch classifiers.
+ *
+ *  Note: Allocates and blocks. The cache holds numFolds scaled copies of the data. Do not call from
+ *  the audio thread.
+ */
+template<typename T>
+class FeatureSelector
+{
+public:
+	FeatureSelector(const ClassifierConfiguration& initConfiguration, int numFolds = 5, bool stratified = true, unsigned int seed = 1234);
+	~FeatureSelector();
+
+	/** Returns the cost of a subset of feature rows, e.g. the microseconds taken to extract it. */
+	using SubsetCostFunction = std::function<double(const std::vector<std::size_t>&)>;
+
+	/** Makes select() optimise accuracy per unit of cost within a budget. Each forward step adds the
+	 *  feature with the highest accuracy gain per unit of cost added that keeps the subset within
+	 *  costBudget, each backward step removes the feature losing least accuracy per unit of cost saved.
+	 *  Only subsets within the budget can be selected, the cheapest within the accuracy tolerance is.
+	 * @param newSubsetCost the cost model, or nullptr to optimise accuracy alone (the default).
+	 */
+	void setCostModel(SubsetCostFunction newSubsetCost, double newCostBudget);
+
+	/** Makes the folds of data and caches their scaled data.
+	 * @param data the unscaled instances, one per column and one feature per row.
+	 * @param labels the class of each column of data, in [0, numClasses).
+	 */
+	void prepare(const arma::Mat<T>& data, const arma::Row<int>& labels, int numClasses);
+
+	/** @return the number of features (rows) of the prepared data. */
+	std::size_t getNumFeatures() const;
+
+	/** @return the mean cross validated accuracy of each subset of feature rows, or -1 if nothing
+	 *  is prepared. Subsets already evaluated are not evaluated again.
+	 */
+	std::vector<float> evaluate(const std::vector<std::vector<std::size_t>>& subsets, ThreadPool& pool = ThreadPool::getShared());
+
+	/** Runs a sequential search from no features (forward) or every feature (backward), each step
+	 *  adding / removing the single feature that gives the highest accuracy (or accuracy per unit of
+	 *  cost, see setCostModel()), ties going to the lowest row.
+	 * @param accuracyTolerance how many percentage points below the best accuracy found the
+	 *  selected subset may score.
+	 * @param maxFeatures forward only, stops the search at this many features. 0 searches to every feature.
+	 */
+	FeatureSelectionResult select(AudioClassifyOptions::FeatureSelectionDirection direction, float accuracyTolerance,
+								  std::size_t maxFeatures = 0, ThreadPool& pool = ThreadPool::getShared());
+
+private:
+	struct Fold
+	{
+		arma::Mat<T> trainingData;
+		arma::Row<int> trainingLabels;
+		arma::Mat<T> testData;
+		arma::Row<int> testLabels;
+	};
+
+	ClassifierConfiguration configuration;
+	CrossValidator<T> crossValidator;
+
+	int numClasses = 0;
+	std::size_t numFeatures = 0;
+	std::vector<Fold> folds;
+
+	//Keyed by the subset in ascending order.
+	std::map<std::vector<std::size_t>, float> accuracyCache;
+
+	SubsetCostFunction subsetCost;
+	double costBudget = 0.0;
+
+	//Floor on the cost difference between subsets, so features sharing a stage already paid for stay finite to score.
+	static const double minCostDifference;
+
+	double getCost(const std::vector<std::size_t>& features) const;
+
+	static void gatherRows(const arma::Mat<T>& input, const std::vector<std::size_t>& rows, arma::Mat<T>& output);
+};
+
+
+#endif  // FEATURESELECTOR_H_INCLUDED
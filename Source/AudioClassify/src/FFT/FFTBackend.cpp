@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    FFTBackend.cpp
+    Created: 19 Oct 2026 9:40:12am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "FFTBackend.h"
+#include "KissFFTBackend.h"
+#include "SplitRadixFFTBackend.h"
+
+//==============================================================================
+template<typename T>
+std::unique_ptr<FFTBackend<T>> FFTBackend<T>::create(AudioClassifyOptions::FFTBackendType backendType, std::size_t frameSize)
+{
+	switch (backendType)
+	{
+		case AudioClassifyOptions::FFTBackendType::splitRadix:
+			if (SplitRadixFFTBackend<T>::supportsFrameSize(frameSize))
+				return std::unique_ptr<FFTBackend<T>>(new SplitRadixFFTBackend<T>(frameSize));
+			break;
+		case AudioClassifyOptions::FFTBackendType::kissFFT:
+		default: break;
+	}
+
+	//KissFFT supports all frame sizes so is used as the fallback.
+	return std::unique_ptr<FFTBackend<T>>(new KissFFTBackend<T>(frameSize));
+}
+
+//==============================================================================
+template<typename T>
+bool FFTBackend<T>::supportsFrameSize(AudioClassifyOptions::FFTBackendType backendType, std::size_t frameSize)
+{
+	switch (backendType)
+	{
+		case AudioClassifyOptions::FFTBackendType::splitRadix:
+			return SplitRadixFFTBackend<T>::supportsFrameSize(frameSize);
+		case AudioClassifyOptions::FFTBackendType::kissFFT:
+			return frameSize > 0;
+		default: return false;
+	}
+}
+
+//==============================================================================
+template class FFTBackend<float>;
+template class FFTBackend<double>;
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    FFTBackend.h
+    Created: 19 Oct 2026 9:40:12am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef FFTBACKEND_H_INCLUDED
+#define FFTBACKEND_H_INCLUDED
+
+#include <memory>
+#include <cstddef>
+
+#include "../AudioClassifyOptions/AudioClassifyOptions.h"
+
+/** Interface for the forward real FFT implementations used by the spectral analysis
+ *  stages (SpectrumAnalyser). Backends are created via FFTBackend<T>::create() and
+ *  are configured for a single frame size at a time.
+ *
+ *  Note: setFrameSize() allocates and should not be called from the audio thread.
+ *  performFFT() is allocation free.
+ */
+template<typename T>
+class FFTBackend
+{
+public:
+	virtual ~FFTBackend() {}
+
+	/** Creates the requested backend configured for the given frame size. If the
+	 *  backend does not support the frame size a KissFFT backend is returned instead.
+	 */
+	static std::unique_ptr<FFTBackend<T>> create(AudioClassifyOptions::FFTBackendType backendType, std::size_t frameSize);
+
+	/** @return true if backendType can transform frames of frameSize samples. */
+	static bool supportsFrameSize(AudioClassifyOptions::FFTBackendType backendType, std::size_t frameSize);
+
+	virtual AudioClassifyOptions::FFTBackendType getType() const = 0;
+
+	virtual std::size_t getFrameSize() const = 0;
+	virtual void setFrameSize(std::size_t newFrameSize) = 0;
+
+	/** Performs a forward FFT of a real valued frame of getFrameSize() samples.
+	 * @param input the real input frame.
+	 * @param realOut output buffer for the real part of the first getFrameSize() / 2 bins.
+	 * @param imagOut output buffer for the imaginary part of the first getFrameSize() / 2 bins.
+	 */
+	virtual void performFFT(const T* input, T* realOut, T* imagOut) = 0;
+};
+
+
+#endif  // FFTBACKEND_H_INCLUDED
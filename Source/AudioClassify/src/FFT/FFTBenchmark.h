@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    FFTBenchmark.h
+    Created: 19 Oct 2026 11:20:36am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef FFTBENCHMARK_H_INCLUDED
+#define FFTBENCHMARK_H_INCLUDED
+
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+#include "FFTBackend.h"
+
+/** Micro benchmarks for the FFTBackend implementations. Each backend is timed at the STFT
+ *  frame sizes an AudioClassifier uses for a given host buffer size (bufferSize / stftFramesPerBuffer)
+ *  so the fastest backend can be chosen for the machine the plugin is running on.
+ *
+ *  Note: These functions allocate and block for the duration of the benchmark. Do not call
+ *  from the audio thread.
+ */
+namespace FFTBenchmark
+{
+	struct Result
+	{
+		AudioClassifyOptions::FFTBackendType backendType;
+		int frameSize;
+		double microsecondsPerFrame;
+	};
+
+	//===============================================================================
+	/** Times a single backend at a single frame size.
+	 * @return the mean time in microseconds per transform or -1.0 if the backend does not support the frame size.
+	 */
+	template<typename T>
+	double timeBackend(AudioClassifyOptions::FFTBackendType backendType, int frameSize, int numIterations)
+	{
+		if (!FFTBackend<T>::supportsFrameSize(backendType, frameSize))
+			return -1.0;
+
+		auto backend = FFTBackend<T>::create(backendType, frameSize);
+
+		std::vector<T> input(frameSize);
+		std::vector<T> real(frameSize / 2);
+		std::vector<T> imag(frameSize / 2);
+
+		for (auto i = 0; i < frameSize; ++i)
+			input[i] = static_cast<T>(std::sin(0.1 * i) + (0.25 * std::sin(0.37 * i)));
+
+		//Warm up caches and twiddle tables
+		for (auto i = 0; i < 10; ++i)
+			backend->performFFT(input.data(), real.data(), imag.data());
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (auto i = 0; i < numIterations; ++i)
+			backend->performFFT(input.data(), real.data(), imag.data());
+
+		const auto end = std::chrono::steady_clock::now();
+		const std::chrono::duration<double, std::micro> elapsed = end - start;
+
+		return elapsed.count() / static_cast<double>(numIterations);
+	}
+
+	//===============================================================================
+	/** Times every backend at every distinct frame size bufferSize / n for n in 1 - maxSTFTFramesPerBuffer.
+	 *  Unsupported backend / frame size combinations are omitted from the results.
+	 */
+	template<typename T>
+	std::vector<Result> run(int bufferSize, int maxSTFTFramesPerBuffer = 16, int numIterations = 1000)
+	{
+		std::vector<Result> results;
+		std::vector<int> frameSizes;
+
+		for (auto n = 1; n <= maxSTFTFramesPerBuffer; ++n)
+		{
+			auto frameSize = bufferSize / n;
+
+			if (frameSize >= 2 && std::find(frameSizes.begin(), frameSizes.end(), frameSize) == frameSizes.end())
+				frameSizes.push_back(frameSize);
+		}
+
+		const AudioClassifyOptions::FFTBackendType backendTypes[] = { AudioClassifyOptions::FFTBackendType::kissFFT,
+																	   AudioClassifyOptions::FFTBackendType::splitRadix };
+
+		for (auto frameSize : frameSizes)
+		{
+			for (auto backendType : backendTypes)
+			{
+				auto time = timeBackend<T>(backendType, frameSize, numIterations);
+
+				if (time >= 0.0)
+					results.push_back({ backendType, frameSize, time });
+			}
+		}
+
+		return results;
+	}
+
+	//===============================================================================
+	/** @return the fastest backend measured for frameSize or the default backend if frameSize was not benchmarked. */
+	inline AudioClassifyOptions::FFTBackendType getFastestBackend(const std::vector<Result>& results, int frameSize)
+	{
+		auto fastest = AudioClassifyOptions::defaultFFTBackend;
+		auto fastestTime = -1.0;
+
+		for (const auto& result : results)
+		{
+			if (result.frameSize == frameSize && (fastestTime < 0.0 || result.microsecondsPerFrame < fastestTime))
+			{
+				fastest = result.backendType;
+				fastestTime = result.microsecondsPerFrame;
+			}
+		}
+
+		return fastest;
+	}
+}
+
+
+#endif  // FFTBENCHMARK_H_INCLUDED
@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    KissFFTBackend.cpp
+    Created: 19 Oct 2026 9:52:03am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "KissFFTBackend.h"
+#include <cstdlib>
+
+//==============================================================================
+template<typename T>
+KissFFTBackend<T>::KissFFTBackend(std::size_t initFrameSize)
+{
+	setFrameSize(initFrameSize);
+}
+
+//==============================================================================
+template<typename T>
+KissFFTBackend<T>::~KissFFTBackend()
+{
+	freeConfig();
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::FFTBackendType KissFFTBackend<T>::getType() const
+{
+	return AudioClassifyOptions::FFTBackendType::kissFFT;
+}
+
+//==============================================================================
+template<typename T>
+std::size_t KissFFTBackend<T>::getFrameSize() const
+{
+	return frameSize;
+}
+
+//==============================================================================
+template<typename T>
+void KissFFTBackend<T>::setFrameSize(std::size_t newFrameSize)
+{
+	freeConfig();
+
+	frameSize = newFrameSize;
+	config = kiss_fft_alloc(static_cast<int>(frameSize), 0, nullptr, nullptr);
+
+	fftIn.reset(new kiss_fft_cpx[frameSize]);
+	fftOut.reset(new kiss_fft_cpx[frameSize]);
+}
+
+//==============================================================================
+template<typename T>
+void KissFFTBackend<T>::performFFT(const T* input, T* realOut, T* imagOut)
+{
+	for (std::size_t i = 0; i < frameSize; ++i)
+	{
+		fftIn[i].r = static_cast<kiss_fft_scalar>(input[i]);
+		fftIn[i].i = static_cast<kiss_fft_scalar>(0.0);
+	}
+
+	kiss_fft(config, fftIn.get(), fftOut.get());
+
+	for (std::size_t i = 0; i < frameSize / 2; ++i)
+	{
+		realOut[i] = static_cast<T>(fftOut[i].r);
+		imagOut[i] = static_cast<T>(fftOut[i].i);
+	}
+}
+
+//==============================================================================
+template<typename T>
+void KissFFTBackend<T>::freeConfig()
+{
+	if (config != nullptr)
+	{
+		free(config);
+		config = nullptr;
+	}
+}
+
+//==============================================================================
+template class KissFFTBackend<float>;
+template class KissFFTBackend<double>;
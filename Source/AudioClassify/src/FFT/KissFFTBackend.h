@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    KissFFTBackend.h
+    Created: 19 Oct 2026 9:52:03am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef KISSFFTBACKEND_H_INCLUDED
+#define KISSFFTBACKEND_H_INCLUDED
+
+#include "FFTBackend.h"
+#include "../../Gist/libs/kiss_fft130/kiss_fft.h"
+
+/** FFTBackend wrapping the KissFFT library bundled with Gist. Supports any frame size. */
+template<typename T>
+class KissFFTBackend : public FFTBackend<T>
+{
+public:
+	explicit KissFFTBackend(std::size_t initFrameSize);
+	~KissFFTBackend();
+
+	AudioClassifyOptions::FFTBackendType getType() const override;
+
+	std::size_t getFrameSize() const override;
+	void setFrameSize(std::size_t newFrameSize) override;
+
+	void performFFT(const T* input, T* realOut, T* imagOut) override;
+
+private:
+	std::size_t frameSize = 0;
+
+	kiss_fft_cfg config = nullptr;
+
+	std::unique_ptr<kiss_fft_cpx[]> fftIn;
+	std::unique_ptr<kiss_fft_cpx[]> fftOut;
+
+	void freeConfig();
+};
+
+
+#endif  // KISSFFTBACKEND_H_INCLUDED
@@ -0,0 +1,164 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.cpp
+    Created: 19 Oct 2026 10:48:21am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyser.h"
+#include "../Simd/SimdOps.h"
+
+#include <cmath>
+#include <algorithm>
+
+//==============================================================================
+template<typename T>
+SpectrumAnalyser<T>::SpectrumAnalyser(int initFrameSize, AudioClassifyOptions::FFTBackendType initBackendType)
+{
+	backendType.store(initBackendType);
+	setFrameSize(initFrameSize);
+}
+
+//==============================================================================
+template<typename T>
+SpectrumAnalyser<T>::~SpectrumAnalyser()
+{
+}
+
+//==============================================================================
+template<typename T>
+int SpectrumAnalyser<T>::getFrameSize() const
+{
+	return frameSize;
+}
+
+//==============================================================================
+template<typename T>
+void SpectrumAnalyser<T>::setFrameSize(int newFrameSize)
+{
+	frameSize = newFrameSize;
+
+	for (auto i = 0; i < numBackendTypes; ++i)
+	{
+		auto type = static_cast<AudioClassifyOptions::FFTBackendType>(i);
+
+		if (FFTBackend<T>::supportsFrameSize(type, frameSize))
+			backends[i] = FFTBackend<T>::create(type, frameSize);
+		else
+			backends[i].reset(nullptr);
+	}
+
+	//Hanning window - same as the window Gist applies before its FFT.
+	window.reset(new T[frameSize]);
+
+	for (auto i = 0; i < frameSize; ++i)
+		window[i] = static_cast<T>(0.5 * (1.0 - std::cos(2.0 * 3.14159265358979323846 * (static_cast<double>(i) / static_cast<double>(frameSize - 1)))));
+
+	windowedFrame.reset(new T[frameSize]);
+	fftReal.reset(new T[frameSize / 2]);
+	fftImag.reset(new T[frameSize / 2]);
+	magnitudeSpectrum.reset(new T[frameSize / 2]);
+
+	std::fill(magnitudeSpectrum.get(), magnitudeSpectrum.get() + (frameSize / 2), static_cast<T>(0.0));
+
+	//Zero padded so the spectral kernels can run over whole SIMD registers.
+	powerSpectrum.assign(getSimdPaddedSize(frameSize / 2), static_cast<T>(0.0));
+}
+
+//==============================================================================
+template<typename T>
+void SpectrumAnalyser<T>::setBackendType(AudioClassifyOptions::FFTBackendType newBackendType)
+{
+	backendType.store(newBackendType);
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::FFTBackendType SpectrumAnalyser<T>::getBackendType() const
+{
+	return backendType.load();
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::FFTBackendType SpectrumAnalyser<T>::getActiveBackendType() const
+{
+	return getActiveBackend()->getType();
+}
+
+//==============================================================================
+template<typename T>
+void SpectrumAnalyser<T>::process(const T* audioFrame)
+{
+	using Ops = SimdOps<T>;
+
+	const auto size = static_cast<std::size_t>(frameSize);
+	std::size_t i = 0;
+
+	for (; i + Ops::width <= size; i += Ops::width)
+		Ops::store(windowedFrame.get() + i, Ops::mul(Ops::load(audioFrame + i), Ops::load(window.get() + i)));
+
+	for (; i < size; ++i)
+		windowedFrame[i] = audioFrame[i] * window[i];
+
+	getActiveBackend()->performFFT(windowedFrame.get(), fftReal.get(), fftImag.get());
+
+	const auto numBins = size / 2;
+	i = 0;
+
+	for (; i + Ops::width <= numBins; i += Ops::width)
+	{
+		const auto re = Ops::load(fftReal.get() + i);
+		const auto im = Ops::load(fftImag.get() + i);
+		const auto power = Ops::mulAdd(re, re, Ops::mul(im, im));
+
+		Ops::store(powerSpectrum.data() + i, power);
+		Ops::store(magnitudeSpectrum.get() + i, Ops::sqrt(power));
+	}
+
+	for (; i < numBins; ++i)
+	{
+		powerSpectrum[i] = (fftReal[i] * fftReal[i]) + (fftImag[i] * fftImag[i]);
+		magnitudeSpectrum[i] = std::sqrt(powerSpectrum[i]);
+	}
+}
+
+//==============================================================================
+template<typename T>
+const T* SpectrumAnalyser<T>::getMagnitudeSpectrum() const
+{
+	return magnitudeSpectrum.get();
+}
+
+//==============================================================================
+template<typename T>
+const T* SpectrumAnalyser<T>::getPowerSpectrum() const
+{
+	return powerSpectrum.data();
+}
+
+//==============================================================================
+template<typename T>
+int SpectrumAnalyser<T>::getMagnitudeSpectrumSize() const
+{
+	return frameSize / 2;
+}
+
+//==============================================================================
+template<typename T>
+FFTBackend<T>* SpectrumAnalyser<T>::getActiveBackend() const
+{
+	auto* preferred = backends[static_cast<int>(backendType.load())].get();
+
+	if (preferred != nullptr)
+		return preferred;
+
+	return backends[static_cast<int>(AudioClassifyOptions::FFTBackendType::kissFFT)].get();
+}
+
+//==============================================================================
+template class SpectrumAnalyser<float>;
+template class SpectrumAnalyser<double>;
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.h
+    Created: 19 Oct 2026 10:48:21am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef SPECTRUMANALYSER_H_INCLUDED
+#define SPECTRUMANALYSER_H_INCLUDED
+
+#include <atomic>
+#include <memory>
+
+#include "FFTBackend.h"
+#include "../Simd/AlignedAllocator.h"
+
+/** Computes the Hanning windowed magnitude spectrum of audio frames using one of the
+ *  FFTBackend implementations. A backend for every available FFTBackendType is created when the
+ *  frame size is set so the backend can be switched from another thread whilst process() runs
+ *  on the audio thread.
+ */
+template<typename T>
+class SpectrumAnalyser
+{
+public:
+	explicit SpectrumAnalyser(int initFrameSize, AudioClassifyOptions::FFTBackendType initBackendType = AudioClassifyOptions::defaultFFTBackend);
+	~SpectrumAnalyser();
+
+	int getFrameSize() const;
+
+	/** Sets the frame size and reconfigures the backends. 
+	 * Note: This allocates and should not be called from the audio thread.
+	 */
+	void setFrameSize(int newFrameSize);
+
+	/** Sets the preferred FFT backend. If the backend does not support the current
+	 *  frame size KissFFT is used until a supported frame size is set.
+	 */
+	void setBackendType(AudioClassifyOptions::FFTBackendType newBackendType);
+	AudioClassifyOptions::FFTBackendType getBackendType() const;
+
+	/** @return the backend actually in use for the current frame size. */
+	AudioClassifyOptions::FFTBackendType getActiveBackendType() const;
+
+	/** Windows and transforms a frame of getFrameSize() samples and updates the magnitude spectrum. */
+	void process(const T* audioFrame);
+
+	const T* getMagnitudeSpectrum() const;
+
+	/** @return the squared magnitude spectrum. This buffer is cache line aligned and zero padded
+	 *  to getSimdPaddedSize(getMagnitudeSpectrumSize()) elements.
+	 */
+	const T* getPowerSpectrum() const;
+
+	int getMagnitudeSpectrumSize() const;
+
+private:
+	static const int numBackendTypes = 2;
+
+	int frameSize = 0;
+
+	std::atomic<AudioClassifyOptions::FFTBackendType> backendType;
+
+	std::unique_ptr<FFTBackend<T>> backends[numBackendTypes];
+
+	std::unique_ptr<T[]> window;
+	std::unique_ptr<T[]> windowedFrame;
+	std::unique_ptr<T[]> fftReal;
+	std::unique_ptr<T[]> fftImag;
+	std::unique_ptr<T[]> magnitudeSpectrum;
+	AlignedVector<T> powerSpectrum;
+
+	FFTBackend<T>* getActiveBackend() const;
+};
+
+
+#endif  // SPECTRUMANALYSER_H_INCLUDED
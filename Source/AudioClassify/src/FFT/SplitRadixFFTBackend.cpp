@@ -0,0 +1,287 @@
+/*
+  ==============================================================================
+
+    SplitRadixFFTBackend.cpp
+    Created: 19 Oct 2026 10:05:47am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "SplitRadixFFTBackend.h"
+#include "../Simd/SimdOps.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	const double pi = 3.14159265358979323846;
+}
+
+//==============================================================================
+template<typename T>
+SplitRadixFFTBackend<T>::SplitRadixFFTBackend(std::size_t initFrameSize)
+{
+	setFrameSize(initFrameSize);
+}
+
+//==============================================================================
+template<typename T>
+SplitRadixFFTBackend<T>::~SplitRadixFFTBackend()
+{
+}
+
+//==============================================================================
+template<typename T>
+bool SplitRadixFFTBackend<T>::supportsFrameSize(std::size_t frameSize)
+{
+	return frameSize > 1 && (frameSize & (frameSize - 1)) == 0;
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::FFTBackendType SplitRadixFFTBackend<T>::getType() const
+{
+	return AudioClassifyOptions::FFTBackendType::splitRadix;
+}
+
+//==============================================================================
+template<typename T>
+std::size_t SplitRadixFFTBackend<T>::getFrameSize() const
+{
+	return frameSize;
+}
+
+//==============================================================================
+template<typename T>
+void SplitRadixFFTBackend<T>::setFrameSize(std::size_t newFrameSize)
+{
+	assert(supportsFrameSize(newFrameSize));
+
+	frameSize = newFrameSize;
+	complexSize = frameSize / 2;
+
+	workReal.assign(complexSize, static_cast<T>(0.0));
+	workImag.assign(complexSize, static_cast<T>(0.0));
+
+	//Twiddles for every combine level (size >= 4) of the half length complex transform.
+	levelTwiddles.clear();
+	levelTwiddleOffsets.assign(log2(complexSize) + 1, 0);
+
+	for (std::size_t size = 4; size <= complexSize; size *= 2)
+	{
+		const auto quarter = size / 4;
+		levelTwiddleOffsets[log2(size)] = levelTwiddles.size();
+		levelTwiddles.resize(levelTwiddles.size() + (quarter * 4));
+
+		auto* twiddles = levelTwiddles.data() + levelTwiddleOffsets[log2(size)];
+
+		for (std::size_t k = 0; k < quarter; ++k)
+		{
+			const auto angle = 2.0 * pi * static_cast<double>(k) / static_cast<double>(size);
+
+			twiddles[k] = static_cast<T>(std::cos(angle));
+			twiddles[quarter + k] = static_cast<T>(std::sin(angle));
+			twiddles[(2 * quarter) + k] = static_cast<T>(std::cos(3.0 * angle));
+			twiddles[(3 * quarter) + k] = static_cast<T>(std::sin(3.0 * angle));
+		}
+	}
+
+	unpackCos.resize(complexSize);
+	unpackSin.resize(complexSize);
+
+	for (std::size_t k = 0; k < complexSize; ++k)
+	{
+		const auto angle = 2.0 * pi * static_cast<double>(k) / static_cast<double>(frameSize);
+
+		unpackCos[k] = static_cast<T>(std::cos(angle));
+		unpackSin[k] = static_cast<T>(std::sin(angle));
+	}
+}
+
+//==============================================================================
+template<typename T>
+void SplitRadixFFTBackend<T>::performFFT(const T* input, T* realOut, T* imagOut)
+{
+	/** The real frame x[n] is treated as the complex sequence z[n] = x[2n] + i x[2n + 1]
+	 *  of half the length. transform() reads it in place through the stride argument.
+	 */
+	transform(input, 1, workReal.data(), workImag.data(), complexSize);
+
+	const auto half = static_cast<T>(0.5);
+
+	realOut[0] = workReal[0] + workImag[0];
+	imagOut[0] = static_cast<T>(0.0);
+
+	for (std::size_t k = 1; k < complexSize; ++k)
+	{
+		const auto ar = workReal[k];
+		const auto ai = workImag[k];
+		const auto br = workReal[complexSize - k];
+		const auto bi = workImag[complexSize - k];
+
+		//Even and odd sample spectra recovered from Z[k] and conj(Z[N - k])
+		const auto evenReal = half * (ar + br);
+		const auto evenImag = half * (ai - bi);
+		const auto oddReal = half * (ai + bi);
+		const auto oddImag = half * (br - ar);
+
+		const auto c = unpackCos[k];
+		const auto s = unpackSin[k];
+
+		realOut[k] = evenReal + (oddReal * c) + (oddImag * s);
+		imagOut[k] = evenImag + (oddImag * c) - (oddReal * s);
+	}
+}
+
+//==============================================================================
+template<typename T>
+void SplitRadixFFTBackend<T>::transform(const T* input, std::size_t stride, T* outReal, T* outImag, std::size_t size)
+{
+	if (size == 1)
+	{
+		outReal[0] = input[0];
+		outImag[0] = input[1];
+		return;
+	}
+
+	if (size == 2)
+	{
+		const auto aReal = input[0];
+		const auto aImag = input[1];
+		const auto bReal = input[2 * stride];
+		const auto bImag = input[(2 * stride) + 1];
+
+		outReal[0] = aReal + bReal;
+		outImag[0] = aImag + bImag;
+		outReal[1] = aReal - bReal;
+		outImag[1] = aImag - bImag;
+		return;
+	}
+
+	const auto halfSize = size / 2;
+	const auto quarterSize = size / 4;
+
+	//z[2n] -> first half, z[4n + 1] -> third quarter, z[4n + 3] -> fourth quarter
+	transform(input, stride * 2, outReal, outImag, halfSize);
+	transform(input + (2 * stride), stride * 4, outReal + halfSize, outImag + halfSize, quarterSize);
+	transform(input + (6 * stride), stride * 4, outReal + halfSize + quarterSize, outImag + halfSize + quarterSize, quarterSize);
+
+	combine(outReal, outImag, size);
+}
+
+//==============================================================================
+template<typename T>
+void SplitRadixFFTBackend<T>::combine(T* real, T* imag, std::size_t size)
+{
+	using Ops = SimdOps<T>;
+
+	const auto quarter = size / 4;
+
+	const auto* twiddles = levelTwiddles.data() + levelTwiddleOffsets[log2(size)];
+	const auto* cos1 = twiddles;
+	const auto* sin1 = twiddles + quarter;
+	const auto* cos3 = twiddles + (2 * quarter);
+	const auto* sin3 = twiddles + (3 * quarter);
+
+	auto* r0 = real;
+	auto* r1 = real + quarter;
+	auto* r2 = real + (2 * quarter);
+	auto* r3 = real + (3 * quarter);
+
+	auto* i0 = imag;
+	auto* i1 = imag + quarter;
+	auto* i2 = imag + (2 * quarter);
+	auto* i3 = imag + (3 * quarter);
+
+	std::size_t k = 0;
+
+	for (; k + Ops::width <= quarter; k += Ops::width)
+	{
+		const auto zr = Ops::load(r2 + k);
+		const auto zi = Ops::load(i2 + k);
+		const auto c1 = Ops::load(cos1 + k);
+		const auto s1 = Ops::load(sin1 + k);
+
+		//w^k * Z[k] where w = exp(-2 * pi * i / size)
+		const auto ar = Ops::add(Ops::mul(zr, c1), Ops::mul(zi, s1));
+		const auto ai = Ops::sub(Ops::mul(zi, c1), Ops::mul(zr, s1));
+
+		const auto yr = Ops::load(r3 + k);
+		const auto yi = Ops::load(i3 + k);
+		const auto c3 = Ops::load(cos3 + k);
+		const auto s3 = Ops::load(sin3 + k);
+
+		//w^3k * Z'[k]
+		const auto br = Ops::add(Ops::mul(yr, c3), Ops::mul(yi, s3));
+		const auto bi = Ops::sub(Ops::mul(yi, c3), Ops::mul(yr, s3));
+
+		const auto sumReal = Ops::add(ar, br);
+		const auto sumImag = Ops::add(ai, bi);
+		const auto diffReal = Ops::sub(ar, br);
+		const auto diffImag = Ops::sub(ai, bi);
+
+		const auto u0r = Ops::load(r0 + k);
+		const auto u0i = Ops::load(i0 + k);
+		const auto u1r = Ops::load(r1 + k);
+		const auto u1i = Ops::load(i1 + k);
+
+		Ops::store(r0 + k, Ops::add(u0r, sumReal));
+		Ops::store(i0 + k, Ops::add(u0i, sumImag));
+		Ops::store(r2 + k, Ops::sub(u0r, sumReal));
+		Ops::store(i2 + k, Ops::sub(u0i, sumImag));
+
+		Ops::store(r1 + k, Ops::add(u1r, diffImag));
+		Ops::store(i1 + k, Ops::sub(u1i, diffReal));
+		Ops::store(r3 + k, Ops::sub(u1r, diffImag));
+		Ops::store(i3 + k, Ops::add(u1i, diffReal));
+	}
+
+	for (; k < quarter; ++k)
+	{
+		const auto ar = (r2[k] * cos1[k]) + (i2[k] * sin1[k]);
+		const auto ai = (i2[k] * cos1[k]) - (r2[k] * sin1[k]);
+		const auto br = (r3[k] * cos3[k]) + (i3[k] * sin3[k]);
+		const auto bi = (i3[k] * cos3[k]) - (r3[k] * sin3[k]);
+
+		const auto sumReal = ar + br;
+		const auto sumImag = ai + bi;
+		const auto diffReal = ar - br;
+		const auto diffImag = ai - bi;
+
+		const auto u0r = r0[k];
+		const auto u0i = i0[k];
+		const auto u1r = r1[k];
+		const auto u1i = i1[k];
+
+		r0[k] = u0r + sumReal;
+		i0[k] = u0i + sumImag;
+		r2[k] = u0r - sumReal;
+		i2[k] = u0i - sumImag;
+
+		r1[k] = u1r + diffImag;
+		i1[k] = u1i - diffReal;
+		r3[k] = u1r - diffImag;
+		i3[k] = u1i + diffReal;
+	}
+}
+
+//==============================================================================
+template<typename T>
+std::size_t SplitRadixFFTBackend<T>::log2(std::size_t size)
+{
+	std::size_t result = 0;
+
+	while (size > 1)
+	{
+		size >>= 1;
+		++result;
+	}
+
+	return result;
+}
+
+//==============================================================================
+template class SplitRadixFFTBackend<float>;
+template class SplitRadixFFTBackend<double>;
@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    SplitRadixFFTBackend.h
+    Created: 19 Oct 2026 10:05:47am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef SPLITRADIXFFTBACKEND_H_INCLUDED
+#define SPLITRADIXFFTBACKEND_H_INCLUDED
+
+#include <vector>
+
+#include "FFTBackend.h"
+
+/** In-tree split radix FFT backend for power of two frame sizes.
+ *
+ *  The real input frame is packed into a half length complex sequence which is transformed
+ *  with a recursive split radix (N/2, N/4, N/4) decomposition and then unpacked into the real
+ *  spectrum. All data is held in split (real / imaginary) arrays and every level has its own
+ *  contiguous twiddle tables so the butterflies run as SimdOps<T> vector loops.
+ */
+template<typename T>
+class SplitRadixFFTBackend : public FFTBackend<T>
+{
+public:
+	explicit SplitRadixFFTBackend(std::size_t initFrameSize);
+	~SplitRadixFFTBackend();
+
+	/** @return true if frameSize is a power of two greater than 1. */
+	static bool supportsFrameSize(std::size_t frameSize);
+
+	AudioClassifyOptions::FFTBackendType getType() const override;
+
+	std::size_t getFrameSize() const override;
+	void setFrameSize(std::size_t newFrameSize) override;
+
+	void performFFT(const T* input, T* realOut, T* imagOut) override;
+
+private:
+	std::size_t frameSize = 0;
+	std::size_t complexSize = 0;
+
+	//Split complex work buffers of complexSize.
+	std::vector<T> workReal;
+	std::vector<T> workImag;
+
+	//Per level twiddle tables (cos(wk), sin(wk), cos(3wk), sin(3wk)) stored contiguously for each level size.
+	std::vector<T> levelTwiddles;
+	std::vector<std::size_t> levelTwiddleOffsets;
+
+	//Twiddles used to unpack the half length complex transform into the real spectrum.
+	std::vector<T> unpackCos;
+	std::vector<T> unpackSin;
+
+	void transform(const T* input, std::size_t stride, T* outReal, T* outImag, std::size_t size);
+	void combine(T* real, T* imag, std::size_t size);
+
+	static std::size_t log2(std::size_t size);
+};
+
+
+#endif  // SPLITRADIXFFTBACKEND_H_INCLUDED
@@ -9,15 +9,82 @@
 */
 
 #include "FeatureExtractor.h"
+#include "../Simd/SimdKernels.h"
 #include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+
+namespace
+{
+	const int mfccOffset = static_cast<int>(AudioClassifyOptions::AudioFeature::mfcc_1);
+
+	//Gist's spectral rolloff percentile.
+	const double rolloffThreshold = 0.85;
+
+	const int numTimeDomainFeatures = static_cast<int>(AudioClassifyOptions::AudioFeature::spectralCentroid);
+}
+
+//==============================================================================
+double FeatureExtractionCosts::getFrameCost(const std::vector<AudioClassifyOptions::AudioFeature>& features) const
+{
+	auto usesTimeDomain = false;
+	auto usesSpectral = false;
+	auto numMFCCs = 0;
+
+	for (auto feature : features)
+	{
+		const auto baseFeature = AudioClassifyOptions::getBaseFeature(feature);
+		const auto index = static_cast<int>(baseFeature);
+
+		if (index < numTimeDomainFeatures)
+			usesTimeDomain = true;
+		else if (index < mfccOffset)
+			usesSpectral = true;
+		else
+			numMFCCs = std::max(numMFCCs, index - mfccOffset + 1);
+	}
+
+	auto cost = 0.0;
+
+	if (usesTimeDomain)
+		cost += timeDomain;
+
+	if (usesSpectral || numMFCCs > 0)
+		cost += spectrum;
+
+	if (usesSpectral)
+		cost += spectral;
+
+	if (numMFCCs > 0)
+		cost += melSpectrum + (perMFCC * numMFCCs);
+
+	return cost;
+}
+
+//==============================================================================
+double FeatureExtractionCosts::getFeatureCost(AudioClassifyOptions::AudioFeature feature) const
+{
+	return getFrameCost(std::vector<AudioClassifyOptions::AudioFeature>(1, feature));
+}
 
 //==============================================================================
 template<typename T>
 FeatureExtractor<T>::FeatureExtractor(int initFrameSize, int initSampleRate)
-	: gist(initFrameSize, initSampleRate)
+	: frameSize(initFrameSize),
+	  sampleRate(initSampleRate),
+	  spectrumAnalyser(initFrameSize)
 {
-	auto mfccNumCoefficients = gist.getMFCCNumCoefficients();
-	mfccs.reset(new T[mfccNumCoefficients]);
+	featureValues.fill(static_cast<T>(0.0));
+	previousFeatureValues.fill(static_cast<T>(0.0));
+
+	logMelSpectrum.assign(getSimdPaddedSize(numMelBands), static_cast<T>(0.0));
+	blockSums.assign((frameSize / 2) + 1, static_cast<T>(0.0));
+
+	melTables = MelTableCache<T>::getTables(frameSize, sampleRate, numMelBands);
 }
 
 //==============================================================================
@@ -30,14 +97,163 @@ FeatureExtractor<T>::~FeatureExtractor()
 template<typename T>
 void FeatureExtractor<T>::setSampleRate(int newSampleRate)
 {
-	gist.setSamplingFrequency(newSampleRate);
+	sampleRate = newSampleRate;
+
+	//Prepared tables are for the old sample rate
+	std::vector<int> preparedSizes;
+
+	for (const auto& tables : preparedMelTables)
+		preparedSizes.push_back(tables->frameSize);
+
+	prepareFrameSizes(preparedSizes);
+
+	melTables = MelTableCache<T>::getTables(frameSize, sampleRate, numMelBands);
 }
 
 //==============================================================================
 template<typename T>
 void FeatureExtractor<T>::setFrameSize(int newFrameSize)
 {
-	gist.setAudioFrameSize(newFrameSize);
+	frameSize = newFrameSize;
+	spectrumAnalyser.setFrameSize(newFrameSize);
+	blockSums.assign((frameSize / 2) + 1, static_cast<T>(0.0));
+
+	melTables = MelTableCache<T>::getTables(frameSize, sampleRate, numMelBands);
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::prepareFrameSizes(const std::vector<int>& frameSizes)
+{
+	std::vector<typename MelTableCache<T>::TablesPtr> newTables;
+	newTables.reserve(frameSizes.size());
+
+	for (auto size : frameSizes)
+		newTables.push_back(MelTableCache<T>::getTables(size, sampleRate, numMelBands));
+
+	preparedMelTables.swap(newTables);
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::setFFTBackendType(AudioClassifyOptions::FFTBackendType newBackendType)
+{
+	spectrumAnalyser.setBackendType(newBackendType);
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::FFTBackendType FeatureExtractor<T>::getFFTBackendType() const
+{
+	return spectrumAnalyser.getBackendType();
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::setNumMFCCs(int newNumMFCCs)
+{
+	assert(newNumMFCCs >= 0 && newNumMFCCs <= numMelBands);
+
+	if (newNumMFCCs == numMFCCs)
+		return;
+
+	numMFCCs = newNumMFCCs;
+
+	//Coefficients no longer computed should not keep stale values
+	std::fill(getMFCCs() + numMFCCs, getMFCCs() + numMelBands, static_cast<T>(0.0));
+}
+
+//==============================================================================
+template<typename T>
+int FeatureExtractor<T>::getNumMFCCs() const
+{
+	return numMFCCs;
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::setTimeDomainFeaturesEnabled(bool enabled)
+{
+	timeDomainFeaturesEnabled = enabled;
+
+	if (!enabled)
+		std::fill(featureValues.begin(), featureValues.begin() + numTimeDomainFeatures, static_cast<T>(0.0));
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::setSpectralFeaturesEnabled(bool enabled)
+{
+	spectralFeaturesEnabled = enabled;
+
+	if (!enabled)
+		std::fill(featureValues.begin() + numTimeDomainFeatures, featureValues.begin() + mfccOffset, static_cast<T>(0.0));
+}
+
+//==============================================================================
+template<typename T>
+bool FeatureExtractor<T>::isTimeDomainFeature(AudioClassifyOptions::AudioFeature feature)
+{
+	return static_cast<int>(feature) < numTimeDomainFeatures;
+}
+
+//==============================================================================
+template<typename T>
+bool FeatureExtractor<T>::isSpectralFeature(AudioClassifyOptions::AudioFeature feature)
+{
+	return static_cast<int>(feature) >= numTimeDomainFeatures && static_cast<int>(feature) < mfccOffset;
+}
+
+//==============================================================================
+template<typename T>
+FeatureExtractionCosts FeatureExtractor<T>::measureCosts(int numIterations)
+{
+	std::vector<T> frame(frameSize);
+
+	std::mt19937 randomEngine(1234);
+	std::uniform_real_distribution<double> noise(-1.0, 1.0);
+
+	for (auto& sample : frame)
+		sample = static_cast<T>(noise(randomEngine));
+
+	const auto iterations = std::max(numIterations, 1);
+
+	//Mean microseconds per call after one untimed call to warm the caches.
+	auto timeStage = [iterations](const std::function<void()>& stage)
+	{
+		stage();
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (auto i = 0; i < iterations; ++i)
+			stage();
+
+		const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+		return elapsed.count() / static_cast<double>(iterations);
+	};
+
+	FeatureExtractionCosts costs;
+
+	costs.timeDomain = timeStage([&]() { computeTimeDomainFeatures(frame.data()); });
+	costs.spectrum = timeStage([&]() { spectrumAnalyser.process(frame.data()); });
+	costs.spectral = timeStage([&]() { computeSpectralFeatures(); });
+
+	//The mel spectrum is computed for any MFCC, then one DCT row per coefficient.
+	const auto numMFCCsInUse = numMFCCs;
+
+	numMFCCs = 1;
+	const auto oneMFCC = timeStage([&]() { computeMFCCs(); });
+
+	numMFCCs = numMelBands;
+	const auto allMFCCs = timeStage([&]() { computeMFCCs(); });
+
+	setNumMFCCs(numMFCCsInUse);
+
+	costs.perMFCC = std::max(allMFCCs - oneMFCC, 0.0) / static_cast<double>(numMelBands - 1);
+	costs.melSpectrum = std::max(oneMFCC - costs.perMFCC, 0.0);
+
+	return costs;
 }
 
 //==============================================================================
@@ -45,88 +261,410 @@ template<typename T>
 void FeatureExtractor<T>::processFrame(const T* audioFrame, const int frameSize)
 {
 	//May remove
-	assert(gist.getAudioFrameSize() == frameSize);
+	assert(spectrumAnalyser.getFrameSize() == frameSize);
+
+	if (timeDomainFeaturesEnabled)
+		computeTimeDomainFeatures(audioFrame);
+
+	if (spectralFeaturesEnabled || numMFCCs > 0)
+		spectrumAnalyser.process(audioFrame);
+
+	if (spectralFeaturesEnabled)
+		computeSpectralFeatures();
+
+	computeMFCCs();
 
-	gist.processAudioFrame(audioFrame, frameSize);
+	computeDeltas();
+}
 
-	gist.melFrequencyCepstralCoefficients(mfccs.get());
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::resetDeltas()
+{
+	numFramesSinceReset = 0;
 }
 
 //==============================================================================
 template<typename T>
-T FeatureExtractor<T>::getFeature(AudioClassifyOptions::AudioFeature feature)
+void FeatureExtractor<T>::computeDeltas()
 {
-	T featureValue = static_cast<T>(0.0);
+	const auto numBase = AudioClassifyOptions::numBaseAudioFeatures;
+
+	auto* current = featureValues.data();
+	auto* delta = current + numBase;
+	auto* deltaDelta = delta + numBase;
 
-	switch (feature)
+	for (auto i = 0; i < numBase; ++i)
 	{
-		case AudioClassifyOptions::AudioFeature::rms :
-			featureValue = gist.rootMeanSquare();
-			break;
-		case AudioClassifyOptions::AudioFeature::peakEnergy :
-			featureValue = gist.peakEnergy();
-			break;
-		case AudioClassifyOptions::AudioFeature::zeroCrossingRate :
-			featureValue = gist.zeroCrossingRate();
-			break;
-		case AudioClassifyOptions::AudioFeature::spectralCentroid :
-			featureValue = gist.spectralCentroid();
-			break;
-		case AudioClassifyOptions::AudioFeature::spectralCrest :
-			featureValue = gist.spectralCrest();
-			break;
-		case AudioClassifyOptions::AudioFeature::spectralFlatness :
-			featureValue = gist.spectralFlatness();
-			break;
-		case AudioClassifyOptions::AudioFeature::spectralRolloff :
-			featureValue = gist.spectralRolloff();
-			break;
-		case AudioClassifyOptions::AudioFeature::spectralKurtois :
-			featureValue = gist.spectralKurtosis();
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_1 :
-			featureValue = mfccs[0];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_2 :
-			featureValue = mfccs[1];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_3 :
-			featureValue = mfccs[2];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_4 :
-			featureValue = mfccs[3];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_5 :
-			featureValue = mfccs[4];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_6 :
-			featureValue = mfccs[5];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_7 :
-			featureValue = mfccs[6];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_8 :
-			featureValue = mfccs[7];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_9 :
-			featureValue = mfccs[8];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_10 :
-			featureValue = mfccs[9];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_11 :
-			featureValue = mfccs[10];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_12 :
-			featureValue = mfccs[11];
-			break;
-		case AudioClassifyOptions::AudioFeature::mfcc_13 :
-			featureValue = mfccs[12];
+		const auto newDelta = (numFramesSinceReset > 0) ? current[i] - previousFeatureValues[i] : static_cast<T>(0.0);
+
+		deltaDelta[i] = (numFramesSinceReset > 1) ? newDelta - delta[i] : static_cast<T>(0.0);
+		delta[i] = newDelta;
+
+		previousFeatureValues[i] = current[i];
+	}
+
+	numFramesSinceReset = std::min(numFramesSinceReset + 1, 2);
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::processFrames(const T* audio, std::size_t numFrames, int hopSize, arma::Mat<T>& output, ThreadPool* pool)
+{
+	output.set_size(numFrames, AudioClassifyOptions::totalNumAudioFeatures);
+
+	if (numFrames == 0)
+		return;
+
+	if (pool == nullptr)
+	{
+		processFrameRange(audio, 0, numFrames, hopSize, output);
+	}
+	else
+	{
+		const auto backendType = spectrumAnalyser.getBackendType();
+
+		//Ranges are large enough to amortise creating an extractor per range.
+		pool->parallelFor(numFrames, [&](std::size_t begin, std::size_t end)
+		{
+			FeatureExtractor<T> rangeExtractor(frameSize, sampleRate);
+			rangeExtractor.setFFTBackendType(backendType);
+			rangeExtractor.setNumMFCCs(numMFCCs);
+			rangeExtractor.processFrameRange(audio, begin, end, hopSize, output);
+		}, 64);
+	}
+
+	computeBatchDeltas(output);
+
+	//Debug builds check the batch against frame by frame extraction.
+	assert(matchesFrameByFrame(audio, numFrames, hopSize, output));
+}
+
+//==============================================================================
+template<typename T>
+bool FeatureExtractor<T>::matchesFrameByFrame(const T* audio, std::size_t numFrames, int hopSize, const arma::Mat<T>& output) const
+{
+	FeatureExtractor<T> extractor(frameSize, sampleRate);
+	extractor.setFFTBackendType(spectrumAnalyser.getBackendType());
+	extractor.setNumMFCCs(numMFCCs);
+
+	const auto tolerance = static_cast<T>(1.0e-4);
+
+	for (std::size_t frame = 0; frame < numFrames; ++frame)
+	{
+		extractor.processFrame(audio + (frame * static_cast<std::size_t>(hopSize)), frameSize);
+
+		for (auto feature = 0; feature < AudioClassifyOptions::totalNumAudioFeatures; ++feature)
+		{
+			const auto expected = extractor.getFeature(static_cast<AudioClassifyOptions::AudioFeature>(feature));
+
+			if (std::abs(output(frame, feature) - expected) > tolerance * std::max(static_cast<T>(1.0), std::abs(expected)))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::processFrameRange(const T* audio, std::size_t beginFrame, std::size_t endFrame, int hopSize, arma::Mat<T>& output)
+{
+	const auto numBase = AudioClassifyOptions::numBaseAudioFeatures;
+
+	for (auto frame = beginFrame; frame < endFrame; ++frame)
+	{
+		const auto* audioFrame = audio + (frame * static_cast<std::size_t>(hopSize));
+
+		computeTimeDomainFeatures(audioFrame);
+		spectrumAnalyser.process(audioFrame);
+		computeSpectralFeatures();
+		computeMFCCs();
+
+		for (auto feature = 0; feature < numBase; ++feature)
+			output(frame, feature) = featureValues[feature];
+	}
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::computeBatchDeltas(arma::Mat<T>& output)
+{
+	using Ops = SimdOps<T>;
+
+	const auto numBase = AudioClassifyOptions::numBaseAudioFeatures;
+	const auto numFrames = static_cast<std::size_t>(output.n_rows);
+
+	//Each column is one feature over all frames, so the deltas are differences of shifted columns.
+	for (auto order = 1; order <= 2; ++order)
+	{
+		for (auto feature = 0; feature < numBase; ++feature)
+		{
+			const auto* source = output.colptr(feature + ((order - 1) * numBase));
+			auto* destination = output.colptr(feature + (order * numBase));
+
+			//First frame(s) have nothing to difference against, as after resetDeltas().
+			const auto numZeroFrames = std::min(static_cast<std::size_t>(order), numFrames);
+			std::fill(destination, destination + numZeroFrames, static_cast<T>(0.0));
+
+			auto i = static_cast<std::size_t>(order);
+
+			for (; i + Ops::width <= numFrames; i += Ops::width)
+				Ops::store(destination + i, Ops::sub(Ops::load(source + i), Ops::load(source + i - 1)));
+
+			for (; i < numFrames; ++i)
+				destination[i] = source[i] - source[i - 1];
+		}
+	}
+}
+
+//==============================================================================
+template<typename T>
+int FeatureExtractor<T>::getFrameSize() const
+{
+	return frameSize;
+}
+
+//==============================================================================
+template<typename T>
+int FeatureExtractor<T>::getSampleRate() const
+{
+	return sampleRate;
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::computeTimeDomainFeatures(const T* audioFrame)
+{
+	using Ops = SimdOps<T>;
+
+	const auto size = static_cast<std::size_t>(frameSize);
+
+	auto sumOfSquares = Ops::zero();
+	auto peak = Ops::zero();
+	auto numZeroCrossings = 0;
+
+	auto previousPositive = audioFrame[0] > static_cast<T>(0.0);
+	std::size_t i = 0;
+
+	for (; i + Ops::width <= size; i += Ops::width)
+	{
+		const auto x = Ops::load(audioFrame + i);
+
+		sumOfSquares = Ops::mulAdd(x, x, sumOfSquares);
+		peak = Ops::max(peak, Ops::abs(x));
+
+		for (std::size_t j = i; j < i + Ops::width; ++j)
+		{
+			const auto positive = audioFrame[j] > static_cast<T>(0.0);
+			numZeroCrossings += (positive != previousPositive) ? 1 : 0;
+			previousPositive = positive;
+		}
+	}
+
+	auto totalSumOfSquares = Ops::sum(sumOfSquares);
+	auto peakEnergy = Ops::maxElement(peak);
+
+	for (; i < size; ++i)
+	{
+		totalSumOfSquares += audioFrame[i] * audioFrame[i];
+		peakEnergy = std::max(peakEnergy, std::abs(audioFrame[i]));
+
+		const auto positive = audioFrame[i] > static_cast<T>(0.0);
+		numZeroCrossings += (positive != previousPositive) ? 1 : 0;
+		previousPositive = positive;
+	}
+
+	featureValues[static_cast<int>(AudioClassifyOptions::AudioFeature::rms)] = std::sqrt(totalSumOfSquares / static_cast<T>(size));
+	featureValues[static_cast<int>(AudioClassifyOptions::AudioFeature::peakEnergy)] = peakEnergy;
+	featureValues[static_cast<int>(AudioClassifyOptions::AudioFeature::zeroCrossingRate)] = static_cast<T>(numZeroCrossings);
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::computeSpectralFeatures()
+{
+	using Ops = SimdOps<T>;
+
+	const auto* magnitudeSpectrum = spectrumAnalyser.getMagnitudeSpectrum();
+	const auto* powerSpectrum = spectrumAnalyser.getPowerSpectrum();
+	const auto numBins = static_cast<std::size_t>(spectrumAnalyser.getMagnitudeSpectrumSize());
+
+	/** First sweep accumulates the magnitude and power sums, the bin weighted sum for the centroid
+	 *  and the maximum power for the crest. The flatness log sum is scalar as SimdOps has no vector log.
+	 *  The kurtosis moments need the mean so they take a second sweep below.
+	 *  Each feature follows the Gist definition, including its value for a silent frame.
+	 */
+	auto sum1 = Ops::zero();
+	auto sum2 = Ops::zero();
+	auto weightedSum = Ops::zero();
+	auto maxPower = Ops::zero();
+
+	//Bin numbers of the current block for the centroid
+	T binOffsets[Ops::width];
+
+	for (std::size_t j = 0; j < Ops::width; ++j)
+		binOffsets[j] = static_cast<T>(j);
+
+	auto binIndex = Ops::load(binOffsets);
+	const auto indexStep = Ops::set1(static_cast<T>(Ops::width));
+
+	auto logSum = static_cast<T>(0.0);
+	auto runningSum = static_cast<T>(0.0);
+
+	std::size_t i = 0;
+	std::size_t block = 0;
+
+	for (; i + Ops::width <= numBins; i += Ops::width, ++block)
+	{
+		const auto m = Ops::load(magnitudeSpectrum + i);
+		const auto p = Ops::load(powerSpectrum + i);
+
+		sum1 = Ops::add(sum1, m);
+		sum2 = Ops::add(sum2, p);
+		weightedSum = Ops::mulAdd(binIndex, m, weightedSum);
+		maxPower = Ops::max(maxPower, p);
+
+		binIndex = Ops::add(binIndex, indexStep);
+
+		for (std::size_t j = i; j < i + Ops::width; ++j)
+			logSum += std::log(static_cast<T>(1.0) + magnitudeSpectrum[j]);
+
+		runningSum += Ops::sum(m);
+		blockSums[block] = runningSum;
+	}
+
+	auto s1 = Ops::sum(sum1);
+	auto s2 = Ops::sum(sum2);
+	auto weighted = Ops::sum(weightedSum);
+	auto peakPower = Ops::maxElement(maxPower);
+
+	const auto numFullBlocks = block;
+
+	for (; i < numBins; ++i)
+	{
+		const auto m = magnitudeSpectrum[i];
+		const auto p = powerSpectrum[i];
+
+		s1 += m;
+		s2 += p;
+		weighted += static_cast<T>(i) * m;
+		peakPower = std::max(peakPower, p);
+
+		logSum += std::log(static_cast<T>(1.0) + m);
+	}
+
+	const auto n = static_cast<T>(numBins);
+	const auto zero = static_cast<T>(0.0);
+
+	//Centroid
+	featureValues[static_cast<int>(AudioClassifyOptions::AudioFeature::spectralCentroid)] = (s1 > zero) ? (weighted / s1) : zero;
+
+	//Crest - peak power over mean power, a ratio so 1 for a silent frame
+	featureValues[static_cast<int>(AudioClassifyOptions::AudioFeature::spectralCrest)] = (s2 > zero) ? (peakPower / (s2 / n)) : static_cast<T>(1.0);
+
+	//Flatness - geometric mean over arithmetic mean of 1 + magnitude, so zero bins don't force it to zero
+	const auto arithmeticMean = static_cast<T>(1.0) + (s1 / n);
+	featureValues[static_cast<int>(AudioClassifyOptions::AudioFeature::spectralFlatness)] = std::exp(logSum / n) / arithmeticMean;
+
+	//Kurtosis - m4 / m2^2 - 3 from the central moments. Expanding them from raw sums cancels badly when
+	//the mean is large relative to the spread, so this takes a second sweep over the differences.
+	const auto mean = s1 / n;
+	const auto meanVector = Ops::set1(mean);
+
+	auto squaredDiffSum = Ops::zero();
+	auto fourthPowerDiffSum = Ops::zero();
+
+	for (i = 0; i + Ops::width <= numBins; i += Ops::width)
+	{
+		const auto difference = Ops::sub(Ops::load(magnitudeSpectrum + i), meanVector);
+		const auto squaredDifference = Ops::mul(difference, difference);
+
+		squaredDiffSum = Ops::add(squaredDiffSum, squaredDifference);
+		fourthPowerDiffSum = Ops::mulAdd(squaredDifference, squaredDifference, fourthPowerDiffSum);
+	}
+
+	auto moment2 = Ops::sum(squaredDiffSum);
+	auto moment4 = Ops::sum(fourthPowerDiffSum);
+
+	for (; i < numBins; ++i)
+	{
+		const auto difference = magnitudeSpectrum[i] - mean;
+		const auto squaredDifference = difference * difference;
+
+		moment2 += squaredDifference;
+		moment4 += squaredDifference * squaredDifference;
+	}
+
+	moment2 /= n;
+	moment4 /= n;
+
+	featureValues[static_cast<int>(AudioClassifyOptions::AudioFeature::spectralKurtois)] = (moment2 > zero) ? ((moment4 / (moment2 * moment2)) - static_cast<T>(3.0)) : static_cast<T>(-3.0);
+
+	//Rolloff - find the block containing the threshold from the block totals, then the bin within it.
+	//As in Gist the first bin past the threshold is used, or bin 0 if the sum never passes it.
+	const auto threshold = s1 * static_cast<T>(rolloffThreshold);
+
+	std::size_t rolloffBin = 0;
+	std::size_t searchBlock = 0;
+
+	while (searchBlock < numFullBlocks && blockSums[searchBlock] <= threshold)
+		++searchBlock;
+
+	auto cumulativeSum = (searchBlock > 0) ? blockSums[searchBlock - 1] : zero;
+
+	for (std::size_t bin = searchBlock * Ops::width; bin < numBins; ++bin)
+	{
+		cumulativeSum += magnitudeSpectrum[bin];
+
+		if (cumulativeSum > threshold)
+		{
+			rolloffBin = bin;
 			break;
-		default: break;
+		}
 	}
 
-	return featureValue;
+	featureValues[static_cast<int>(AudioClassifyOptions::AudioFeature::spectralRolloff)] = (numBins > 0) ? static_cast<T>(rolloffBin) / n : zero;
+}
+
+//==============================================================================
+template<typename T>
+void FeatureExtractor<T>::computeMFCCs()
+{
+	if (numMFCCs == 0)
+		return;
+
+	const auto& tables = *melTables;
+	const auto* magnitudeSpectrum = spectrumAnalyser.getMagnitudeSpectrum();
+
+	//Mel GEMV - each filter row is only multiplied over its non zero range. As in Gist the filters
+	//weight the squared magnitudes, which can differ from the power spectrum in the last bit.
+	for (auto band = 0; band < tables.numBands; ++band)
+	{
+		const auto start = tables.filterStart[band];
+		const auto* filter = tables.filterBank.data() + (band * tables.paddedSpectrumSize);
+
+		auto energy = SimdKernels::weightedSumOfSquares(filter + start, magnitudeSpectrum + start, static_cast<std::size_t>(tables.filterEnd[band] - start));
+
+		logMelSpectrum[band] = std::log(energy + static_cast<T>(FLT_MIN));
+	}
+
+	//DCT GEMV over the padded rows, only for the coefficients in use.
+	SimdKernels::gemv(tables.dct.data(), static_cast<std::size_t>(tables.paddedNumBands), logMelSpectrum.data(), getMFCCs(), static_cast<std::size_t>(numMFCCs), static_cast<std::size_t>(tables.paddedNumBands));
+}
+
+//==============================================================================
+template<typename T>
+T* FeatureExtractor<T>::getMFCCs()
+{
+	return featureValues.data() + mfccOffset;
+}
+
+//==============================================================================
+template<typename T>
+T FeatureExtractor<T>::getFeature(AudioClassifyOptions::AudioFeature feature) const
+{
+	return featureValues[static_cast<int>(feature)];
 }
 
 //==============================================================================
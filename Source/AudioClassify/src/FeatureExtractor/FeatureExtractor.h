@@ -11,9 +11,48 @@
 #ifndef FEATUREEXTRACTOR_H_INCLUDED
 #define FEATUREEXTRACTOR_H_INCLUDED
 
-#include "../../Gist/src/Gist.h";
-#include "../AudioClassifyOptions/AudioClassifyOptions.h";
+//For windows compatibility with armadillo 64bit
+#ifdef _WIN64
+#define ARMA_64BIT_WORD
+#endif
 
+#include <armadillo.h>
+
+#include <vector>
+#include <array>
+
+#include "../AudioClassifyOptions/AudioClassifyOptions.h"
+#include "../FFT/SpectrumAnalyser.h"
+#include "../MFCC/MelTables.h"
+#include "../Threading/ThreadPool.h"
+
+/** Compute cost in microseconds per frame of each stage of FeatureExtractor::processFrame(), as
+ *  measured by FeatureExtractor::measureCosts() on the running machine. Features computed by the
+ *  same stage share its cost, so the cost of a feature set is the cost of the stages it needs.
+ */
+struct FeatureExtractionCosts
+{
+	double timeDomain = 0.0;	//RMS, peak energy and zero crossing rate
+	double spectrum = 0.0;		//Windowed FFT, needed by the spectral features and MFCCs
+	double spectral = 0.0;		//Centroid, crest, flatness, rolloff and kurtosis
+	double melSpectrum = 0.0;	//Log mel spectrum, needed by any MFCC
+	double perMFCC = 0.0;		//DCT row of each MFCC up to the highest used
+
+	/** @return the cost per frame of the stages the given features need. Delta features cost their base feature. */
+	double getFrameCost(const std::vector<AudioClassifyOptions::AudioFeature>& features) const;
+
+	/** @return the cost per frame of computing a feature on its own. */
+	double getFeatureCost(AudioClassifyOptions::AudioFeature feature) const;
+};
+
+//==============================================================================
+/** Computes every AudioClassifyOptions::AudioFeature for a frame in processFrame():
+ *  - one fused pass over the time domain frame (RMS, peak energy, zero crossings)
+ *  - one fused pass over the magnitude / power spectrum (centroid, crest, flatness, rolloff, kurtosis)
+ *  - the MFCC GEMVs
+ *  - the delta / delta-delta features, from the previous frame's cached values
+ *  The results are cached so getFeature() is a lookup.
+ */
 template<typename T>
 class FeatureExtractor
 {
@@ -21,17 +60,113 @@ public:
 	FeatureExtractor(int initBufferSize, int initSampleRate);
 	~FeatureExtractor();
 
+	/** Note: setSampleRate() and setFrameSize() allocate and may build the mel tables.
+	 *  Do not call from the audio thread.
+	 */
 	void setSampleRate(int newSampleRate);
 	void setFrameSize(int newFrameSize);
 
+	/** Acquires and holds the mel tables for each of the given frame sizes at the current sample rate
+	 *  so later setFrameSize() calls with these sizes do not have to build them.
+	 * Note: This method allocates. Do not call from the audio thread.
+	 */
+	void prepareFrameSizes(const std::vector<int>& frameSizes);
+
+	void setFFTBackendType(AudioClassifyOptions::FFTBackendType newBackendType);
+	AudioClassifyOptions::FFTBackendType getFFTBackendType() const;
+
+	/** Sets how many MFCCs processFrame() computes, i.e. the highest MFCC used by the active
+	 *  feature set. MFCCs above this return 0 from getFeature().
+	 * @param newNumMFCCs the number of coefficients to compute 0 - numMelBands.
+	 */
+	void setNumMFCCs(int newNumMFCCs);
+	int getNumMFCCs() const;
+
+	/** Sets whether processFrame() computes the time domain features and the spectral shape features,
+	 *  both enabled by default. The spectrum is only analysed when spectral features or MFCCs are
+	 *  computed. Features not computed return 0 from getFeature(). Safe to call from the audio thread.
+	 */
+	void setTimeDomainFeaturesEnabled(bool enabled);
+	void setSpectralFeaturesEnabled(bool enabled);
+
+	/** @return true if the (base) feature is computed by the time domain / spectral shape stage. */
+	static bool isTimeDomainFeature(AudioClassifyOptions::AudioFeature feature);
+	static bool isSpectralFeature(AudioClassifyOptions::AudioFeature feature);
+
+	/** Times each stage of processFrame() on a frame of noise at the current frame size, sample rate
+	 *  and FFT backend. Overwrites the feature values, so use an extractor that is not processing audio.
+	 * Note: This method blocks and allocates. Do not call from the audio thread.
+	 */
+	FeatureExtractionCosts measureCosts(int numIterations = 1000);
+
 	void processFrame(const T* audioFrame, const int frameSize);
 
-	T getFeature(AudioClassifyOptions::AudioFeature feature);
+	/** Starts a new delta history. Call before the first frame of each instance so deltas are
+	 *  not taken against the last frame of the previous onset. The delta features of the first frame
+	 *  after a reset (and delta-delta features of the first two) are 0.
+	 */
+	void resetDeltas();
+
+	/** Batch extraction for offline data set building. Extracts every AudioFeature for numFrames
+	 *  frames of getFrameSize() samples read from audio every hopSize samples and writes them feature
+	 *  major (structure of arrays) into output, i.e. output is resized to numFrames x totalNumAudioFeatures
+	 *  and output.col(feature) holds the values of that feature for every frame.
+	 *
+	 *  The frames are treated as one continuous stream - deltas start from frame 0 and are taken
+	 *  between consecutive frames. They are computed after the base features as vectorised column
+	 *  differences rather than frame by frame. MFCCs above getNumMFCCs() are 0, as from processFrame(),
+	 *  and debug builds assert that every value matches processFrame() / getFeature() after resetDeltas().
+	 *
+	 *  Note: This method allocates and must not be called from the audio thread or concurrently with
+	 *  processFrame() on the same extractor.
+	 * @param pool if not nullptr frames are split across the pool's threads, each range using its own
+	 *  extractor configured like this one (the mel tables are shared).
+	 */
+	void processFrames(const T* audio, std::size_t numFrames, int hopSize, arma::Mat<T>& output, ThreadPool* pool = nullptr);
+
+	int getFrameSize() const;
+	int getSampleRate() const;
+
+	T getFeature(AudioClassifyOptions::AudioFeature feature) const;
+
+	static const int numMelBands = 13;
 
 private:
-    std::unique_ptr<T[]> mfccs;
+	int frameSize = 0;
+	int sampleRate = 0;
+	int numMFCCs = numMelBands;
+	bool timeDomainFeaturesEnabled = true;
+	bool spectralFeaturesEnabled = true;
+
+	//Feature values for the last processed frame, indexed by AudioFeature.
+	std::array<T, AudioClassifyOptions::totalNumAudioFeatures> featureValues;
+	std::array<T, AudioClassifyOptions::numBaseAudioFeatures> previousFeatureValues;
+
+	//Number of frames processed since resetDeltas(), capped at 2
+	int numFramesSinceReset = 0;
+
+	//Log mel spectrum, zero padded to MelTables::paddedNumBands
+	AlignedVector<T> logMelSpectrum;
+
+	//Running magnitude totals per SIMD block, used to find the rolloff bin without a second sweep.
+	std::vector<T> blockSums;
+
+	SpectrumAnalyser<T> spectrumAnalyser;
+
+	//Shared between all extractors using the same frame size / sample rate
+	typename MelTableCache<T>::TablesPtr melTables;
+	std::vector<typename MelTableCache<T>::TablesPtr> preparedMelTables;
+
+	void computeTimeDomainFeatures(const T* audioFrame);
+	void computeSpectralFeatures();
+	void computeMFCCs();
+	void computeDeltas();
+
+	void processFrameRange(const T* audio, std::size_t beginFrame, std::size_t endFrame, int hopSize, arma::Mat<T>& output);
+	static void computeBatchDeltas(arma::Mat<T>& output);
+	bool matchesFrameByFrame(const T* audio, std::size_t numFrames, int hopSize, const arma::Mat<T>& output) const;
 
-	Gist<T> gist;
+	T* getMFCCs();
 };
 
 
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    MelTables.cpp
+    Created: 19 Oct 2026 1:15:52pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "MelTables.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace
+{
+	const double pi = 3.14159265358979323846;
+}
+
+//==============================================================================
+template<typename T>
+MelTables<T>::MelTables(int initFrameSize, int initSampleRate, int initNumBands)
+	: frameSize(initFrameSize),
+	  sampleRate(initSampleRate),
+	  numBands(initNumBands),
+	  numCoefficients(initNumBands),
+	  magnitudeSpectrumSize(initFrameSize / 2),
+	  paddedSpectrumSize(static_cast<int>(getSimdPaddedSize(initFrameSize / 2))),
+	  paddedNumBands(static_cast<int>(getSimdPaddedSize(initNumBands)))
+{
+	filterBank.assign(numBands * paddedSpectrumSize, static_cast<T>(0.0));
+	filterStart.assign(numBands, 0);
+	filterEnd.assign(numBands, 0);
+
+	//Band edge / centre bins built as Gist builds them, so the MFCCs match data sets recorded with it:
+	//whole mel steps up to the floored mel of the nyquist frequency, each rounded to the nearest bin.
+	const auto nyquist = sampleRate / 2;
+	const auto maxMel = static_cast<int>(std::floor(frequencyToMel(static_cast<T>(nyquist))));
+	const auto melScale = std::log(1.0 + (1000.0 / 700.0)) / 1000.0;
+
+	std::vector<int> bandBins(numBands + 2);
+
+	for (auto i = 0; i < numBands + 2; ++i)
+	{
+		const auto mel = static_cast<double>((i * maxMel) / (numBands + 1));
+		const auto bin = std::floor(0.5 + (700.0 * static_cast<double>(magnitudeSpectrumSize) * ((std::exp(mel * melScale) - 1.0) / nyquist)));
+
+		bandBins[i] = std::max(0, std::min(static_cast<int>(bin), magnitudeSpectrumSize));
+	}
+
+	for (auto band = 0; band < numBands; ++band)
+	{
+		const auto start = bandBins[band];
+		const auto centre = bandBins[band + 1];
+		const auto end = bandBins[band + 2];
+
+		auto* filter = filterBank.data() + (band * paddedSpectrumSize);
+
+		for (auto k = start; k < centre; ++k)
+			filter[k] = static_cast<T>(k - start) / static_cast<T>(centre - start);
+
+		for (auto k = centre; k < end; ++k)
+			filter[k] = static_cast<T>(end - k) / static_cast<T>(end - centre);
+
+		filterStart[band] = start;
+		filterEnd[band] = end;
+	}
+
+	//Gist's DCT-II, scaled by 2 and with the angle rounded to T.
+	dct.assign(numCoefficients * paddedNumBands, static_cast<T>(0.0));
+
+	const auto piOverN = static_cast<T>(pi) / static_cast<T>(numBands);
+
+	for (auto c = 0; c < numCoefficients; ++c)
+	{
+		for (auto b = 0; b < numBands; ++b)
+		{
+			const auto angle = static_cast<T>(piOverN * (static_cast<T>(b) + 0.5) * static_cast<T>(c));
+			dct[(c * paddedNumBands) + b] = static_cast<T>(2.0) * std::cos(angle);
+		}
+	}
+}
+
+//==============================================================================
+template<typename T>
+T MelTables<T>::frequencyToMel(T frequency)
+{
+	return static_cast<T>(1127.0 * std::log(1.0 + (frequency / 700.0)));
+}
+
+//==============================================================================
+template<typename T>
+std::mutex MelTableCache<T>::cacheLock;
+
+template<typename T>
+std::map<std::tuple<int, int, int>, std::weak_ptr<const MelTables<T>>> MelTableCache<T>::cache;
+
+//==============================================================================
+template<typename T>
+typename MelTableCache<T>::TablesPtr MelTableCache<T>::getTables(int frameSize, int sampleRate, int numBands)
+{
+	std::lock_guard<std::mutex> lock(cacheLock);
+
+	const auto key = std::make_tuple(frameSize, sampleRate, numBands);
+	auto tables = cache[key].lock();
+
+	if (tables == nullptr)
+	{
+		tables = std::make_shared<const MelTables<T>>(frameSize, sampleRate, numBands);
+		cache[key] = tables;
+	}
+
+	//Prune entries for tables no longer in use by any extractor.
+	for (auto it = cache.begin(); it != cache.end();)
+	{
+		if (it->second.expired())
+			it = cache.erase(it);
+		else
+			++it;
+	}
+
+	return tables;
+}
+
+//==============================================================================
+template<typename T>
+std::size_t MelTableCache<T>::getNumCachedTables()
+{
+	std::lock_guard<std::mutex> lock(cacheLock);
+
+	return cache.size();
+}
+
+//==============================================================================
+template struct MelTables<float>;
+template struct MelTables<double>;
+
+template class MelTableCache<float>;
+template class MelTableCache<double>;
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    MelTables.h
+    Created: 19 Oct 2026 1:15:52pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef MELTABLES_H_INCLUDED
+#define MELTABLES_H_INCLUDED
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <map>
+#include <tuple>
+
+#include "../Simd/AlignedAllocator.h"
+
+/** Immutable mel filterbank and DCT tables for one (frame size, sample rate, band count)
+ *  configuration. Instances are only created through MelTableCache and shared between every
+ *  FeatureExtractor (and plugin instance) using the same configuration.
+ *
+ *  The filterbank and DCT are built exactly as Gist builds them and the filterbank is applied to
+ *  the squared magnitude spectrum as Gist applies it, so MFCCs match data sets recorded with Gist.
+ *
+ *  Both matrices are cache line aligned and stored row major with zero padded rows so they can be
+ *  applied with the SimdKernels GEMV routines:
+ *  - filterBank is numBands x paddedSpectrumSize. The non zero range of each triangular filter is
+ *    recorded in filterStart / filterEnd (end exclusive) so the mel GEMV can skip the zero weights.
+ *  - dct is numCoefficients x paddedNumBands.
+ */
+template<typename T>
+struct MelTables
+{
+	int frameSize = 0;
+	int sampleRate = 0;
+	int numBands = 0;
+	int numCoefficients = 0;
+	int magnitudeSpectrumSize = 0;
+	int paddedSpectrumSize = 0;
+	int paddedNumBands = 0;
+
+	AlignedVector<T> filterBank;
+	std::vector<int> filterStart;
+	std::vector<int> filterEnd;
+
+	AlignedVector<T> dct;
+
+	MelTables(int initFrameSize, int initSampleRate, int initNumBands);
+
+	static T frequencyToMel(T frequency);
+};
+
+//==============================================================================
+/** Process wide cache of MelTables. Tables are reference counted - the cache only holds
+ *  weak references so tables are released once no extractor uses them.
+ *
+ *  Note: getTables() will build the tables on a cache miss. This allocates and takes a lock so it
+ *  must not be called from the audio thread. Acquire tables when the frame size or sample rate
+ *  changes and keep the returned pointer.
+ */
+template<typename T>
+class MelTableCache
+{
+public:
+	using TablesPtr = std::shared_ptr<const MelTables<T>>;
+
+	static TablesPtr getTables(int frameSize, int sampleRate, int numBands);
+
+	/** @return the number of table sets currently alive. */
+	static std::size_t getNumCachedTables();
+
+private:
+	using Key = std::tuple<int, int, int>;
+
+	static std::mutex cacheLock;
+	static std::map<Key, std::weak_ptr<const MelTables<T>>> cache;
+};
+
+
+#endif  // MELTABLES_H_INCLUDED
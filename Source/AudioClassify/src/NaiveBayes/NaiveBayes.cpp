@@ -1,6 +1,9 @@
 
 #include "NaiveBayes.h"
+#include "../Simd/SimdKernels.h"
 
+#include <algorithm>
+#include <cassert>
 #include <limits>
 
 //=======================================================================================================
@@ -24,68 +27,169 @@ NaiveBayes<T>::~NaiveBayes()
 template<typename T>
 void NaiveBayes<T>::Train(const arma::Mat<T>& trainingData, const arma::Row<int>& classLabels)
 {
+	//Single pass over the training data using the same running statistics as addInstance().
+	resetStatistics();
 
-	//Reset prob states
-	priorProbs.zeros();
-	featureMeans.zeros();
-	featureVariances.zeros();
-
-	//Mean sum. Sum the feature values for each class label instance
 	for (size_t j = 0; j < trainingData.n_cols; ++j)
+		accumulateInstance(trainingData.colptr(j), classLabels[j]);
+
+	updateModel();
+}
+
+//=======================================================================================================
+template<typename T>
+void NaiveBayes<T>::addInstance(const arma::Col<T>& instance, int classLabel)
+{
+	assert(instance.n_elem == numFeatures);
+	assert(classLabel >= 0 && static_cast<unsigned>(classLabel) < numClasses);
+
+	accumulateInstance(instance.memptr(), classLabel);
+}
+
+//=======================================================================================================
+template<typename T>
+void NaiveBayes<T>::resetClass(int classLabel)
+{
+	assert(classLabel >= 0 && static_cast<unsigned>(classLabel) < numClasses);
+
+	classCounts[classLabel] = 0;
+	featureMeans.col(classLabel).zeros();
+	featureSquaredDiffSums.col(classLabel).zeros();
+
+	modelUpToDate = false;
+}
+
+//=======================================================================================================
+template<typename T>
+void NaiveBayes<T>::updateModel()
+{
+	const auto totalCount = arma::accu(classCounts);
+
+	for (size_t j = 0; j < numClasses; ++j)
 	{
-		const auto label = classLabels[j];
+		const auto count = classCounts[j];
+
+		priorProbs[j] = (totalCount > 0) ? count / totalCount : static_cast<T>(0.0);
 
-		//Increment num occurences of current class in priorProbs set.
-		++priorProbs[label];
-		featureMeans.col(label) += trainingData.col(j);
+		//Sample variance. Zero variances are floored by prepareInferenceConstants().
+		const auto* squaredDiffSums = featureSquaredDiffSums.colptr(j);
+		auto* variances = featureVariances.colptr(j);
+
+		for (size_t i = 0; i < numFeatures; ++i)
+			variances[i] = (count > 1) ? squaredDiffSums[i] / (count - 1) : static_cast<T>(0.0);
 	}
 
-	//Normalise mean sums. Divide class feature sums by number of class occurences.
-	for (size_t i = 0; i < priorProbs.n_elem; ++i)
+	prepareInferenceConstants();
+
+	modelUpToDate = true;
+}
+
+//=======================================================================================================
+template<typename T>
+bool NaiveBayes<T>::isReady() const
+{
+	if (!modelUpToDate)
+		return false;
+
+	for (size_t j = 0; j < numClasses; ++j)
 	{
-		//Check if probability of each class != 0 due to no instance of class in training set.
-		//Avoids divide by zero errors.
-		if (priorProbs[i] != 0.0)
-			featureMeans.col(i) /= priorProbs[i]; //divide by total num class occurences.
+		if (classCounts[j] < minInstancesPerClass)
+			return false;
 	}
 
-	//Variances sum
-	for (size_t j = 0; j < trainingData.n_cols; ++j)
-	{
-		const auto label = classLabels[j];
+	return numClasses > 0;
+}
 
-		/**
-		 * Should be real-time safe with arma::square not malloc / dynamic allocating
-		 *  due to use of expression templates.
-		 */
-		featureVariances.col(label) += arma::square(trainingData.col(j) - featureMeans.col(label));
-	}
+//=======================================================================================================
+template<typename T>
+unsigned NaiveBayes<T>::getNumInstances(int classLabel) const
+{
+	return static_cast<unsigned>(classCounts[classLabel]);
+}
 
-	//Normalise variance sums
-	for (size_t i = 0; i < priorProbs.n_elem; ++i)
+//=======================================================================================================
+template<typename T>
+void NaiveBayes<T>::accumulateInstance(const T* instance, int classLabel)
+{
+	/** Welford's update. Keeps the running mean and sum of squared differences from the
+	 *  mean for the class, which avoids the cancellation of a naive sum of squares.
+	 */
+	const auto count = ++classCounts[classLabel];
+	const auto inverseCount = static_cast<T>(1.0) / count;
+
+	auto* means = featureMeans.colptr(classLabel);
+	auto* squaredDiffSums = featureSquaredDiffSums.colptr(classLabel);
+
+	for (size_t i = 0; i < numFeatures; ++i)
 	{
-		if (priorProbs[i] > 1)
-			featureVariances.col(i) /= (priorProbs[i] - 1);
+		const auto delta = instance[i] - means[i];
+		means[i] += delta * inverseCount;
+		squaredDiffSums[i] += delta * (instance[i] - means[i]);
 	}
 
-	/** Ensure that the featureVariances can be inverted. 
-	 *  The distribution calculation takes the standard deviation which 
-	 *  is equal to sqrt(featureVariances). The standard deviation is then inverted
-	 *  i.e. 1/stdDev or equivalently arma::pow(stdDev, -1). So this will cause a 
-	 *  divide by zero type error if any attribute variances are equal to 0.0
-	 *  The stdDev will then contain -inf or NaN values which causes calculation errors.
-	 *  Replace 0.0 variances with minimal floating point value.
+	modelUpToDate = false;
+}
+
+//=======================================================================================================
+template<typename T>
+void NaiveBayes<T>::resetStatistics()
+{
+	classCounts.zeros();
+	featureMeans.zeros();
+	featureSquaredDiffSums.zeros();
+
+	modelUpToDate = false;
+}
+
+//=======================================================================================================
+template<typename T>
+void NaiveBayes<T>::prepareInferenceConstants()
+{
+	const auto logSqrtTwoPi = std::log(sqrtTwoPi);
+
+	/** Expanding -(x - mean)^2 / (2 * var) cancels large terms against each other, so tiny variances
+	 *  are floored relative to the largest feature variance to keep the weights finite.
 	 */
-	
-	for (size_t i = 0; i < featureVariances.n_elem; ++i)
+	const auto varianceFloor = std::max(featureVariances.max() * static_cast<T>(1e-9), std::numeric_limits<T>::min());
+
+	//Centre each feature on the mean of its class means.
+	for (size_t i = 0; i < numFeatures; ++i)
 	{
-		if (featureVariances[i] == 0.0)
-			featureVariances[i] = std::numeric_limits<T>::min();
+		auto centre = static_cast<T>(0.0);
+
+		for (size_t j = 0; j < numClasses; ++j)
+			centre += featureMeans(i, j);
+
+		featureCentres[i] = centre / static_cast<T>(numClasses);
 	}
 
+	for (size_t j = 0; j < numClasses; ++j)
+	{
+		auto* squareWeights = classWeights.colptr(j);
+		auto* linearWeights = squareWeights + numFeatures;
+
+		auto bias = static_cast<T>(0.0);
+
+		for (size_t i = 0; i < numFeatures; ++i)
+		{
+			const auto variance = std::max(featureVariances(i, j), varianceFloor);
+			const auto halfInverseVariance = static_cast<T>(0.5) / variance;
+			const auto mean = featureMeans(i, j) - featureCentres[i];
 
-	//Normalise prior probabilities
-	priorProbs /= static_cast<T>(trainingData.n_cols);
+			//-(x - mean)^2 / (2 * var) == -x^2 / (2 * var) + x * mean / var - mean^2 / (2 * var)
+			squareWeights[i] = -halfInverseVariance;
+			linearWeights[i] = 2 * halfInverseVariance * mean;
+
+			//log(stdDev * sqrt(2 * pi)) == 0.5 * log(variance) + log(sqrt(2 * pi))
+			bias -= (halfInverseVariance * mean * mean) + (static_cast<T>(0.5) * std::log(variance)) + logSqrtTwoPi;
+		}
+
+		//Classes with no training instances can never be returned.
+		if (priorProbs[j] > 0.0)
+			classBias[j] = std::log(priorProbs[j]) + bias;
+		else
+			classBias[j] = -std::numeric_limits<T>::infinity();
+	}
 }
 
 //=======================================================================================================
@@ -93,53 +197,82 @@ void NaiveBayes<T>::Train(const arma::Mat<T>& trainingData, const arma::Row<int>
 template<typename T>
 int NaiveBayes<T>::Classify(const arma::Col<T>& instance)
 {
+	const auto* x = instance.memptr();
+	auto* augmented = augmentedInstance.memptr();
+
+	for (size_t i = 0; i < numFeatures; ++i)
+	{
+		const auto centred = x[i] - featureCentres[i];
+
+		augmented[i] = centred * centred;
+		augmented[numFeatures + i] = centred;
+	}
+
+	//One row of classWeights^T per class.
+	SimdKernels::gemv(classWeights.memptr(), classWeights.n_rows, augmented, testProbs.memptr(), numClasses, 2 * numFeatures);
+
 	auto classVal = -1;
+	auto maxProb = -std::numeric_limits<T>::infinity();
+
+	for (size_t j = 0; j < numClasses; ++j)
+	{
+		testProbs[j] += classBias[j];
 
-	//Calculate standard deviation
-    stdDev = arma::sqrt(featureVariances);
+		if (testProbs[j] > maxProb)
+		{
+			maxProb = testProbs[j];
+			classVal = static_cast<int>(j);
+		}
+	}
 
-	//Pre-Cook stdDev * sqrtTwoPi values for distribution calculation - Avoids uneccesary temporary - no malloc.
-	stdDev *= sqrtTwoPi;
-    stdDev = arma::pow(stdDev, -1);
-    
+	return classVal;
+}
 
-	for (size_t j = 0; j < featureMeans.n_cols; ++j)
+//=======================================================================================================
+template<typename T>
+void NaiveBayes<T>::Classify(const arma::Mat<T>& instances, arma::Row<int>& labels) const
+{
+	const auto numInstances = instances.n_cols;
+
+	arma::Mat<T> augmented(2 * numFeatures, numInstances);
+
+	for (size_t n = 0; n < numInstances; ++n)
 	{
-		/*
-		 * In the below code diffs, featureMeans,freatureVariances, 
-		 * distribution, exponents, stdDev, testProbs and priorProbs are all 
-		 * Armadillo based Matrix or Vector types which would otherwise need to be represented
-		 * by arrays or user defined classes.  
-		 */
-		diffs = instance - featureMeans.col(j);
-		
-		/** Using log probabilities to eliminate/reduce floating point
-		 *  erros when multiplication of small numbers/attributes exceeds representable min. 
-		 *  
-		 *  log(exp(value)) == value so the original calculation below has been
-		 *  altered when calculating normal/Gaussian distribution exponents. 
-		 *  
-		 *  Non log based Calculation:
-		 *		
-		 *		exponents = arma::exp(-(arma::square(diffs))) / (2 * featureVariances.col(j));
-		 *		
-		 *	We can use 2 * featureVariances in the calculation below rather than squaring the standard 
-		 *	deviation/stdDev values as per notation of guassian distribution in the literature - square(sqrt(value)) == value.
-		 */ 
-		exponents = arma::log(1 / arma::square(diffs)) - arma::log(2 * featureVariances.col(j));
-
-		//Calculate Normal/Gaussian distribution. 
-		distribution = exponents + arma::log(stdDev.col(j));
-
-		//Use sum of log values for test instance probablities rather than raw multiply (less risk of float errors).
-		testProbs(j) = std::log(priorProbs(j)) + arma::accu(distribution);
+		const auto* x = instances.colptr(n);
+		auto* column = augmented.colptr(n);
+
+		for (size_t i = 0; i < numFeatures; ++i)
+		{
+			const auto centred = x[i] - featureCentres[i];
+
+			column[i] = centred * centred;
+			column[numFeatures + i] = centred;
+		}
 	}
 
+	//numClasses x numInstances scores from a single GEMM.
+	const arma::Mat<T> scores = classWeights.t() * augmented;
 
-    //Class val is the label with the max prob value (Classes range 0 - numClasses hence index_max() used);
-	classVal = testProbs.index_max();
+	labels.set_size(numInstances);
 
-	return classVal;
+	for (size_t n = 0; n < numInstances; ++n)
+	{
+		auto classVal = -1;
+		auto maxProb = -std::numeric_limits<T>::infinity();
+
+		for (size_t j = 0; j < numClasses; ++j)
+		{
+			const auto prob = scores(j, n) + classBias[j];
+
+			if (prob > maxProb)
+			{
+				maxProb = prob;
+				classVal = static_cast<int>(j);
+			}
+		}
+
+		labels[n] = classVal;
+	}
 }
 
 //=======================================================================================================
@@ -155,12 +288,16 @@ template<typename T>
 void NaiveBayes<T>::initialise()
 {
 	priorProbs.zeros(numClasses);
+	classCounts.zeros(numClasses);
+	featureSquaredDiffSums.zeros(numFeatures, numClasses);
 	featureMeans.zeros(numFeatures, numClasses);
 	featureVariances.zeros(numFeatures, numClasses);
-	stdDev.zeros(numFeatures, numClasses);
-	exponents.zeros(numFeatures);
-	diffs.zeros(numFeatures);
-	distribution.zeros(numFeatures);
+	classWeights.zeros(2 * numFeatures, numClasses);
+	classBias.zeros(numClasses);
+	featureCentres.zeros(numFeatures);
+	augmentedInstance.zeros(2 * numFeatures);
+
+	modelUpToDate = false;
 	testProbs.zeros(numClasses);
 }
 
@@ -27,14 +27,45 @@ public:
 	NaiveBayes(const size_t numClasses, const size_t initNumFeatures);
 	~NaiveBayes();
 
+	/** Rebuilds the model from scratch in a single pass over newTrainingData. */
 	void Train(const arma::Mat<T>& newTrainingData, const arma::Row<int>& labels);
 
+	/** Adds one training instance to the running (Welford) class statistics. This is O(numFeatures),
+	 *  does not allocate and can be called from the audio thread as instances are recorded.
+	 *  The classification constants are not rebuilt until updateModel() is called.
+	 */
+	void addInstance(const arma::Col<T>& instance, int classLabel);
+
+	/** Discards the running statistics of a class, e.g. before it is re-recorded. */
+	void resetClass(int classLabel);
+
+	/** Rebuilds the priors, variances and classification constants from the running statistics.
+	 *  Cost depends only on numClasses * numFeatures, not on the number of instances added.
+	 */
+	void updateModel();
+
+	/** @return true if the model is up to date and every class has at least minInstancesPerClass instances. */
+	bool isReady() const;
+
+	/** @return the number of instances added for classLabel. */
+	unsigned getNumInstances(int classLabel) const;
+
+	//Instances per class needed for a sample variance.
+	static const unsigned minInstancesPerClass = 2;
+
 
 	/** Classifies a single instance and returns the label with the highest probability value.	
+	 *  This uses the inference constants prepared by Train() and does not allocate.
 	 * @param instance The instance to be classified (passed as single column/vector)
 	*/
 	int Classify(const arma::Col<T>& instance);
 
+	/** Classifies every column of instances with a single matrix product against the class weights.
+	 * @param instances the instances to be classified, one per column.
+	 * @param labels receives the label with the highest probability value for each column (or -1).
+	 */
+	void Classify(const arma::Mat<T>& instances, arma::Row<int>& labels) const;
+
 	/** Sets the number of features/attributes to be used per training/classifiable instance.
 	 * @param newNumFeatures the new number of features per instance. 
 	 */
@@ -53,25 +84,39 @@ private:
 	arma::Mat<T> featureMeans;
 	arma::Mat<T> featureVariances;
 
-	//Matrix for standardDeviation values per feature / per class.
-	arma::Mat<T> stdDev;
-	
-	//Vector for exponents per class used in Gaussian distribution calculation.
-	arma::Col<T> exponents;
-
-	//Vector for instance - feature means differences per class.
-	arma::Col<T> diffs;
-
-	//Vector for Gaussian distribution of features per class.
-	arma::Col<T> distribution;
+	//Running Welford statistics. Sum of squared differences from the running mean and instance count per class.
+	arma::Mat<T> featureSquaredDiffSums;
+	arma::Col<T> classCounts;
 
 	//Class prior probabilities.	
 	arma::Col<T> priorProbs;
 
+	bool modelUpToDate = false;
+
+	/** Inference constants baked by Train(). The Gaussian log likelihood is expanded into a quadratic
+	 *  form so all class scores come out of a single matrix vector product:
+	 *
+	 *		log p(x | j) + log p(j) = classBias(j) + dot(classWeights.col(j), [square(x - c), x - c])
+	 *
+	 *  classWeights is the (numClasses x 2 * numFeatures) weight matrix stored transposed, so the
+	 *  weights of each class are contiguous. Features are centred on c (featureCentres) first which
+	 *  keeps the expanded squares close in magnitude to the original (x - mean)^2 terms.
+	 */
+	arma::Mat<T> classWeights;
+	arma::Col<T> classBias;
+	arma::Col<T> featureCentres;
+
+	//Preallocated [square(x - c), x - c] vector for single instance classification.
+	arma::Col<T> augmentedInstance;
+
 	//Vector placeholder for final prob values for each class. 
 	arma::Col<T> testProbs;
 
 	void initialise();
+	void prepareInferenceConstants();
+
+	void accumulateInstance(const T* instance, int classLabel);
+	void resetStatistics();
 };
 
 #endif  // NAIVEBAYES_H_INCLUDED
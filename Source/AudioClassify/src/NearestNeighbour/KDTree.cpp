@@ -0,0 +1,223 @@
+/*
+  ==============================================================================
+
+    KDTree.cpp
+    Created: 19 Oct 2026 5:12:40pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "KDTree.h"
+#include "NeighbourHeap.h"
+#include "../Simd/SimdKernels.h"
+
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cassert>
+
+//=======================================================================================================
+template<typename T>
+KDTree<T>::KDTree()
+{
+}
+
+//=======================================================================================================
+template<typename T>
+KDTree<T>::~KDTree()
+{
+}
+
+//=======================================================================================================
+template<typename T>
+void KDTree<T>::build(const arma::Mat<T>& points)
+{
+	clear();
+
+	numFeatures = points.n_rows;
+
+	const auto numPoints = static_cast<std::size_t>(points.n_cols);
+
+	if (numPoints == 0)
+		return;
+
+	pointIndices.resize(numPoints);
+	std::iota(pointIndices.begin(), pointIndices.end(), 0);
+
+	nodes.reserve(2 * ((numPoints / leafSize) + 1));
+
+	std::size_t maxDepth = 0;
+	buildNode(points, 0, numPoints, 0, maxDepth);
+
+	//At most one deferred far child per level is on the stack at once.
+	stack.resize(maxDepth + 1);
+
+	leafPoints.set_size(numFeatures, numPoints);
+
+	for (std::size_t i = 0; i < numPoints; ++i)
+		std::copy(points.colptr(pointIndices[i]), points.colptr(pointIndices[i]) + numFeatures, leafPoints.colptr(i));
+}
+
+//=======================================================================================================
+template<typename T>
+std::size_t KDTree<T>::buildNode(const arma::Mat<T>& points, std::size_t begin, std::size_t end, std::size_t depth, std::size_t& maxDepth)
+{
+	maxDepth = std::max(maxDepth, depth);
+
+	const auto nodeIndex = nodes.size();
+	nodes.push_back({ -1, static_cast<T>(0.0), 0, 0, begin, end });
+
+	if (end - begin <= leafSize)
+		return nodeIndex;
+
+	//Split on the dimension with the largest spread.
+	auto splitDimension = 0;
+	auto largestSpread = static_cast<T>(-1.0);
+
+	for (std::size_t d = 0; d < numFeatures; ++d)
+	{
+		auto min = std::numeric_limits<T>::max();
+		auto max = std::numeric_limits<T>::lowest();
+
+		for (auto i = begin; i < end; ++i)
+		{
+			const auto value = points(d, pointIndices[i]);
+			min = std::min(min, value);
+			max = std::max(max, value);
+		}
+
+		if (max - min > largestSpread)
+		{
+			largestSpread = max - min;
+			splitDimension = static_cast<int>(d);
+		}
+	}
+
+	//All points identical, nothing to split.
+	if (largestSpread <= static_cast<T>(0.0))
+		return nodeIndex;
+
+	const auto middle = begin + ((end - begin) / 2);
+
+	std::nth_element(pointIndices.begin() + begin, pointIndices.begin() + middle, pointIndices.begin() + end,
+		[&points, splitDimension](std::size_t a, std::size_t b) { return points(splitDimension, a) < points(splitDimension, b); });
+
+	const auto splitValue = points(splitDimension, pointIndices[middle]);
+
+	const auto left = buildNode(points, begin, middle, depth + 1, maxDepth);
+	const auto right = buildNode(points, middle, end, depth + 1, maxDepth);
+
+	auto& node = nodes[nodeIndex];
+	node.splitDimension = splitDimension;
+	node.splitValue = splitValue;
+	node.left = left;
+	node.right = right;
+
+	return nodeIndex;
+}
+
+//=======================================================================================================
+template<typename T>
+std::size_t KDTree<T>::search(const T* query, std::size_t k, std::size_t* indices, T* squaredDistances)
+{
+	k = std::min(k, getNumPoints());
+
+	if (k == 0)
+		return 0;
+
+	//indices / squaredDistances hold a max heap on distance of the best k found so far.
+	std::size_t numFound = 0;
+	auto bound = std::numeric_limits<T>::infinity();
+
+	std::size_t stackSize = 0;
+	stack[stackSize++] = { 0, static_cast<T>(0.0) };
+
+	while (stackSize > 0)
+	{
+		const auto entry = stack[--stackSize];
+
+		if (entry.lowerBound >= bound)
+			continue;
+
+		auto nodeIndex = entry.node;
+
+		//Descend to the leaf on the query side, deferring the far children.
+		while (nodes[nodeIndex].splitDimension >= 0)
+		{
+			const auto& node = nodes[nodeIndex];
+			const auto diff = query[node.splitDimension] - node.splitValue;
+
+			const auto nearChild = (diff < static_cast<T>(0.0)) ? node.left : node.right;
+			const auto farChild = (diff < static_cast<T>(0.0)) ? node.right : node.left;
+
+			const auto farBound = std::max(entry.lowerBound, diff * diff);
+
+			if (farBound < bound)
+			{
+				assert(stackSize < stack.size());
+				stack[stackSize++] = { farChild, farBound };
+			}
+
+			nodeIndex = nearChild;
+		}
+
+		const auto& leaf = nodes[nodeIndex];
+
+		for (auto i = leaf.begin; i < leaf.end; ++i)
+		{
+			if (numFound < k)
+			{
+				const auto distance = SimdKernels::squaredDistance(query, leafPoints.colptr(i), numFeatures);
+
+				NeighbourHeap::push(indices, squaredDistances, numFound++, pointIndices[i], distance);
+
+				if (numFound == k)
+					bound = squaredDistances[0];
+			}
+			else
+			{
+				const auto distance = SimdKernels::squaredDistanceBounded(query, leafPoints.colptr(i), numFeatures, bound);
+
+				if (distance < bound)
+				{
+					NeighbourHeap::replaceTop(indices, squaredDistances, k, pointIndices[i], distance);
+					bound = squaredDistances[0];
+				}
+			}
+		}
+	}
+
+	NeighbourHeap::sortAscending(indices, squaredDistances, numFound);
+
+	return numFound;
+}
+
+//=======================================================================================================
+template<typename T>
+std::size_t KDTree<T>::getNumPoints() const
+{
+	return pointIndices.size();
+}
+
+//=======================================================================================================
+template<typename T>
+std::size_t KDTree<T>::getNumFeatures() const
+{
+	return numFeatures;
+}
+
+//=======================================================================================================
+template<typename T>
+void KDTree<T>::clear()
+{
+	nodes.clear();
+	stack.clear();
+	pointIndices.clear();
+	leafPoints.reset();
+	numFeatures = 0;
+}
+
+//=======================================================================================================
+template class KDTree<float>;
+template class KDTree<double>;
@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    KDTree.h
+    Created: 19 Oct 2026 5:12:40pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef KDTREE_H_INCLUDED
+#define KDTREE_H_INCLUDED
+
+#ifdef _WIN64
+#define ARMA_64BIT_WORD
+#endif
+
+#include <vector>
+#include <cstddef>
+
+#include <armadillo.h>
+
+/** KD-tree index over the columns of a feature matrix for exact k nearest neighbour search
+ *  by squared euclidean distance.
+ *
+ *  Each node splits on the dimension with the largest spread at the median, down to leaf
+ *  buckets of at most leafSize points. The points are copied in leaf order so each bucket is
+ *  one contiguous block of columns.
+ *
+ *  Note: build() allocates and should be called off the audio thread. search() does not
+ *  allocate. Its traversal stack is sized by build() and the results go into caller buffers.
+ */
+template<typename T>
+class KDTree
+{
+public:
+	KDTree();
+	~KDTree();
+
+	/** Builds the tree over the columns of points (numFeatures x numPoints). */
+	void build(const arma::Mat<T>& points);
+
+	/** Finds the k nearest columns to query in ascending order of distance.
+	 * @param query numFeatures values.
+	 * @param k the number of neighbours to find.
+	 * @param indices receives the column indices (in the matrix passed to build()) of at least k elements.
+	 * @param squaredDistances receives the squared distances of at least k elements.
+	 * @return the number of neighbours found, min(k, getNumPoints()).
+	 */
+	std::size_t search(const T* query, std::size_t k, std::size_t* indices, T* squaredDistances);
+
+	std::size_t getNumPoints() const;
+	std::size_t getNumFeatures() const;
+
+	void clear();
+
+	static const std::size_t leafSize = 8;
+
+private:
+	struct Node
+	{
+		//-1 for leaves.
+		int splitDimension;
+		T splitValue;
+
+		//Children for internal nodes. Leaves hold points [begin, end) of leafPoints.
+		std::size_t left;
+		std::size_t right;
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	struct StackEntry
+	{
+		std::size_t node;
+		T lowerBound;
+	};
+
+	std::vector<Node> nodes;
+	std::vector<StackEntry> stack;
+
+	//Points copied in leaf order and the original column index of each.
+	arma::Mat<T> leafPoints;
+	std::vector<std::size_t> pointIndices;
+
+	std::size_t numFeatures = 0;
+
+	std::size_t buildNode(const arma::Mat<T>& points, std::size_t begin, std::size_t end, std::size_t depth, std::size_t& maxDepth);
+};
+
+
+#endif  // KDTREE_H_INCLUDED
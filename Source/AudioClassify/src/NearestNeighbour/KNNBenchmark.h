@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    KNNBenchmark.h
+    Created: 19 Oct 2026 5:48:02pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef KNNBENCHMARK_H_INCLUDED
+#define KNNBENCHMARK_H_INCLUDED
+
+#include <vector>
+#include <chrono>
+#include <random>
+
+#include "NearestNeighbour.h"
+
+/** Micro benchmarks comparing the NearestNeighbour search types. Each search type is timed
+ *  on the same clustered random training set so the crossover point between brute force and
+ *  the KD-tree can be found for a given feature count and training set size.
+ *
+ *  Note: These functions allocate and block for the duration of the benchmark. Do not call
+ *  from the audio thread.
+ */
+namespace KNNBenchmark
+{
+	struct Result
+	{
+		AudioClassifyOptions::KNNSearchType searchType;
+		int numFeatures;
+		int numTrainingInstances;
+		double microsecondsPerQuery;
+	};
+
+	//===============================================================================
+	/** Times classify() for one search type on a training set of numClasses Gaussian clusters.
+	 * @return the mean time in microseconds per classified instance.
+	 */
+	template<typename T>
+	double timeSearch(AudioClassifyOptions::KNNSearchType searchType, int numFeatures, int numClasses, int instancesPerClass,
+					  int numNeighbours, int numQueries)
+	{
+		std::mt19937 randomEngine(1234);
+		std::normal_distribution<double> spread(0.0, 1.0);
+		std::uniform_real_distribution<double> centres(-10.0, 10.0);
+
+		arma::Mat<T> classCentres(numFeatures, numClasses);
+
+		for (std::size_t i = 0; i < classCentres.n_elem; ++i)
+			classCentres[i] = static_cast<T>(centres(randomEngine));
+
+		const auto numInstances = numClasses * instancesPerClass;
+
+		arma::Mat<T> trainingSet(numFeatures, numInstances);
+		arma::Row<int> labels(numInstances);
+
+		for (auto j = 0; j < numInstances; ++j)
+		{
+			labels[j] = j / instancesPerClass;
+
+			for (auto i = 0; i < numFeatures; ++i)
+				trainingSet(i, j) = classCentres(i, labels[j]) + static_cast<T>(spread(randomEngine));
+		}
+
+		arma::Mat<T> queries(numFeatures, numQueries);
+
+		for (auto j = 0; j < numQueries; ++j)
+		{
+			const auto label = j % numClasses;
+
+			for (auto i = 0; i < numFeatures; ++i)
+				queries(i, j) = classCentres(i, label) + static_cast<T>(spread(randomEngine));
+		}
+
+		NearestNeighbour<T> knn(numFeatures, numClasses, instancesPerClass);
+		knn.setNumNeighbours(numNeighbours);
+		knn.setSearchType(searchType);
+		knn.train(trainingSet, labels);
+
+		//classify() takes an arma::Col so each query is copied into this first.
+		arma::Col<T> instance(numFeatures);
+		auto checksum = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (auto j = 0; j < numQueries; ++j)
+		{
+			std::copy(queries.colptr(j), queries.colptr(j) + numFeatures, instance.memptr());
+			checksum += knn.classify(instance);
+		}
+
+		const auto end = std::chrono::steady_clock::now();
+		const std::chrono::duration<double, std::micro> elapsed = end - start;
+
+		//Keep the classifications observable so they are not optimised away.
+		if (checksum < 0)
+			return -1.0;
+
+		return elapsed.count() / static_cast<double>(numQueries);
+	}
+
+	//===============================================================================
+	/** Times every search type for each combination of feature count and instances per class.
+	 *  The defaults cover a variance reduced feature set, the base features and the base
+	 *  features with deltas and delta-deltas.
+	 */
+	template<typename T>
+	std::vector<Result> run(const std::vector<int>& featureCounts = { 8, 21, 63 },
+							const std::vector<int>& instancesPerClassCounts = { 20, 100, 500 },
+							int numClasses = 8, int numNeighbours = 5, int numQueries = 1000)
+	{
+		std::vector<Result> results;
+
+		const AudioClassifyOptions::KNNSearchType searchTypes[] = { AudioClassifyOptions::KNNSearchType::bruteForce,
+																	 AudioClassifyOptions::KNNSearchType::kdTree };
+
+		for (auto numFeatures : featureCounts)
+		{
+			for (auto instancesPerClass : instancesPerClassCounts)
+			{
+				for (auto searchType : searchTypes)
+				{
+					auto time = timeSearch<T>(searchType, numFeatures, numClasses, instancesPerClass, numNeighbours, numQueries);
+					results.push_back({ searchType, numFeatures, numClasses * instancesPerClass, time });
+				}
+			}
+		}
+
+		return results;
+	}
+}
+
+
+#endif  // KNNBENCHMARK_H_INCLUDED
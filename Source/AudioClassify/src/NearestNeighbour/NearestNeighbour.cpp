@@ -12,14 +12,28 @@
 #include <algorithm>
 
 #include "NearestNeighbour.h"
+#include "NeighbourHeap.h"
+#include "../Simd/SimdKernels.h"
+#include "../Simd/QuantisedKernels.h"
 
 
 //=======================================================================================================
 template<typename T>
 NearestNeighbour<T>::NearestNeighbour(unsigned int initNumFeatures, unsigned int initNumClasses, std::size_t initNumInstances)
-	: trainingSet(initNumFeatures, (initNumInstances * initNumClasses), arma::fill::zeros),
+	: numNeighbours(5),
+	  trainingSet(initNumFeatures, (initNumInstances * initNumClasses), arma::fill::zeros),
 	  labels(initNumInstances * initNumClasses, arma::fill::zeros),
-	  squaredDistances(initNumFeatures, arma::fill::zeros)
+	  paddedNumFeatures(0),
+	  searchType(AudioClassifyOptions::KNNSearchType::bruteForce),
+	  trained(false),
+	  prototypeBudget(0),
+	  neighbourIndices(maxNumNeighbours, 0),
+	  neighbourDistances(maxNumNeighbours, static_cast<T>(0.0)),
+	  quantisation(AudioClassifyOptions::KNNQuantisation::none),
+	  quantisationScale(static_cast<T>(1.0)),
+	  quantisedNumFeatures(0),
+	  candidateIndices(maxNumNeighbours * rerankCandidatesPerNeighbour, 0),
+	  candidateDistances(maxNumNeighbours * rerankCandidatesPerNeighbour, 0)
 {
 	numClasses = initNumClasses;
 	trainingSetSize = initNumInstances * initNumClasses;
@@ -30,11 +44,7 @@ NearestNeighbour<T>::NearestNeighbour(unsigned int initNumFeatures, unsigned int
 	neighbourClassCounts = std::make_unique<size_t[]>(numClasses);
 	std::fill(neighbourClassCounts.get(), neighbourClassCounts.get() + numClasses, 0);
 
-	auto neighboursSize = trainingSetSize;
-	neighbours = std::make_unique<Neighbour[]>(neighboursSize);
-
-	//Set default K nearest neighbours
-	setNumNeighbours(5);
+	updatePaddedTrainingSet();
 }
 
 //=======================================================================================================
@@ -48,49 +58,201 @@ NearestNeighbour<T>::~NearestNeighbour()
 template<typename T>
 int NearestNeighbour<T>::classify(arma::Col<T>& instance)
 {
-	//Normalise instance values to 0 - 1 for distance calculation
-	PreProcessing::normalise(instance);
-
 	//Reset the counts for class occurrences in the k nearest neighbours collection
 	std::fill(neighbourClassCounts.get(), neighbourClassCounts.get() + numClasses, 0);
 
-	for (std::size_t i = 0; i < trainingSet.n_cols; ++i)
+	std::size_t numFound = 0;
+	const std::size_t k = numNeighbours.load();
+
+	//Neighbours are ranked by squared distance which gives the same order as the euclidean distance.
+	if (searchType == AudioClassifyOptions::KNNSearchType::kdTree && tree.getNumPoints() > 0)
+		numFound = tree.search(instance.memptr(), k, neighbourIndices.data(), neighbourDistances.data());
+	else if (quantisation == AudioClassifyOptions::KNNQuantisation::int16 && !quantisedTrainingSet16.empty())
+		numFound = searchQuantised(instance.memptr(), k, quantisedTrainingSet16, quantisedInstance16, QuantisedKernels::maxInt16Value);
+	else if (quantisation == AudioClassifyOptions::KNNQuantisation::int8 && !quantisedTrainingSet8.empty())
+		numFound = searchQuantised(instance.memptr(), k, quantisedTrainingSet8, quantisedInstance8, QuantisedKernels::maxInt8Value);
+	else
+		numFound = searchBruteForce(instance.memptr(), k);
+
+	for (std::size_t i = 0; i < numFound; ++i)
+		++neighbourClassCounts[labels[neighbourIndices[i]]];
+	
+	auto max = std::max_element(neighbourClassCounts.get(), neighbourClassCounts.get() + numClasses);
+	auto label = std::distance(neighbourClassCounts.get(), max);
+
+	return label;
+}
+
+//=======================================================================================================
+template<typename T>
+void NearestNeighbour<T>::classify(const arma::Mat<T>& instances, arma::Row<int>& labelsOut) const
+{
+	const auto numInstancesToClassify = static_cast<std::size_t>(instances.n_cols);
+	const auto numTrainingInstances = static_cast<std::size_t>(trainingSet.n_cols);
+
+	labelsOut.set_size(numInstancesToClassify);
+
+	const auto k = std::min(static_cast<std::size_t>(numNeighbours), numTrainingInstances);
+
+	std::vector<std::size_t> indices(k);
+	std::vector<T> distances(k);
+	std::vector<std::size_t> classCounts(numClasses);
+
+	for (std::size_t blockBegin = 0; blockBegin < numInstancesToClassify; blockBegin += batchBlockSize)
 	{
-		T distance = euclideanDistance(instance, trainingSet.col(i));
+		const auto blockEnd = std::min(blockBegin + batchBlockSize, numInstancesToClassify);
+
+		//numTrainingInstances x block size dot products from a single GEMM.
+		const arma::Mat<T> crossProducts = trainingSet.t() * instances.cols(blockBegin, blockEnd - 1);
+
+		for (auto j = blockBegin; j < blockEnd; ++j)
+		{
+			const auto* instance = instances.colptr(j);
+			const auto* cross = crossProducts.colptr(j - blockBegin);
+			const auto instanceSquaredNorm = SimdKernels::dotProduct(instance, instance, numFeatures);
 
-		//Get the class label for the current training instance
-		const auto classLabel = labels[i];
-		
-		neighbours[i].label = classLabel;
-		neighbours[i].distance = distance;
+			std::size_t numFound = 0;
+
+			for (std::size_t i = 0; i < numTrainingInstances; ++i)
+			{
+				const auto distance = trainingSquaredNorms[i] + instanceSquaredNorm - (static_cast<T>(2.0) * cross[i]);
+
+				if (numFound < k)
+					NeighbourHeap::push(indices.data(), distances.data(), numFound++, i, distance);
+				else if (distance < distances[0])
+					NeighbourHeap::replaceTop(indices.data(), distances.data(), k, i, distance);
+			}
+
+			std::fill(classCounts.begin(), classCounts.end(), 0);
+
+			for (std::size_t i = 0; i < numFound; ++i)
+				++classCounts[labels[indices[i]]];
+
+			const auto max = std::max_element(classCounts.begin(), classCounts.end());
+			labelsOut[j] = static_cast<int>(std::distance(classCounts.begin(), max));
+		}
 	}
+}
+
+//=======================================================================================================
+template<typename T>
+std::size_t NearestNeighbour<T>::searchBruteForce(const T* instance, std::size_t k)
+{
+	const auto numTrainingInstances = paddedNumFeatures > 0 ? paddedTrainingSet.size() / paddedNumFeatures : 0;
+
+	k = std::min(k, numTrainingInstances);
+
+	if (k == 0)
+		return 0;
+
+	//Zero padded copy so the instance lines up with the padded training instances.
+	std::copy(instance, instance + numFeatures, paddedInstance.data());
+
+	auto* indices = neighbourIndices.data();
+	auto* distances = neighbourDistances.data();
 
-	std::nth_element(neighbours.get(), neighbours.get() + numNeighbours, neighbours.get() + trainingSetSize);
+	const auto* query = paddedInstance.data();
+	const auto* reference = paddedTrainingSet.data();
 
-	for (auto i = 0; i < numNeighbours; ++i)
+	//Fill the heap with the first k instances, then only keep instances closer than the current k-th best.
+	for (std::size_t i = 0; i < k; ++i)
+		NeighbourHeap::push(indices, distances, i, i, SimdKernels::squaredDistance(query, reference + (i * paddedNumFeatures), paddedNumFeatures));
+
+	for (std::size_t i = k; i < numTrainingInstances; ++i)
 	{
-		const auto classLabel = neighbours[i].label;
-		++neighbourClassCounts[classLabel];
+		const auto bound = distances[0];
+		const auto distance = SimdKernels::squaredDistanceBounded(query, reference + (i * paddedNumFeatures), paddedNumFeatures, bound);
+
+		if (distance < bound)
+			NeighbourHeap::replaceTop(indices, distances, k, i, distance);
 	}
-	
-	auto max = std::max_element(neighbourClassCounts.get(), neighbourClassCounts.get() + numClasses);
-	auto label = std::distance(neighbourClassCounts.get(), max);
 
-	return label;
+	return k;
+}
+
+//=======================================================================================================
+template<typename T>
+template<typename Q>
+std::size_t NearestNeighbour<T>::searchQuantised(const T* instance, std::size_t k, const AlignedVector<Q>& quantisedSet,
+												  AlignedVector<Q>& quantisedInstance, int maxValue)
+{
+	const auto numTrainingInstances = quantisedSet.size() / quantisedNumFeatures;
+
+	k = std::min(k, numTrainingInstances);
+
+	if (k == 0)
+		return 0;
+
+	quantise(instance, quantisedInstance.data(), maxValue);
+
+	const auto numCandidates = std::min(k * rerankCandidatesPerNeighbour, numTrainingInstances);
+
+	auto* candidates = candidateIndices.data();
+	auto* candidateDists = candidateDistances.data();
+
+	const auto* query = quantisedInstance.data();
+	const auto* reference = quantisedSet.data();
+
+	//Integer scan of the whole training set, keeping the closest numCandidates.
+	for (std::size_t i = 0; i < numCandidates; ++i)
+		NeighbourHeap::push(candidates, candidateDists, i, i, QuantisedKernels::squaredDistance(query, reference + (i * quantisedNumFeatures), quantisedNumFeatures));
+
+	for (std::size_t i = numCandidates; i < numTrainingInstances; ++i)
+	{
+		const auto distance = QuantisedKernels::squaredDistance(query, reference + (i * quantisedNumFeatures), quantisedNumFeatures);
+
+		if (distance < candidateDists[0])
+			NeighbourHeap::replaceTop(candidates, candidateDists, numCandidates, i, distance);
+	}
+
+	//Full precision rerank of the candidates.
+	std::copy(instance, instance + numFeatures, paddedInstance.data());
+
+	auto* indices = neighbourIndices.data();
+	auto* distances = neighbourDistances.data();
+
+	for (std::size_t c = 0; c < numCandidates; ++c)
+	{
+		const auto index = candidates[c];
+		const auto distance = SimdKernels::squaredDistance(paddedInstance.data(), paddedTrainingSet.data() + (index * paddedNumFeatures), paddedNumFeatures);
+
+		if (c < k)
+			NeighbourHeap::push(indices, distances, c, index, distance);
+		else if (distance < distances[0])
+			NeighbourHeap::replaceTop(indices, distances, k, index, distance);
+	}
+
+	return k;
+}
+
+//=======================================================================================================
+template<typename T>
+template<typename Q>
+void NearestNeighbour<T>::quantise(const T* values, Q* quantised, int maxValue) const
+{
+	const auto maxQuantised = static_cast<T>(maxValue);
+
+	//Values outside the training range are clamped. The rerank corrects the ordering of close candidates.
+	for (std::size_t i = 0; i < numFeatures; ++i)
+	{
+		const auto value = std::round((values[i] - quantisationOffsets[i]) * quantisationScale);
+		quantised[i] = static_cast<Q>(std::max(-maxQuantised, std::min(maxQuantised, value)));
+	}
 }
 
 //=======================================================================================================
 template<typename T>
 void NearestNeighbour<T>::setNumNeighbours(const unsigned int newNumNeighbours)
 {
-	numNeighbours = newNumNeighbours;
+	//The search buffers are never resized, so K only has to be published.
+	numNeighbours.store(std::max(1u, std::min(newNumNeighbours, maxNumNeighbours)));
 }
 
 //=======================================================================================================
 template<typename T>
 int NearestNeighbour<T>::getNumNeighbours()
 {
-	return numNeighbours;
+	return numNeighbours.load();
 }
 
 //=======================================================================================================
@@ -101,9 +263,6 @@ void NearestNeighbour<T>::setTrainingInstancesPerClass(const unsigned int newNum
 
 	trainingSetSize = numInstances * numClasses;
 
-	auto neighboursSize = trainingSetSize;
-	neighbours.reset(new Neighbour[neighboursSize]);
-
 	configureTrainingSetMatrix();
 }
 
@@ -119,23 +278,156 @@ void NearestNeighbour<T>::setNumFeatures(const unsigned int newNumFeatures)
 template<typename T>
 void NearestNeighbour<T>::train(const arma::Mat<T>& newTrainingSet, const arma::Row<int>& newLabels)
 {
-	trainingSet = newTrainingSet;
-	labels = newLabels;
+	if (prototypeBudget > 0 && newTrainingSet.n_cols > prototypeBudget)
+	{
+		condenser.condense(newTrainingSet, newLabels, numClasses, prototypeBudget, trainingSet, labels);
+	}
+	else
+	{
+		trainingSet = newTrainingSet;
+		labels = newLabels;
+	}
+
+	updatePaddedTrainingSet();
+	updateQuantisedTrainingSet();
+
+	trained = true;
+
+	if (searchType == AudioClassifyOptions::KNNSearchType::kdTree)
+		tree.build(trainingSet);
+	else
+		tree.clear();
+}
+
+//=======================================================================================================
+template<typename T>
+void NearestNeighbour<T>::setPrototypeBudget(std::size_t newPrototypeBudget)
+{
+	prototypeBudget = newPrototypeBudget;
+}
 
-	//Normalise trainingSet values to 0 - 1 for distance calculation
-	PreProcessing::normalise(trainingSet);
+//=======================================================================================================
+template<typename T>
+std::size_t NearestNeighbour<T>::getPrototypeBudget() const
+{
+	return prototypeBudget;
 }
 
 //=======================================================================================================
 template<typename T>
-T NearestNeighbour<T>::euclideanDistance(const arma::Col<T>& testInstance, const arma::Col<T>& referenceInstance)
+std::size_t NearestNeighbour<T>::getNumStoredInstances() const
 {
-	T distance = static_cast<T>(0.0);
-	
-	squaredDistances = arma::square((testInstance - referenceInstance));
-	distance = std::sqrt(arma::accu(squaredDistances));
+	return trained ? static_cast<std::size_t>(trainingSet.n_cols) : 0;
+}
+
+//=======================================================================================================
+template<typename T>
+void NearestNeighbour<T>::setSearchType(AudioClassifyOptions::KNNSearchType newSearchType)
+{
+	if (newSearchType == AudioClassifyOptions::KNNSearchType::kdTree && trained)
+		tree.build(trainingSet);
+
+	searchType = newSearchType;
+
+	if (searchType == AudioClassifyOptions::KNNSearchType::bruteForce)
+		tree.clear();
+}
+
+//=======================================================================================================
+template<typename T>
+AudioClassifyOptions::KNNSearchType NearestNeighbour<T>::getSearchType() const
+{
+	return searchType;
+}
+
+//=======================================================================================================
+template<typename T>
+void NearestNeighbour<T>::updatePaddedTrainingSet()
+{
+	paddedNumFeatures = getSimdPaddedSize(numFeatures);
+
+	paddedTrainingSet.assign(paddedNumFeatures * trainingSet.n_cols, static_cast<T>(0.0));
+	paddedInstance.assign(paddedNumFeatures, static_cast<T>(0.0));
+
+	trainingSquaredNorms.set_size(trainingSet.n_cols);
+
+	for (std::size_t i = 0; i < trainingSet.n_cols; ++i)
+	{
+		std::copy(trainingSet.colptr(i), trainingSet.colptr(i) + numFeatures, paddedTrainingSet.data() + (i * paddedNumFeatures));
+		trainingSquaredNorms[i] = SimdKernels::dotProduct(trainingSet.colptr(i), trainingSet.colptr(i), numFeatures);
+	}
+}
+
+//=======================================================================================================
+template<typename T>
+void NearestNeighbour<T>::setQuantisation(AudioClassifyOptions::KNNQuantisation newQuantisation)
+{
+	quantisation = newQuantisation;
+	updateQuantisedTrainingSet();
+}
 
-	return distance;
+//=======================================================================================================
+template<typename T>
+AudioClassifyOptions::KNNQuantisation NearestNeighbour<T>::getQuantisation() const
+{
+	return quantisation;
+}
+
+//=======================================================================================================
+template<typename T>
+void NearestNeighbour<T>::updateQuantisedTrainingSet()
+{
+	quantisedTrainingSet16.clear();
+	quantisedTrainingSet8.clear();
+
+	const auto numTrainingInstances = static_cast<std::size_t>(trainingSet.n_cols);
+
+	if (quantisation == AudioClassifyOptions::KNNQuantisation::none || !trained || numTrainingInstances == 0)
+		return;
+
+	//Centre each feature's range on zero and share the scale that fits the widest range.
+	quantisationOffsets.assign(numFeatures, static_cast<T>(0.0));
+	auto maxHalfRange = static_cast<T>(0.0);
+
+	for (std::size_t i = 0; i < numFeatures; ++i)
+	{
+		auto min = trainingSet(i, 0);
+		auto max = trainingSet(i, 0);
+
+		for (std::size_t j = 1; j < numTrainingInstances; ++j)
+		{
+			min = std::min(min, trainingSet(i, j));
+			max = std::max(max, trainingSet(i, j));
+		}
+
+		quantisationOffsets[i] = static_cast<T>(0.5) * (min + max);
+		maxHalfRange = std::max(maxHalfRange, static_cast<T>(0.5) * (max - min));
+	}
+
+	const auto maxValue = (quantisation == AudioClassifyOptions::KNNQuantisation::int16) ? QuantisedKernels::maxInt16Value
+																						   : QuantisedKernels::maxInt8Value;
+
+	quantisationScale = (maxHalfRange > static_cast<T>(0.0)) ? static_cast<T>(maxValue) / maxHalfRange : static_cast<T>(1.0);
+
+	//Padded to 32 values so the integer kernels run whole vectors.
+	quantisedNumFeatures = (numFeatures + 31) & ~static_cast<std::size_t>(31);
+
+	if (quantisation == AudioClassifyOptions::KNNQuantisation::int16)
+	{
+		quantisedTrainingSet16.assign(quantisedNumFeatures * numTrainingInstances, 0);
+		quantisedInstance16.assign(quantisedNumFeatures, 0);
+
+		for (std::size_t j = 0; j < numTrainingInstances; ++j)
+			quantise(trainingSet.colptr(j), quantisedTrainingSet16.data() + (j * quantisedNumFeatures), maxValue);
+	}
+	else
+	{
+		quantisedTrainingSet8.assign(quantisedNumFeatures * numTrainingInstances, 0);
+		quantisedInstance8.assign(quantisedNumFeatures, 0);
+
+		for (std::size_t j = 0; j < numTrainingInstances; ++j)
+			quantise(trainingSet.colptr(j), quantisedTrainingSet8.data() + (j * quantisedNumFeatures), maxValue);
+	}
 }
 
 //=======================================================================================================
@@ -145,6 +437,12 @@ void NearestNeighbour<T>::configureTrainingSetMatrix()
 	trainingSet.set_size(numFeatures, trainingSetSize);
 	trainingSet.zeros();
 
+	trained = false;
+	tree.clear();
+
+	updatePaddedTrainingSet();
+	updateQuantisedTrainingSet();
+
 	labels.set_size(trainingSetSize);
 
 	for (auto i = 0; i < labels.n_elem; ++i)
@@ -153,6 +451,11 @@ void NearestNeighbour<T>::configureTrainingSetMatrix()
 		labels[i] = 0;
 	}
 }
+//=======================================================================================================
+//Passed by reference to std::min, so needs a definition.
+template<typename T>
+const unsigned int NearestNeighbour<T>::maxNumNeighbours;
+
 //=======================================================================================================
 template class NearestNeighbour<float>;
 template class NearestNeighbour<double>;
\ No newline at end of file
@@ -18,10 +18,16 @@
 #endif
 
 #include<memory>
+#include <vector>
+#include <cstdint>
+#include <atomic>
 
 #include <armadillo.h>
 
-#include "../PreProcessing/PreProcessing.h"
+#include "../AudioClassifyOptions/AudioClassifyOptions.h"
+#include "KDTree.h"
+#include "PrototypeCondenser.h"
+#include "../Simd/AlignedAllocator.h"
 
 template<typename T>
 class NearestNeighbour
@@ -39,17 +45,34 @@ public:
 
 
 	/** Classifies a given instance based on the Modal class of the K nearest neighbours.
+	 *  The instance must be scaled the same way as the training set (see FeatureScaler).
 	 * @param instance the instance to be classified.
 	 * @return the label/class predicted for the supplied instance.
 	 */
 	int classify(arma::Col<T>& instance);
 
+	/** Classifies every column of instances. Squared distances to the training set come from one
+	 *  matrix product per batchBlockSize instances, |t|^2 + |x|^2 - 2 t.x, and the K nearest vote
+	 *  as in classify(). The search is always exact, the search type and quantisation only apply to classify().
+	 *  Note: allocates. Safe to call concurrently with other const calls, do not call from the audio thread.
+	 * @param instances the scaled instances to be classified, one per column.
+	 * @param labelsOut receives the label predicted for each column.
+	 */
+	void classify(const arma::Mat<T>& instances, arma::Row<int>& labelsOut) const;
+
+	static const std::size_t batchBlockSize = 256;
+
 
 	/** Sets the number of nearest neighbours (K) used in the search/scoring algorithm.
+	 *  The search buffers are sized for maxNumNeighbours up front, so this is safe to call while
+	 *  classify() runs on the audio thread. Values are clamped to 1 - maxNumNeighbours.
 	* @param newNumNeighbours The number of neighbours (K) compared in the search.
 	*/
 	void setNumNeighbours(const unsigned int newNumNeighbours);
 
+	//Largest K offered by the classifier selection UI.
+	static const unsigned int maxNumNeighbours = 11;
+
 	/**
 	 * Returns the number of nearest neighbours (K) currently used in the classification
 	 * method.
@@ -68,71 +91,105 @@ public:
 
 
 	/** Adds a new training data set to the NearestNeighbour model which will be used
-	 * as the model for calculating distances and K nearest neighbours.
+	 * as the model for calculating distances and K nearest neighbours. Features should already be
+	 * scaled (see FeatureScaler) as distances are computed on the values as given.
 	 * @param newTrainingSet the training set to be added to the model.
 	 */
 	void train(const arma::Mat<T>& newTrainingSet, const arma::Row<int>& newLabels);
 
+	/** Selects brute force or KD-tree neighbour search. The KD-tree index is built here if the
+	 *  model is already trained, otherwise by train().
+	 * Note: allocates and rebuilds the index classify() reads, do not call while classify() may be running.
+	 */
+	void setSearchType(AudioClassifyOptions::KNNSearchType newSearchType);
+	AudioClassifyOptions::KNNSearchType getSearchType() const;
 
-private:
-
-	/** A simple structure used internally by the NearestNeighbour class.
-	 * The Neighbour class/struct is used when sorting the neighbour instance
-	 * distances vector into K nearest order. This allows a prediction to be
-	 * made based on the modal class/label occurence in the K nearest neighbours.
-	 * 
-	 * Note: The Neighbour struct/object will not be valid when used in the distance
-	 * based nearest neighbour algorithm until it's members label and distance are
-	 * explicitly set. When default constructed distance = 0.0 which means if left in 
-	 * it's initial state the Neighbour would be at the top of the K nearest list as the
-	 * closest training instance. 	
+	/** Enables an int16 or int8 quantised copy of the training set for the brute force search.
+	 *  The rerankCandidatesPerNeighbour * K closest instances by integer distance are reranked
+	 *  in full precision to pick the K nearest. Built here if trained, otherwise by train().
+	 * Note: allocates and rebuilds the set classify() reads, do not call while classify() may be running.
 	 */
-	struct Neighbour
-	{
-		size_t label;
-		T distance;
-
-		Neighbour()
-		{
-			label = 0;
-			distance = static_cast<T>(0.0);
-		}
-
-		Neighbour(size_t label, T distance)
-		{
-			this->label = label;
-			this->distance = distance;
-		}
-
-		bool operator < (Neighbour other)
-		{
-			return this->distance < other.distance;
-		}
-	};
-
-
-	/** Calculates the euclidean distance of the referenceInstance from the testInstance
-	 * @param testInstance the test instance to determine the euclidean distance of test - reference for.  
-	 * @param referenceInstance the reference instance to determine the euclidean distance of test - reference for.
-	 *
-	 * @return the euclidean distance value for testInstance - referenceInstance. 
+	void setQuantisation(AudioClassifyOptions::KNNQuantisation newQuantisation);
+	AudioClassifyOptions::KNNQuantisation getQuantisation() const;
+
+	static const std::size_t rerankCandidatesPerNeighbour = 4;
+
+	/** Caps the number of instances stored by train(). Larger training sets are condensed to
+	 *  this many per class k-means prototypes (see PrototypeCondenser) so the search cost stays
+	 *  bounded however much data is recorded. 0 (the default) stores every instance.
+	 *  The budget should leave several times K prototypes per class or the vote is split across classes.
+	 *  Takes effect the next time the model is trained.
 	 */
-	T euclideanDistance(const arma::Col<T>& testInstance, const arma::Col<T>& referenceInstance);
+	void setPrototypeBudget(std::size_t newPrototypeBudget);
+	std::size_t getPrototypeBudget() const;
+
+	/** @return the number of instances searched by classify(), after any condensation. */
+	std::size_t getNumStoredInstances() const;
+
+
+private:
 
 	unsigned int numInstances;
 	unsigned int trainingSetSize;
 	unsigned int numFeatures;
 	unsigned int numClasses;
-	unsigned int numNeighbours;
+	std::atomic<unsigned int> numNeighbours;
 
-	std::unique_ptr<Neighbour[]> neighbours;
 	std::unique_ptr<size_t[]> neighbourClassCounts;
 
 	arma::Mat<T> trainingSet;
 	arma::Row<int> labels;
 
-	//Vector of squared differences for use in euclidean distance function
-	arma::Col<T> squaredDistances;
+	/** Copy of the trainingSet for the brute force search. Each instance is padded with
+	 *  zeros to paddedNumFeatures and aligned so the distance kernel runs without a scalar tail.
+	 */
+	AlignedVector<T> paddedTrainingSet;
+	AlignedVector<T> paddedInstance;
+	std::size_t paddedNumFeatures;
+
+	//Squared norm of each training instance for the batch distance matrix.
+	arma::Row<T> trainingSquaredNorms;
+
+	AudioClassifyOptions::KNNSearchType searchType;
+	bool trained;
+
+	std::size_t prototypeBudget;
+	PrototypeCondenser<T> condenser;
+
+	//KD-tree index over the trainingSet.
+	KDTree<T> tree;
+
+	//Preallocated k nearest results (maxNumNeighbours each) used as a NeighbourHeap by both search types.
+	std::vector<std::size_t> neighbourIndices;
+	std::vector<T> neighbourDistances;
+
+	/** Quantised copy of paddedTrainingSet, q = round((x - quantisationOffsets) * quantisationScale).
+	 *  The offsets centre each feature's training range. One scale is shared by all features so
+	 *  integer distances stay proportional to the full precision distances.
+	 */
+	AudioClassifyOptions::KNNQuantisation quantisation;
+	AlignedVector<std::int16_t> quantisedTrainingSet16;
+	AlignedVector<std::int16_t> quantisedInstance16;
+	AlignedVector<std::int8_t> quantisedTrainingSet8;
+	AlignedVector<std::int8_t> quantisedInstance8;
+	std::vector<T> quantisationOffsets;
+	T quantisationScale;
+	std::size_t quantisedNumFeatures;
+
+	//Preallocated integer NeighbourHeap of the rerank candidates (rerankCandidatesPerNeighbour * maxNumNeighbours).
+	std::vector<std::size_t> candidateIndices;
+	std::vector<std::int64_t> candidateDistances;
+
+	std::size_t searchBruteForce(const T* instance, std::size_t k);
+	void updatePaddedTrainingSet();
+
+	template<typename Q>
+	std::size_t searchQuantised(const T* instance, std::size_t k, const AlignedVector<Q>& quantisedSet, AlignedVector<Q>& quantisedInstance, int maxValue);
+
+	template<typename Q>
+	void quantise(const T* values, Q* quantised, int maxValue) const;
+
+	void updateQuantisedTrainingSet();
 
 	void configureTrainingSetMatrix();
 };
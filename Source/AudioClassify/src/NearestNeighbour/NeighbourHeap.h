@@ -0,0 +1,93 @@
+/*
+  ==============================================================================
+
+    NeighbourHeap.h
+    Created: 19 Oct 2026 6:20:51pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef NEIGHBOURHEAP_H_INCLUDED
+#define NEIGHBOURHEAP_H_INCLUDED
+
+#include <cstddef>
+
+/** Fixed capacity max heap on distance used by the k nearest neighbour searches. The heap
+ *  lives in two caller owned arrays (indices and squared distances) so searches on the audio
+ *  thread do not allocate. Once k neighbours are held, squaredDistances[0] is the k-th best
+ *  distance and is used as the pruning bound.
+ */
+namespace NeighbourHeap
+{
+	/** Adds (index, distance) to a heap of size elements. The arrays must hold size + 1 elements. */
+	template<typename T>
+	inline void push(std::size_t* indices, T* squaredDistances, std::size_t size, std::size_t index, T distance)
+	{
+		//Sift up from the new last element.
+		auto child = size;
+
+		while (child > 0)
+		{
+			const auto parent = (child - 1) / 2;
+
+			if (squaredDistances[parent] >= distance)
+				break;
+
+			indices[child] = indices[parent];
+			squaredDistances[child] = squaredDistances[parent];
+			child = parent;
+		}
+
+		indices[child] = index;
+		squaredDistances[child] = distance;
+	}
+
+	/** Replaces the furthest neighbour of a heap of size elements with (index, distance). */
+	template<typename T>
+	inline void replaceTop(std::size_t* indices, T* squaredDistances, std::size_t size, std::size_t index, T distance)
+	{
+		//Sift down from the root.
+		std::size_t parent = 0;
+
+		while (true)
+		{
+			auto child = (2 * parent) + 1;
+
+			if (child >= size)
+				break;
+
+			if (child + 1 < size && squaredDistances[child + 1] > squaredDistances[child])
+				++child;
+
+			if (squaredDistances[child] <= distance)
+				break;
+
+			indices[parent] = indices[child];
+			squaredDistances[parent] = squaredDistances[child];
+			parent = child;
+		}
+
+		indices[parent] = index;
+		squaredDistances[parent] = distance;
+	}
+
+	/** Sorts a heap of size elements in place into ascending distance order. */
+	template<typename T>
+	inline void sortAscending(std::size_t* indices, T* squaredDistances, std::size_t size)
+	{
+		for (; size > 1; --size)
+		{
+			const auto index = indices[0];
+			const auto distance = squaredDistances[0];
+
+			replaceTop(indices, squaredDistances, size - 1, indices[size - 1], squaredDistances[size - 1]);
+
+			indices[size - 1] = index;
+			squaredDistances[size - 1] = distance;
+		}
+	}
+}
+
+
+#endif  // NEIGHBOURHEAP_H_INCLUDED
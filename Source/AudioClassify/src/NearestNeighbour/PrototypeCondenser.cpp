@@ -0,0 +1,301 @@
+/*
+  ==============================================================================
+
+    PrototypeCondenser.cpp
+    Created: 19 Oct 2026 8:26:14pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "PrototypeCondenser.h"
+#include "../Simd/SimdKernels.h"
+
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <cassert>
+
+//=======================================================================================================
+template<typename T>
+PrototypeCondenser<T>::PrototypeCondenser()
+{
+}
+
+//=======================================================================================================
+template<typename T>
+PrototypeCondenser<T>::~PrototypeCondenser()
+{
+}
+
+//=======================================================================================================
+template<typename T>
+void PrototypeCondenser<T>::condense(const arma::Mat<T>& data, const arma::Row<int>& labels, unsigned int numClasses, std::size_t budget,
+									 arma::Mat<T>& prototypes, arma::Row<int>& prototypeLabels)
+{
+	assert(labels.n_elem == data.n_cols);
+
+	classMembers.resize(numClasses);
+
+	for (auto& members : classMembers)
+		members.clear();
+
+	for (std::size_t j = 0; j < data.n_cols; ++j)
+	{
+		const auto label = labels[j];
+
+		if (label >= 0 && static_cast<unsigned int>(label) < numClasses)
+			classMembers[label].push_back(j);
+	}
+
+	allocatePrototypes(budget);
+
+	std::size_t numPrototypes = 0;
+
+	for (auto count : prototypesPerClass)
+		numPrototypes += count;
+
+	prototypes.set_size(data.n_rows, numPrototypes);
+	prototypeLabels.set_size(numPrototypes);
+
+	std::size_t offset = 0;
+
+	for (unsigned int c = 0; c < numClasses; ++c)
+	{
+		const auto count = prototypesPerClass[c];
+
+		if (count == 0)
+			continue;
+
+		clusterClass(data, classMembers[c], count, 1234 + c, prototypes.colptr(offset));
+
+		for (std::size_t i = 0; i < count; ++i)
+			prototypeLabels[offset + i] = static_cast<int>(c);
+
+		offset += count;
+	}
+}
+
+//=======================================================================================================
+template<typename T>
+void PrototypeCondenser<T>::allocatePrototypes(std::size_t budget)
+{
+	const auto numClasses = classMembers.size();
+
+	prototypesPerClass.assign(numClasses, 0);
+
+	std::size_t numInstances = 0;
+	std::size_t numClassesPresent = 0;
+
+	for (const auto& members : classMembers)
+	{
+		numInstances += members.size();
+
+		if (!members.empty())
+			++numClassesPresent;
+	}
+
+	if (numInstances == 0)
+		return;
+
+	budget = std::min(std::max(budget, numClassesPresent), numInstances);
+
+	//Proportional shares rounded down, with at least one prototype per class.
+	std::size_t allocated = 0;
+
+	for (std::size_t c = 0; c < numClasses; ++c)
+	{
+		const auto size = classMembers[c].size();
+
+		if (size == 0)
+			continue;
+
+		prototypesPerClass[c] = std::max<std::size_t>(1, (budget * size) / numInstances);
+		allocated += prototypesPerClass[c];
+	}
+
+	//The minimum of one can overshoot, take back from the classes with the fewest instances per prototype.
+	while (allocated > budget)
+	{
+		auto best = numClasses;
+		auto bestRatio = std::numeric_limits<double>::max();
+
+		for (std::size_t c = 0; c < numClasses; ++c)
+		{
+			if (prototypesPerClass[c] <= 1)
+				continue;
+
+			const auto ratio = static_cast<double>(classMembers[c].size()) / static_cast<double>(prototypesPerClass[c]);
+
+			if (ratio < bestRatio)
+			{
+				bestRatio = ratio;
+				best = c;
+			}
+		}
+
+		if (best == numClasses)
+			break;
+
+		--prototypesPerClass[best];
+		--allocated;
+	}
+
+	//Hand the rounding remainder to the classes with the most instances per prototype.
+	while (allocated < budget)
+	{
+		auto best = numClasses;
+		auto bestRatio = 0.0;
+
+		for (std::size_t c = 0; c < numClasses; ++c)
+		{
+			if (prototypesPerClass[c] == 0 || prototypesPerClass[c] >= classMembers[c].size())
+				continue;
+
+			const auto ratio = static_cast<double>(classMembers[c].size()) / static_cast<double>(prototypesPerClass[c]);
+
+			if (ratio > bestRatio)
+			{
+				bestRatio = ratio;
+				best = c;
+			}
+		}
+
+		if (best == numClasses)
+			break;
+
+		++prototypesPerClass[best];
+		++allocated;
+	}
+}
+
+//=======================================================================================================
+template<typename T>
+void PrototypeCondenser<T>::clusterClass(const arma::Mat<T>& data, const std::vector<std::size_t>& members, std::size_t numPrototypes,
+										 unsigned int seed, T* output)
+{
+	const auto numFeatures = static_cast<std::size_t>(data.n_rows);
+	const auto numMembers = members.size();
+
+	assert(numPrototypes > 0 && numPrototypes <= numMembers);
+
+	if (numPrototypes == numMembers)
+	{
+		for (std::size_t i = 0; i < numMembers; ++i)
+			std::copy(data.colptr(members[i]), data.colptr(members[i]) + numFeatures, output + (i * numFeatures));
+
+		return;
+	}
+
+	std::mt19937 randomEngine(seed);
+
+	centroids.set_size(numFeatures, numPrototypes);
+
+	//k-means++ seeding. Each new centroid is drawn with probability proportional to its squared distance from the nearest chosen so far.
+	std::uniform_int_distribution<std::size_t> firstChoice(0, numMembers - 1);
+	const auto* first = data.colptr(members[firstChoice(randomEngine)]);
+	std::copy(first, first + numFeatures, centroids.colptr(0));
+
+	nearestDistances.assign(numMembers, std::numeric_limits<T>::max());
+
+	for (std::size_t k = 1; k < numPrototypes; ++k)
+	{
+		auto total = static_cast<T>(0.0);
+
+		for (std::size_t i = 0; i < numMembers; ++i)
+		{
+			const auto distance = SimdKernels::squaredDistance(data.colptr(members[i]), centroids.colptr(k - 1), numFeatures);
+			nearestDistances[i] = std::min(nearestDistances[i], distance);
+			total += nearestDistances[i];
+		}
+
+		//All remaining instances coincide with a centroid, any choice will do.
+		auto chosen = k;
+
+		if (total > static_cast<T>(0.0))
+		{
+			std::uniform_real_distribution<T> target(static_cast<T>(0.0), total);
+			auto remaining = target(randomEngine);
+
+			for (chosen = 0; chosen < numMembers - 1; ++chosen)
+			{
+				remaining -= nearestDistances[chosen];
+
+				if (remaining <= static_cast<T>(0.0) && nearestDistances[chosen] > static_cast<T>(0.0))
+					break;
+			}
+		}
+
+		std::copy(data.colptr(members[chosen]), data.colptr(members[chosen]) + numFeatures, centroids.colptr(k));
+	}
+
+	//Lloyd iterations until the assignments settle. output accumulates the cluster sums.
+	assignments.assign(numMembers, numPrototypes);
+
+	for (auto iteration = 0; iteration < maxIterations; ++iteration)
+	{
+		auto changed = false;
+
+		for (std::size_t i = 0; i < numMembers; ++i)
+		{
+			const auto* instance = data.colptr(members[i]);
+
+			auto nearest = std::size_t(0);
+			auto nearestDistance = SimdKernels::squaredDistance(instance, centroids.colptr(0), numFeatures);
+
+			for (std::size_t k = 1; k < numPrototypes; ++k)
+			{
+				const auto distance = SimdKernels::squaredDistanceBounded(instance, centroids.colptr(k), numFeatures, nearestDistance);
+
+				if (distance < nearestDistance)
+				{
+					nearestDistance = distance;
+					nearest = k;
+				}
+			}
+
+			if (assignments[i] != nearest)
+			{
+				assignments[i] = nearest;
+				changed = true;
+			}
+		}
+
+		if (!changed)
+			break;
+
+		std::fill(output, output + (numFeatures * numPrototypes), static_cast<T>(0.0));
+		clusterSizes.assign(numPrototypes, 0);
+
+		for (std::size_t i = 0; i < numMembers; ++i)
+		{
+			const auto* instance = data.colptr(members[i]);
+			auto* sum = output + (assignments[i] * numFeatures);
+
+			for (std::size_t f = 0; f < numFeatures; ++f)
+				sum[f] += instance[f];
+
+			++clusterSizes[assignments[i]];
+		}
+
+		//Empty clusters keep their previous centroid.
+		for (std::size_t k = 0; k < numPrototypes; ++k)
+		{
+			if (clusterSizes[k] == 0)
+				continue;
+
+			const auto scale = static_cast<T>(1.0) / static_cast<T>(clusterSizes[k]);
+			const auto* sum = output + (k * numFeatures);
+			auto* centroid = centroids.colptr(k);
+
+			for (std::size_t f = 0; f < numFeatures; ++f)
+				centroid[f] = sum[f] * scale;
+		}
+	}
+
+	std::copy(centroids.memptr(), centroids.memptr() + (numFeatures * numPrototypes), output);
+}
+
+//=======================================================================================================
+template class PrototypeCondenser<float>;
+template class PrototypeCondenser<double>;
@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    PrototypeCondenser.h
+    Created: 19 Oct 2026 8:26:14pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef PROTOTYPECONDENSER_H_INCLUDED
+#define PROTOTYPECONDENSER_H_INCLUDED
+
+#ifdef _WIN64
+#define ARMA_64BIT_WORD
+#endif
+
+#include <vector>
+#include <cstddef>
+
+#include <armadillo.h>
+
+/** Reduces a labelled training set to a fixed budget of prototypes with per class k-means.
+ *
+ *  The budget is shared between the classes in proportion to their number of instances, with
+ *  at least one prototype for every class present. Each class is clustered separately, seeded
+ *  with k-means++ from a fixed seed so the result is repeatable, and its cluster means become
+ *  that class's prototypes. Classes already within their share are copied unchanged.
+ *
+ *  Note: condense() allocates and blocks. Call it at training time, off the audio thread.
+ */
+template<typename T>
+class PrototypeCondenser
+{
+public:
+	PrototypeCondenser();
+	~PrototypeCondenser();
+
+	/** Condenses data (numFeatures x numInstances) to at most max(budget, number of classes present) prototypes.
+	 * @param data the training instances, one per column.
+	 * @param labels the class of each instance in the range 0 to numClasses - 1.
+	 * @param numClasses the number of classes in the model.
+	 * @param budget the total number of prototypes to keep.
+	 * @param prototypes receives the prototypes, one per column.
+	 * @param prototypeLabels receives the class of each prototype.
+	 */
+	void condense(const arma::Mat<T>& data, const arma::Row<int>& labels, unsigned int numClasses, std::size_t budget,
+				  arma::Mat<T>& prototypes, arma::Row<int>& prototypeLabels);
+
+	static const int maxIterations = 20;
+
+private:
+	std::vector<std::vector<std::size_t>> classMembers;
+	std::vector<std::size_t> prototypesPerClass;
+
+	//k-means scratch for the class being clustered.
+	std::vector<std::size_t> assignments;
+	std::vector<std::size_t> clusterSizes;
+	std::vector<T> nearestDistances;
+	arma::Mat<T> centroids;
+
+	void allocatePrototypes(std::size_t budget);
+	void clusterClass(const arma::Mat<T>& data, const std::vector<std::size_t>& members, std::size_t numPrototypes,
+					  unsigned int seed, T* output);
+};
+
+
+#endif  // PROTOTYPECONDENSER_H_INCLUDED
@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    FeatureScaler.cpp
+    Created: 19 Oct 2026 7:02:15pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "FeatureScaler.h"
+#include "../Simd/SimdOps.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+//==============================================================================
+template<typename T>
+FeatureScaler<T>::FeatureScaler()
+	: type(AudioClassifyOptions::ScalerType::none)
+{
+}
+
+//==============================================================================
+template<typename T>
+FeatureScaler<T>::~FeatureScaler()
+{
+}
+
+//==============================================================================
+template<typename T>
+void FeatureScaler<T>::fit(const arma::Mat<T>& data, AudioClassifyOptions::ScalerType newType)
+{
+	const auto numFeatures = static_cast<std::size_t>(data.n_rows);
+	const auto numInstances = static_cast<std::size_t>(data.n_cols);
+
+	reset(numFeatures);
+	type = newType;
+
+	if (type == AudioClassifyOptions::ScalerType::none || numInstances == 0)
+		return;
+
+	for (std::size_t i = 0; i < numFeatures; ++i)
+	{
+		if (type == AudioClassifyOptions::ScalerType::minMax)
+		{
+			auto min = data(i, 0);
+			auto max = data(i, 0);
+
+			for (std::size_t j = 1; j < numInstances; ++j)
+			{
+				min = std::min(min, data(i, j));
+				max = std::max(max, data(i, j));
+			}
+
+			//(value - min) / (max - min). Constant features are only shifted to 0.
+			const auto range = max - min;
+			scales[i] = (range > static_cast<T>(0.0)) ? static_cast<T>(1.0) / range : static_cast<T>(1.0);
+			offsets[i] = -min * scales[i];
+		}
+		else
+		{
+			auto mean = static_cast<T>(0.0);
+
+			for (std::size_t j = 0; j < numInstances; ++j)
+				mean += data(i, j);
+
+			mean /= static_cast<T>(numInstances);
+
+			auto variance = static_cast<T>(0.0);
+
+			for (std::size_t j = 0; j < numInstances; ++j)
+				variance += (data(i, j) - mean) * (data(i, j) - mean);
+
+			variance /= static_cast<T>(numInstances);
+
+			//(value - mean) / stdDev. Constant features are only shifted to 0.
+			const auto stdDev = std::sqrt(variance);
+			scales[i] = (stdDev > static_cast<T>(0.0)) ? static_cast<T>(1.0) / stdDev : static_cast<T>(1.0);
+			offsets[i] = -mean * scales[i];
+		}
+	}
+}
+
+//==============================================================================
+template<typename T>
+void FeatureScaler<T>::reset(std::size_t numFeatures)
+{
+	type = AudioClassifyOptions::ScalerType::none;
+
+	scales.set_size(numFeatures);
+	scales.fill(static_cast<T>(1.0));
+
+	offsets.zeros(numFeatures);
+}
+
+//==============================================================================
+template<typename T>
+void FeatureScaler<T>::setParameters(AudioClassifyOptions::ScalerType newType, const arma::Col<T>& newScales, const arma::Col<T>& newOffsets)
+{
+	assert(newScales.n_elem == newOffsets.n_elem);
+
+	type = newType;
+	scales = newScales;
+	offsets = newOffsets;
+}
+
+//==============================================================================
+template<typename T>
+void FeatureScaler<T>::apply(const T* input, T* output) const
+{
+	using Ops = SimdOps<T>;
+
+	const auto numFeatures = getNumFeatures();
+
+	if (type == AudioClassifyOptions::ScalerType::none)
+	{
+		if (input != output)
+			std::copy(input, input + numFeatures, output);
+
+		return;
+	}
+
+	const auto* scale = scales.memptr();
+	const auto* offset = offsets.memptr();
+
+	std::size_t i = 0;
+
+	for (; i + Ops::width <= numFeatures; i += Ops::width)
+		Ops::store(output + i, Ops::mulAdd(Ops::load(input + i), Ops::load(scale + i), Ops::load(offset + i)));
+
+	for (; i < numFeatures; ++i)
+		output[i] = (input[i] * scale[i]) + offset[i];
+}
+
+//==============================================================================
+template<typename T>
+void FeatureScaler<T>::apply(arma::Mat<T>& data) const
+{
+	assert(data.n_rows == getNumFeatures());
+
+	for (std::size_t j = 0; j < data.n_cols; ++j)
+		apply(data.colptr(j), data.colptr(j));
+}
+
+//==============================================================================
+template<typename T>
+AudioClassifyOptions::ScalerType FeatureScaler<T>::getType() const
+{
+	return type;
+}
+
+//==============================================================================
+template<typename T>
+std::size_t FeatureScaler<T>::getNumFeatures() const
+{
+	return scales.n_elem;
+}
+
+//==============================================================================
+template<typename T>
+const arma::Col<T>& FeatureScaler<T>::getScales() const
+{
+	return scales;
+}
+
+//==============================================================================
+template<typename T>
+const arma::Col<T>& FeatureScaler<T>::getOffsets() const
+{
+	return offsets;
+}
+
+//==============================================================================
+template class FeatureScaler<float>;
+template class FeatureScaler<double>;
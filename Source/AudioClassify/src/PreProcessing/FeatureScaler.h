@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    FeatureScaler.h
+    Created: 19 Oct 2026 7:02:15pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef FEATURESCALER_H_INCLUDED
+#define FEATURESCALER_H_INCLUDED
+
+#ifdef _WIN64
+#define ARMA_64BIT_WORD
+#endif
+
+#include <armadillo.h>
+
+#include "../AudioClassifyOptions/AudioClassifyOptions.h"
+
+/** Per feature affine scaling (min-max or z-score) fitted once on a training set and then
+ *  applied identically to the training data and to every instance classified.
+ *
+ *  Both scaling types are stored as a scale and offset per feature so applying the scaler
+ *  is a single fused multiply-add: scaled = (value * scale) + offset.
+ */
+template<typename T>
+class FeatureScaler
+{
+public:
+	FeatureScaler();
+	~FeatureScaler();
+
+	/** Fits the scaler to the rows (features) of data.
+	 * Note: allocates, do not call from the audio thread.
+	 * @param data the training set, one instance per column.
+	 * @param newType the scaling to fit. ScalerType::none gives an identity scaler.
+	 */
+	void fit(const arma::Mat<T>& data, AudioClassifyOptions::ScalerType newType);
+
+	/** Resets to an identity scaler of numFeatures features. */
+	void reset(std::size_t numFeatures);
+
+	/** Restores previously fitted (e.g. saved) parameters. scales and offsets must have the same size. */
+	void setParameters(AudioClassifyOptions::ScalerType newType, const arma::Col<T>& newScales, const arma::Col<T>& newOffsets);
+
+	/** Scales getNumFeatures() values from input into output. input and output may be the same
+	 *  buffer. Does not allocate so it is safe to call from the audio thread.
+	 */
+	void apply(const T* input, T* output) const;
+
+	/** Scales every column of data in place. */
+	void apply(arma::Mat<T>& data) const;
+
+	AudioClassifyOptions::ScalerType getType() const;
+	std::size_t getNumFeatures() const;
+
+	const arma::Col<T>& getScales() const;
+	const arma::Col<T>& getOffsets() const;
+
+private:
+	AudioClassifyOptions::ScalerType type;
+
+	arma::Col<T> scales;
+	arma::Col<T> offsets;
+};
+
+
+#endif  // FEATURESCALER_H_INCLUDED
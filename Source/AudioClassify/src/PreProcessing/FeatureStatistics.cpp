@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+    FeatureStatistics.cpp
+    Created: 19 Oct 2026 11:41:09pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "FeatureStatistics.h"
+
+#include <algorithm>
+#include <cassert>
+
+//==============================================================================
+template<typename T>
+FeatureStatistics<T>::FeatureStatistics()
+{
+}
+
+//==============================================================================
+template<typename T>
+FeatureStatistics<T>::~FeatureStatistics()
+{
+}
+
+//==============================================================================
+template<typename T>
+void FeatureStatistics<T>::reset(std::size_t numFeatures)
+{
+	numInstances = 0;
+
+	mins.zeros(numFeatures);
+	maxs.zeros(numFeatures);
+	means.zeros(numFeatures);
+	m2s.zeros(numFeatures);
+}
+
+//==============================================================================
+template<typename T>
+void FeatureStatistics<T>::add(const T* instance)
+{
+	const auto numFeatures = static_cast<std::size_t>(means.n_elem);
+
+	++numInstances;
+
+	if (numInstances == 1)
+	{
+		std::copy(instance, instance + numFeatures, mins.memptr());
+		std::copy(instance, instance + numFeatures, maxs.memptr());
+		std::copy(instance, instance + numFeatures, means.memptr());
+		m2s.zeros();
+
+		return;
+	}
+
+	const auto scale = static_cast<T>(1.0) / static_cast<T>(numInstances);
+
+	auto* min = mins.memptr();
+	auto* max = maxs.memptr();
+	auto* mean = means.memptr();
+	auto* m2 = m2s.memptr();
+
+	for (std::size_t i = 0; i < numFeatures; ++i)
+	{
+		const auto value = instance[i];
+
+		min[i] = std::min(min[i], value);
+		max[i] = std::max(max[i], value);
+
+		const auto delta = value - mean[i];
+		mean[i] += delta * scale;
+		m2[i] += delta * (value - mean[i]);
+	}
+}
+
+//==============================================================================
+template<typename T>
+void FeatureStatistics<T>::add(const arma::Mat<T>& data)
+{
+	assert(data.n_rows == means.n_elem);
+
+	//Instances are columns, so this reads the data once in memory order.
+	for (std::size_t j = 0; j < data.n_cols; ++j)
+		add(data.colptr(j));
+}
+
+//==============================================================================
+template<typename T>
+void FeatureStatistics<T>::merge(const FeatureStatistics<T>& other)
+{
+	assert(other.means.n_elem == means.n_elem);
+
+	if (other.numInstances == 0)
+		return;
+
+	if (numInstances == 0)
+	{
+		*this = other;
+		return;
+	}
+
+	const auto count = static_cast<T>(numInstances);
+	const auto otherCount = static_cast<T>(other.numInstances);
+	const auto total = count + otherCount;
+
+	for (std::size_t i = 0; i < means.n_elem; ++i)
+	{
+		const auto delta = other.means[i] - means[i];
+
+		mins[i] = std::min(mins[i], other.mins[i]);
+		maxs[i] = std::max(maxs[i], other.maxs[i]);
+		means[i] += delta * (otherCount / total);
+		m2s[i] += other.m2s[i] + (delta * delta * ((count * otherCount) / total));
+	}
+
+	numInstances += other.numInstances;
+}
+
+//==============================================================================
+template<typename T>
+void FeatureStatistics<T>::selectFeatures(const arma::uvec& features)
+{
+	mins = mins.elem(features);
+	maxs = maxs.elem(features);
+	means = means.elem(features);
+	m2s = m2s.elem(features);
+}
+
+//==============================================================================
+template<typename T>
+std::size_t FeatureStatistics<T>::getNumFeatures() const
+{
+	return means.n_elem;
+}
+
+//==============================================================================
+template<typename T>
+std::size_t FeatureStatistics<T>::getNumInstances() const
+{
+	return numInstances;
+}
+
+//==============================================================================
+template<typename T>
+const arma::Col<T>& FeatureStatistics<T>::getMins() const
+{
+	return mins;
+}
+
+//==============================================================================
+template<typename T>
+const arma::Col<T>& FeatureStatistics<T>::getMaxs() const
+{
+	return maxs;
+}
+
+//==============================================================================
+template<typename T>
+const arma::Col<T>& FeatureStatistics<T>::getMeans() const
+{
+	return means;
+}
+
+//==============================================================================
+template<typename T>
+arma::Col<T> FeatureStatistics<T>::getVariances() const
+{
+	arma::Col<T> variances(means.n_elem);
+
+	for (std::size_t i = 0; i < means.n_elem; ++i)
+		variances[i] = (numInstances > 0) ? m2s[i] / static_cast<T>(numInstances) : static_cast<T>(0.0);
+
+	return variances;
+}
+
+//==============================================================================
+template<typename T>
+arma::Col<T> FeatureStatistics<T>::getNormalisedVariances() const
+{
+	arma::Col<T> variances = getVariances();
+
+	//Normalising by (value - min) / range scales the variance by 1 / range^2.
+	for (std::size_t i = 0; i < means.n_elem; ++i)
+	{
+		const auto range = maxs[i] - mins[i];
+		variances[i] = (range > static_cast<T>(0.0)) ? variances[i] / (range * range) : static_cast<T>(0.0);
+	}
+
+	return variances;
+}
+
+//==============================================================================
+template class FeatureStatistics<float>;
+template class FeatureStatistics<double>;
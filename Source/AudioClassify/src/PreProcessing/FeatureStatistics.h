@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    FeatureStatistics.h
+    Created: 19 Oct 2026 11:41:09pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef FEATURESTATISTICS_H_INCLUDED
+#define FEATURESTATISTICS_H_INCLUDED
+
+#ifdef _WIN64
+#define ARMA_64BIT_WORD
+#endif
+
+#include <armadillo.h>
+
+/** Running per feature minimum, maximum, mean and sum of squared differences from the mean
+ *  (Welford's M2) of a set of instances.
+ *
+ *  Instances are added one at a time as they are recorded, so the variance of every feature,
+ *  raw or min-max normalised, is available from O(numFeatures) statistics without revisiting
+ *  the data. Statistics of separate sets of instances can be merged.
+ */
+template<typename T>
+class FeatureStatistics
+{
+public:
+	FeatureStatistics();
+	~FeatureStatistics();
+
+	/** Clears the statistics of numFeatures features.
+	 * Note: allocates, do not call from the audio thread.
+	 */
+	void reset(std::size_t numFeatures);
+
+	/** Adds one instance of getNumFeatures() values. O(numFeatures) and does not allocate, so is
+	 *  safe to call from the audio thread.
+	 */
+	void add(const T* instance);
+
+	/** Adds every column of data in a single pass. */
+	void add(const arma::Mat<T>& data);
+
+	/** Adds the statistics of another set of instances of the same features (Chan et al.'s
+	 *  pairwise combination of Welford statistics).
+	 */
+	void merge(const FeatureStatistics<T>& other);
+
+	/** Keeps only the statistics of the given features, in the order given. */
+	void selectFeatures(const arma::uvec& features);
+
+	std::size_t getNumFeatures() const;
+	std::size_t getNumInstances() const;
+
+	const arma::Col<T>& getMins() const;
+	const arma::Col<T>& getMaxs() const;
+	const arma::Col<T>& getMeans() const;
+
+	/** @return the population variance of each feature. */
+	arma::Col<T> getVariances() const;
+
+	/** @return the population variance of each feature after min-max normalising it to [0, 1],
+	 *  i.e. variance / (max - min)^2. Constant features have a variance of 0.
+	 */
+	arma::Col<T> getNormalisedVariances() const;
+
+private:
+	std::size_t numInstances = 0;
+
+	arma::Col<T> mins;
+	arma::Col<T> maxs;
+	arma::Col<T> means;
+	arma::Col<T> m2s;
+};
+
+
+#endif  // FEATURESTATISTICS_H_INCLUDED
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    AlignedAllocator.h
+    Created: 19 Oct 2026 2:02:37pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef ALIGNEDALLOCATOR_H_INCLUDED
+#define ALIGNEDALLOCATOR_H_INCLUDED
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+/** std::allocator replacement returning cache line aligned memory for the SIMD kernel tables
+ *  and work buffers. Memory is over allocated and the original pointer stored just before the
+ *  aligned block so no platform specific aligned allocation functions are needed.
+ */
+template<typename T>
+struct AlignedAllocator
+{
+	using value_type = T;
+
+	enum : std::size_t { alignment = 64 };
+
+	template<typename U>
+	struct rebind { using other = AlignedAllocator<U>; };
+
+	AlignedAllocator() noexcept {}
+
+	template<typename U>
+	AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n)
+	{
+		const auto bytes = (n * sizeof(T)) + alignment + sizeof(void*);
+		auto* raw = std::malloc(bytes);
+
+		if (raw == nullptr)
+			throw std::bad_alloc();
+
+		auto address = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void*);
+		address = (address + (alignment - 1)) & ~static_cast<std::uintptr_t>(alignment - 1);
+
+		reinterpret_cast<void**>(address)[-1] = raw;
+
+		return reinterpret_cast<T*>(address);
+	}
+
+	void deallocate(T* ptr, std::size_t) noexcept
+	{
+		if (ptr != nullptr)
+			std::free(reinterpret_cast<void**>(ptr)[-1]);
+	}
+};
+
+template<typename T, typename U>
+bool operator==(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return true; }
+
+template<typename T, typename U>
+bool operator!=(const AlignedAllocator<T>&, const AlignedAllocator<U>&) { return false; }
+
+template<typename T>
+using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+/** @return size rounded up to a multiple of the widest SIMD register (8 floats), so padded rows
+ *  can be processed without scalar tails for both float and double.
+ */
+inline std::size_t getSimdPaddedSize(std::size_t size)
+{
+	return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+
+#endif  // ALIGNEDALLOCATOR_H_INCLUDED
@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+    QuantisedKernels.h
+    Created: 19 Oct 2026 7:40:26pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef QUANTISEDKERNELS_H_INCLUDED
+#define QUANTISEDKERNELS_H_INCLUDED
+
+#include <cstdint>
+#include <algorithm>
+
+#include "SimdOps.h"
+
+/** Integer distance kernels for quantised feature vectors (see NearestNeighbour::setQuantisation()).
+ *
+ *  Differences are formed in 16 bit lanes and squared and pair summed into 32 bit lanes with
+ *  madd (_mm_madd_epi16 / _mm256_madd_epi16 with AVX2). The 32 bit lanes are flushed to a 64 bit
+ *  total every blockVectors vectors, so values within +/- maxInt16Value cannot overflow at any size.
+ *  int8 vectors are sign extended to 16 bits first. Without SSE2 the kernels are scalar.
+ */
+namespace QuantisedKernels
+{
+	//Quantised values must lie within these limits. int16 leaves headroom for the 32 bit lane sums.
+	static const int maxInt16Value = 2047;
+	static const int maxInt8Value = 127;
+
+	static const std::size_t blockVectors = 16;
+
+#if defined(__AVX2__)
+	inline std::int64_t horizontalSum(__m256i acc)
+	{
+		alignas(32) std::int32_t lanes[8];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+
+		std::int64_t result = 0;
+
+		for (auto lane : lanes)
+			result += lane;
+
+		return result;
+	}
+#elif defined(AUDIOCLASSIFY_SIMD_AVX) || defined(AUDIOCLASSIFY_SIMD_SSE2)
+	inline std::int64_t horizontalSum(__m128i acc)
+	{
+		alignas(16) std::int32_t lanes[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+
+		return static_cast<std::int64_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+	}
+#endif
+
+	//===============================================================================
+	/** @return the squared euclidean distance between two int16 vectors of size elements. */
+	inline std::int64_t squaredDistance(const std::int16_t* a, const std::int16_t* b, std::size_t size)
+	{
+		std::int64_t result = 0;
+		std::size_t i = 0;
+
+#if defined(__AVX2__)
+		const std::size_t width = 16;
+
+		while (i + width <= size)
+		{
+			const auto blockEnd = i + (std::min((size - i) / width, blockVectors) * width);
+			auto acc = _mm256_setzero_si256();
+
+			for (; i < blockEnd; i += width)
+			{
+				const auto diff = _mm256_sub_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+												   _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+				acc = _mm256_add_epi32(acc, _mm256_madd_epi16(diff, diff));
+			}
+
+			result += horizontalSum(acc);
+		}
+#elif defined(AUDIOCLASSIFY_SIMD_AVX) || defined(AUDIOCLASSIFY_SIMD_SSE2)
+		const std::size_t width = 8;
+
+		while (i + width <= size)
+		{
+			const auto blockEnd = i + (std::min((size - i) / width, blockVectors) * width);
+			auto acc = _mm_setzero_si128();
+
+			for (; i < blockEnd; i += width)
+			{
+				const auto diff = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+												_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(diff, diff));
+			}
+
+			result += horizontalSum(acc);
+		}
+#endif
+
+		for (; i < size; ++i)
+		{
+			const auto diff = static_cast<std::int32_t>(a[i]) - b[i];
+			result += diff * diff;
+		}
+
+		return result;
+	}
+
+	//===============================================================================
+	/** @return the squared euclidean distance between two int8 vectors of size elements. */
+	inline std::int64_t squaredDistance(const std::int8_t* a, const std::int8_t* b, std::size_t size)
+	{
+		std::int64_t result = 0;
+		std::size_t i = 0;
+
+#if defined(__AVX2__)
+		const std::size_t width = 16;
+
+		while (i + width <= size)
+		{
+			const auto blockEnd = i + (std::min((size - i) / width, blockVectors) * width);
+			auto acc = _mm256_setzero_si256();
+
+			for (; i < blockEnd; i += width)
+			{
+				const auto a16 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+				const auto b16 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+				const auto diff = _mm256_sub_epi16(a16, b16);
+				acc = _mm256_add_epi32(acc, _mm256_madd_epi16(diff, diff));
+			}
+
+			result += horizontalSum(acc);
+		}
+#elif defined(AUDIOCLASSIFY_SIMD_AVX) || defined(AUDIOCLASSIFY_SIMD_SSE2)
+		const std::size_t width = 8;
+
+		while (i + width <= size)
+		{
+			const auto blockEnd = i + (std::min((size - i) / width, blockVectors) * width);
+			auto acc = _mm_setzero_si128();
+
+			for (; i < blockEnd; i += width)
+			{
+				//Sign extend 8 int8 values to int16 by duplicating each byte and shifting right.
+				const auto a8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(a + i));
+				const auto b8 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(b + i));
+				const auto a16 = _mm_srai_epi16(_mm_unpacklo_epi8(a8, a8), 8);
+				const auto b16 = _mm_srai_epi16(_mm_unpacklo_epi8(b8, b8), 8);
+				const auto diff = _mm_sub_epi16(a16, b16);
+				acc = _mm_add_epi32(acc, _mm_madd_epi16(diff, diff));
+			}
+
+			result += horizontalSum(acc);
+		}
+#endif
+
+		for (; i < size; ++i)
+		{
+			const auto diff = static_cast<std::int32_t>(a[i]) - b[i];
+			result += diff * diff;
+		}
+
+		return result;
+	}
+}
+
+
+#endif  // QUANTISEDKERNELS_H_INCLUDED
@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    SimdKernels.h
+    Created: 19 Oct 2026 2:10:18pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef SIMDKERNELS_H_INCLUDED
+#define SIMDKERNELS_H_INCLUDED
+
+#include "SimdOps.h"
+
+/** Small linear algebra kernels written against SimdOps<T>. These work on raw pointers so
+ *  they can be used on the audio thread without going through armadillo temporaries.
+ */
+namespace SimdKernels
+{
+	/** @return the dot product of a and b over size elements. */
+	template<typename T>
+	inline T dotProduct(const T* a, const T* b, std::size_t size)
+	{
+		using Ops = SimdOps<T>;
+
+		//Two accumulators to hide the add latency.
+		auto acc0 = Ops::zero();
+		auto acc1 = Ops::zero();
+
+		std::size_t i = 0;
+
+		for (; i + (2 * Ops::width) <= size; i += 2 * Ops::width)
+		{
+			acc0 = Ops::mulAdd(Ops::load(a + i), Ops::load(b + i), acc0);
+			acc1 = Ops::mulAdd(Ops::load(a + i + Ops::width), Ops::load(b + i + Ops::width), acc1);
+		}
+
+		for (; i + Ops::width <= size; i += Ops::width)
+			acc0 = Ops::mulAdd(Ops::load(a + i), Ops::load(b + i), acc0);
+
+		auto result = Ops::sum(Ops::add(acc0, acc1));
+
+		for (; i < size; ++i)
+			result += a[i] * b[i];
+
+		return result;
+	}
+
+	/** @return the sum of weights[i] * x[i] * x[i] over size elements, e.g. a filter applied to the
+	 *  squared magnitude spectrum without first squaring it into a buffer.
+	 */
+	template<typename T>
+	inline T weightedSumOfSquares(const T* weights, const T* x, std::size_t size)
+	{
+		using Ops = SimdOps<T>;
+
+		auto acc0 = Ops::zero();
+		auto acc1 = Ops::zero();
+
+		std::size_t i = 0;
+
+		for (; i + (2 * Ops::width) <= size; i += 2 * Ops::width)
+		{
+			const auto x0 = Ops::load(x + i);
+			const auto x1 = Ops::load(x + i + Ops::width);
+
+			acc0 = Ops::mulAdd(Ops::load(weights + i), Ops::mul(x0, x0), acc0);
+			acc1 = Ops::mulAdd(Ops::load(weights + i + Ops::width), Ops::mul(x1, x1), acc1);
+		}
+
+		for (; i + Ops::width <= size; i += Ops::width)
+		{
+			const auto x0 = Ops::load(x + i);
+			acc0 = Ops::mulAdd(Ops::load(weights + i), Ops::mul(x0, x0), acc0);
+		}
+
+		auto result = Ops::sum(Ops::add(acc0, acc1));
+
+		for (; i < size; ++i)
+			result += weights[i] * (x[i] * x[i]);
+
+		return result;
+	}
+
+	/** @return the squared euclidean distance between a and b over size elements. */
+	template<typename T>
+	inline T squaredDistance(const T* a, const T* b, std::size_t size)
+	{
+		using Ops = SimdOps<T>;
+
+		auto acc0 = Ops::zero();
+		auto acc1 = Ops::zero();
+
+		std::size_t i = 0;
+
+		for (; i + (2 * Ops::width) <= size; i += 2 * Ops::width)
+		{
+			const auto diff0 = Ops::sub(Ops::load(a + i), Ops::load(b + i));
+			const auto diff1 = Ops::sub(Ops::load(a + i + Ops::width), Ops::load(b + i + Ops::width));
+
+			acc0 = Ops::mulAdd(diff0, diff0, acc0);
+			acc1 = Ops::mulAdd(diff1, diff1, acc1);
+		}
+
+		for (; i + Ops::width <= size; i += Ops::width)
+		{
+			const auto diff = Ops::sub(Ops::load(a + i), Ops::load(b + i));
+			acc0 = Ops::mulAdd(diff, diff, acc0);
+		}
+
+		auto result = Ops::sum(Ops::add(acc0, acc1));
+
+		for (; i < size; ++i)
+		{
+			const auto diff = a[i] - b[i];
+			result += diff * diff;
+		}
+
+		return result;
+	}
+
+	/** Squared euclidean distance which stops early once the partial sum exceeds bound.
+	 *  The partial sum is checked every 4 vectors, so the horizontal add is only paid once per block.
+	 * @return the exact squared distance if it is <= bound, otherwise some value > bound.
+	 */
+	template<typename T>
+	inline T squaredDistanceBounded(const T* a, const T* b, std::size_t size, T bound)
+	{
+		using Ops = SimdOps<T>;
+
+		const std::size_t blockSize = 4 * Ops::width;
+
+		auto result = static_cast<T>(0.0);
+		std::size_t i = 0;
+
+		for (; i + blockSize <= size; i += blockSize)
+		{
+			auto acc0 = Ops::zero();
+			auto acc1 = Ops::zero();
+
+			for (std::size_t j = 0; j < blockSize; j += 2 * Ops::width)
+			{
+				const auto diff0 = Ops::sub(Ops::load(a + i + j), Ops::load(b + i + j));
+				const auto diff1 = Ops::sub(Ops::load(a + i + j + Ops::width), Ops::load(b + i + j + Ops::width));
+
+				acc0 = Ops::mulAdd(diff0, diff0, acc0);
+				acc1 = Ops::mulAdd(diff1, diff1, acc1);
+			}
+
+			result += Ops::sum(Ops::add(acc0, acc1));
+
+			if (result > bound)
+				return result;
+		}
+
+		return result + squaredDistance(a + i, b + i, size - i);
+	}
+
+	/** Dense matrix vector product y = A x for a row major matrix.
+	 * @param matrix the first element of A.
+	 * @param rowStride the distance in elements between consecutive rows of A.
+	 * @param x input vector of numCols elements.
+	 * @param y output vector of numRows elements.
+	 */
+	template<typename T>
+	inline void gemv(const T* matrix, std::size_t rowStride, const T* x, T* y, std::size_t numRows, std::size_t numCols)
+	{
+		for (std::size_t row = 0; row < numRows; ++row)
+			y[row] = dotProduct(matrix + (row * rowStride), x, numCols);
+	}
+}
+
+
+#endif  // SIMDKERNELS_H_INCLUDED
@@ -0,0 +1,240 @@
+/*
+  ==============================================================================
+
+    SimdOps.h
+    Created: 19 Oct 2026 9:12:40am
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef SIMDOPS_H_INCLUDED
+#define SIMDOPS_H_INCLUDED
+
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__AVX__)
+ #include <immintrin.h>
+ #define AUDIOCLASSIFY_SIMD_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+ #include <emmintrin.h>
+ #define AUDIOCLASSIFY_SIMD_SSE2 1
+#endif
+
+/** A thin wrapper over the SSE2 / AVX intrinsics used by the AudioClassify kernels
+ *  (FFT butterflies, MFCC GEMV, distance and spectral statistics kernels).
+ *  Each kernel is written once against SimdOps<T> and processes SimdOps<T>::width values
+ *  per step followed by a scalar tail. When neither SSE2 nor AVX is available the
+ *  generic template falls back to plain scalar code with a width of 1.
+ *
+ *  All loads and stores are unaligned so the kernels can run directly on armadillo or
+ *  std::unique_ptr<T[]> memory.
+ */
+template<typename T>
+struct SimdOps
+{
+	using Vec = T;
+	enum : std::size_t { width = 1 };
+
+	static Vec zero() { return static_cast<T>(0.0); }
+	static Vec set1(T val) { return val; }
+	static Vec load(const T* ptr) { return *ptr; }
+	static void store(T* ptr, Vec v) { *ptr = v; }
+
+	static Vec add(Vec a, Vec b) { return a + b; }
+	static Vec sub(Vec a, Vec b) { return a - b; }
+	static Vec mul(Vec a, Vec b) { return a * b; }
+	static Vec mulAdd(Vec a, Vec b, Vec c) { return (a * b) + c; }
+	static Vec max(Vec a, Vec b) { return std::max(a, b); }
+	static Vec min(Vec a, Vec b) { return std::min(a, b); }
+	static Vec abs(Vec a) { return std::abs(a); }
+	static Vec sqrt(Vec a) { return std::sqrt(a); }
+
+	static T sum(Vec v) { return v; }
+	static T maxElement(Vec v) { return v; }
+	static T minElement(Vec v) { return v; }
+};
+
+//==============================================================================
+#if defined(AUDIOCLASSIFY_SIMD_AVX)
+
+template<>
+struct SimdOps<float>
+{
+	using Vec = __m256;
+	enum : std::size_t { width = 8 };
+
+	static Vec zero() { return _mm256_setzero_ps(); }
+	static Vec set1(float val) { return _mm256_set1_ps(val); }
+	static Vec load(const float* ptr) { return _mm256_loadu_ps(ptr); }
+	static void store(float* ptr, Vec v) { _mm256_storeu_ps(ptr, v); }
+
+	static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+	static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+	static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+#if defined(__FMA__)
+	static Vec mulAdd(Vec a, Vec b, Vec c) { return _mm256_fmadd_ps(a, b, c); }
+#else
+	static Vec mulAdd(Vec a, Vec b, Vec c) { return _mm256_add_ps(_mm256_mul_ps(a, b), c); }
+#endif
+	static Vec max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+	static Vec abs(Vec a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+	static Vec sqrt(Vec a) { return _mm256_sqrt_ps(a); }
+
+	static float sum(Vec v)
+	{
+		__m128 lo = _mm256_castps256_ps128(v);
+		__m128 hi = _mm256_extractf128_ps(v, 1);
+		lo = _mm_add_ps(lo, hi);
+		lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+		lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 0x55));
+		return _mm_cvtss_f32(lo);
+	}
+
+	static float maxElement(Vec v)
+	{
+		__m128 m = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+		m = _mm_max_ps(m, _mm_movehl_ps(m, m));
+		m = _mm_max_ss(m, _mm_shuffle_ps(m, m, 0x55));
+		return _mm_cvtss_f32(m);
+	}
+
+	static float minElement(Vec v)
+	{
+		__m128 m = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+		m = _mm_min_ps(m, _mm_movehl_ps(m, m));
+		m = _mm_min_ss(m, _mm_shuffle_ps(m, m, 0x55));
+		return _mm_cvtss_f32(m);
+	}
+};
+
+template<>
+struct SimdOps<double>
+{
+	using Vec = __m256d;
+	enum : std::size_t { width = 4 };
+
+	static Vec zero() { return _mm256_setzero_pd(); }
+	static Vec set1(double val) { return _mm256_set1_pd(val); }
+	static Vec load(const double* ptr) { return _mm256_loadu_pd(ptr); }
+	static void store(double* ptr, Vec v) { _mm256_storeu_pd(ptr, v); }
+
+	static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+	static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+	static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+#if defined(__FMA__)
+	static Vec mulAdd(Vec a, Vec b, Vec c) { return _mm256_fmadd_pd(a, b, c); }
+#else
+	static Vec mulAdd(Vec a, Vec b, Vec c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+#endif
+	static Vec max(Vec a, Vec b) { return _mm256_max_pd(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm256_min_pd(a, b); }
+	static Vec abs(Vec a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+	static Vec sqrt(Vec a) { return _mm256_sqrt_pd(a); }
+
+	static double sum(Vec v)
+	{
+		__m128d lo = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+		return _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+	}
+
+	static double maxElement(Vec v)
+	{
+		__m128d m = _mm_max_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+		return _mm_cvtsd_f64(_mm_max_sd(m, _mm_unpackhi_pd(m, m)));
+	}
+
+	static double minElement(Vec v)
+	{
+		__m128d m = _mm_min_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+		return _mm_cvtsd_f64(_mm_min_sd(m, _mm_unpackhi_pd(m, m)));
+	}
+};
+
+//==============================================================================
+#elif defined(AUDIOCLASSIFY_SIMD_SSE2)
+
+template<>
+struct SimdOps<float>
+{
+	using Vec = __m128;
+	enum : std::size_t { width = 4 };
+
+	static Vec zero() { return _mm_setzero_ps(); }
+	static Vec set1(float val) { return _mm_set1_ps(val); }
+	static Vec load(const float* ptr) { return _mm_loadu_ps(ptr); }
+	static void store(float* ptr, Vec v) { _mm_storeu_ps(ptr, v); }
+
+	static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+	static Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+	static Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+	static Vec mulAdd(Vec a, Vec b, Vec c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+	static Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+	static Vec abs(Vec a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+	static Vec sqrt(Vec a) { return _mm_sqrt_ps(a); }
+
+	static float sum(Vec v)
+	{
+		v = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		v = _mm_add_ss(v, _mm_shuffle_ps(v, v, 0x55));
+		return _mm_cvtss_f32(v);
+	}
+
+	static float maxElement(Vec v)
+	{
+		v = _mm_max_ps(v, _mm_movehl_ps(v, v));
+		v = _mm_max_ss(v, _mm_shuffle_ps(v, v, 0x55));
+		return _mm_cvtss_f32(v);
+	}
+
+	static float minElement(Vec v)
+	{
+		v = _mm_min_ps(v, _mm_movehl_ps(v, v));
+		v = _mm_min_ss(v, _mm_shuffle_ps(v, v, 0x55));
+		return _mm_cvtss_f32(v);
+	}
+};
+
+template<>
+struct SimdOps<double>
+{
+	using Vec = __m128d;
+	enum : std::size_t { width = 2 };
+
+	static Vec zero() { return _mm_setzero_pd(); }
+	static Vec set1(double val) { return _mm_set1_pd(val); }
+	static Vec load(const double* ptr) { return _mm_loadu_pd(ptr); }
+	static void store(double* ptr, Vec v) { _mm_storeu_pd(ptr, v); }
+
+	static Vec add(Vec a, Vec b) { return _mm_add_pd(a, b); }
+	static Vec sub(Vec a, Vec b) { return _mm_sub_pd(a, b); }
+	static Vec mul(Vec a, Vec b) { return _mm_mul_pd(a, b); }
+	static Vec mulAdd(Vec a, Vec b, Vec c) { return _mm_add_pd(_mm_mul_pd(a, b), c); }
+	static Vec max(Vec a, Vec b) { return _mm_max_pd(a, b); }
+	static Vec min(Vec a, Vec b) { return _mm_min_pd(a, b); }
+	static Vec abs(Vec a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a); }
+	static Vec sqrt(Vec a) { return _mm_sqrt_pd(a); }
+
+	static double sum(Vec v)
+	{
+		return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+	}
+
+	static double maxElement(Vec v)
+	{
+		return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v)));
+	}
+
+	static double minElement(Vec v)
+	{
+		return _mm_cvtsd_f64(_mm_min_sd(v, _mm_unpackhi_pd(v, v)));
+	}
+};
+
+#endif
+
+#endif  // SIMDOPS_H_INCLUDED
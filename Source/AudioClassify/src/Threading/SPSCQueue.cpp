@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    SPSCQueue.cpp
+    Created: 19 Oct 2026 9:48:51pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "SPSCQueue.h"
+
+#include <algorithm>
+#include <cassert>
+
+//==============================================================================
+template<typename T>
+SPSCQueue<T>::SPSCQueue(std::size_t initNumSlots, std::size_t initSlotSize)
+	: storage(initNumSlots * initSlotSize),
+	  numSlots(initNumSlots),
+	  slotSize(initSlotSize),
+	  writeCount(0),
+	  readCount(0)
+{
+	assert(numSlots > 0);
+}
+
+//==============================================================================
+template<typename T>
+SPSCQueue<T>::~SPSCQueue()
+{
+}
+
+//==============================================================================
+template<typename T>
+bool SPSCQueue<T>::push(const T* values)
+{
+	const auto written = writeCount.load(std::memory_order_relaxed);
+
+	if (written - readCount.load(std::memory_order_acquire) >= numSlots)
+		return false;
+
+	std::copy(values, values + slotSize, storage.data() + ((written % numSlots) * slotSize));
+
+	//Publish the record to the consumer.
+	writeCount.store(written + 1, std::memory_order_release);
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+bool SPSCQueue<T>::pop(T* values)
+{
+	const auto read = readCount.load(std::memory_order_relaxed);
+
+	if (read == writeCount.load(std::memory_order_acquire))
+		return false;
+
+	const auto* slot = storage.data() + ((read % numSlots) * slotSize);
+	std::copy(slot, slot + slotSize, values);
+
+	//Hand the slot back to the producer.
+	readCount.store(read + 1, std::memory_order_release);
+
+	return true;
+}
+
+//==============================================================================
+template<typename T>
+std::size_t SPSCQueue<T>::getNumReady() const
+{
+	return writeCount.load(std::memory_order_acquire) - readCount.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+template<typename T>
+std::size_t SPSCQueue<T>::getNumSlots() const
+{
+	return numSlots;
+}
+
+//==============================================================================
+template<typename T>
+std::size_t SPSCQueue<T>::getSlotSize() const
+{
+	return slotSize;
+}
+
+//==============================================================================
+template class SPSCQueue<float>;
+template class SPSCQueue<double>;
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    SPSCQueue.h
+    Created: 19 Oct 2026 9:48:51pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef SPSCQUEUE_H_INCLUDED
+#define SPSCQUEUE_H_INCLUDED
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+/** Lock free single producer, single consumer queue of fixed size records.
+ *
+ *  The storage is numSlots records of slotSize values, allocated by the constructor. push()
+ *  and pop() copy whole records and never block or allocate, so the audio thread can be the
+ *  producer with a background thread as the consumer (or the other way round).
+ */
+template<typename T>
+class SPSCQueue
+{
+public:
+	SPSCQueue(std::size_t numSlots, std::size_t slotSize);
+	~SPSCQueue();
+
+	/** Copies slotSize values into the queue. Producer thread only.
+	 * @return false if the queue is full and the record was not added.
+	 */
+	bool push(const T* values);
+
+	/** Copies the oldest record into values (slotSize values). Consumer thread only.
+	 * @return false if the queue is empty.
+	 */
+	bool pop(T* values);
+
+	/** @return the number of records waiting. Exact only on the consumer thread. */
+	std::size_t getNumReady() const;
+
+	std::size_t getNumSlots() const;
+	std::size_t getSlotSize() const;
+
+private:
+	std::vector<T> storage;
+	const std::size_t numSlots;
+	const std::size_t slotSize;
+
+	//Total records written and read. Kept on separate cache lines so the two threads do not share one.
+	std::atomic<std::size_t> writeCount;
+	char writePadding[64];
+	std::atomic<std::size_t> readCount;
+	char readPadding[64];
+
+	SPSCQueue(const SPSCQueue&) = delete;
+	SPSCQueue& operator=(const SPSCQueue&) = delete;
+};
+
+
+#endif  // SPSCQUEUE_H_INCLUDED
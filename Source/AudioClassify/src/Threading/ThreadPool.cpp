@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+    ThreadPool.cpp
+    Created: 19 Oct 2026 3:26:44pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+//==============================================================================
+ThreadPool::ThreadPool(unsigned int numThreads)
+{
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	workers.reserve(numThreads);
+
+	for (auto i = 0u; i < numThreads; ++i)
+		workers.emplace_back([this]() { workerLoop(); });
+}
+
+//==============================================================================
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		shouldExit = true;
+	}
+
+	queueCondition.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+}
+
+//==============================================================================
+unsigned int ThreadPool::getNumThreads() const
+{
+	return static_cast<unsigned int>(workers.size());
+}
+
+//==============================================================================
+void ThreadPool::parallelFor(std::size_t numItems, const std::function<void(std::size_t, std::size_t)>& task, std::size_t minItemsPerTask)
+{
+	if (numItems == 0)
+		return;
+
+	//A few ranges per thread so uneven ranges still balance.
+	const auto maxTasks = static_cast<std::size_t>(getNumThreads() + 1) * 4;
+	const auto itemsPerTask = std::max(std::max<std::size_t>(minItemsPerTask, 1), (numItems + maxTasks - 1) / maxTasks);
+	const auto numTasks = (numItems + itemsPerTask - 1) / itemsPerTask;
+
+	if (numTasks == 1)
+	{
+		task(0, numItems);
+		return;
+	}
+
+	//Guarded by doneLock. Workers decrement and notify while holding it, so the caller cannot
+	//see zero and let these locals go out of scope while a worker is still using them.
+	std::size_t numRemaining = numTasks;
+	std::mutex doneLock;
+	std::condition_variable doneCondition;
+
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+
+		for (std::size_t t = 0; t < numTasks; ++t)
+		{
+			const auto begin = t * itemsPerTask;
+			const auto end = std::min(numItems, begin + itemsPerTask);
+
+			queue.emplace_back([&, begin, end]()
+			{
+				task(begin, end);
+
+				std::lock_guard<std::mutex> doneGuard(doneLock);
+
+				if (--numRemaining == 0)
+					doneCondition.notify_all();
+			});
+		}
+	}
+
+	queueCondition.notify_all();
+
+	//Help out rather than block, this also keeps nested parallelFor calls from deadlocking.
+	while (runNextTask())
+	{
+	}
+
+	std::unique_lock<std::mutex> lock(doneLock);
+	doneCondition.wait(lock, [&numRemaining]() { return numRemaining == 0; });
+}
+
+//==============================================================================
+ThreadPool& ThreadPool::getShared()
+{
+	static ThreadPool sharedPool;
+	return sharedPool;
+}
+
+//==============================================================================
+void ThreadPool::workerLoop()
+{
+	for (;;)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(queueLock);
+			queueCondition.wait(lock, [this]() { return shouldExit || !queue.empty(); });
+
+			if (shouldExit && queue.empty())
+				return;
+
+			job = std::move(queue.front());
+			queue.pop_front();
+		}
+
+		job();
+	}
+}
+
+//==============================================================================
+bool ThreadPool::runNextTask()
+{
+	std::function<void()> job;
+
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+
+		if (queue.empty())
+			return false;
+
+		job = std::move(queue.front());
+		queue.pop_front();
+	}
+
+	job();
+	return true;
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    ThreadPool.h
+    Created: 19 Oct 2026 3:26:44pm
+    Author:  Joshua Marler
+
+  ==============================================================================
+*/
+
+#ifndef THREADPOOL_H_INCLUDED
+#define THREADPOOL_H_INCLUDED
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <deque>
+
+/** Fixed size worker pool used by the offline (non audio thread) batch operations such as
+ *  batch feature extraction, batch classification and cross validation.
+ *
+ *  Note: The audio thread must never wait on a ThreadPool.
+ */
+class ThreadPool
+{
+public:
+	/** @param numThreads the number of worker threads. 0 uses std::thread::hardware_concurrency(). */
+	explicit ThreadPool(unsigned int numThreads = 0);
+	~ThreadPool();
+
+	unsigned int getNumThreads() const;
+
+	/** Splits [0, numItems) into contiguous ranges and calls task(rangeBegin, rangeEnd) for each
+	 *  on the pool's threads, blocking until all ranges are complete. The calling thread also runs
+	 *  ranges whilst it waits so parallelFor() may be nested inside a task.
+	 * @param minItemsPerTask lower bound on range size so small batches are not over split.
+	 */
+	void parallelFor(std::size_t numItems, const std::function<void(std::size_t, std::size_t)>& task, std::size_t minItemsPerTask = 1);
+
+	/** @return a process wide pool using all hardware threads, created on first use. */
+	static ThreadPool& getShared();
+
+private:
+	std::vector<std::thread> workers;
+
+	std::mutex queueLock;
+	std::condition_variable queueCondition;
+	std::deque<std::function<void()>> queue;
+	bool shouldExit = false;
+
+	void workerLoop();
+	bool runNextTask();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+};
+
+
+#endif  // THREADPOOL_H_INCLUDED